@@ -0,0 +1,89 @@
+/**
+ * Core - Multi-Rail Context
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef CORE_MULTIRAILCONTEXT_H_
+#define CORE_MULTIRAILCONTEXT_H_
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include <infinity/core/Configuration.h>
+#include <infinity/core/Context.h>
+
+namespace infinity {
+namespace core {
+
+/**
+ * A device and port, one rail of a multi-rail context
+ */
+typedef struct {
+  uint16_t device;
+  uint16_t devicePort;
+} rail_t;
+
+/**
+ * Opens one context per rail, so that dual-port and dual-NIC hosts can use
+ * all of their links. Each rail keeps its own protection domain, completion
+ * queues and NUMA information.
+ */
+class MultiRailContext {
+
+public:
+  static const uint32_t MAX_RAILS = 8;
+
+public:
+  MultiRailContext(
+      const std::vector<rail_t> &rails,
+      const Configuration &configuration = Configuration::fromEnvironment());
+
+  MultiRailContext(const MultiRailContext &) = delete;
+  MultiRailContext(const MultiRailContext &&) = delete;
+  MultiRailContext &operator=(const MultiRailContext &) = delete;
+  MultiRailContext &operator=(MultiRailContext &&) = delete;
+
+public:
+  /**
+   * All active ports of all installed devices
+   */
+  static std::vector<rail_t> findActiveRails();
+
+public:
+  uint32_t getNumberOfRails();
+  const rail_t &getRail(uint32_t rail);
+  std::shared_ptr<Context> getContext(uint32_t rail);
+  int32_t getNumaNode(uint32_t rail);
+
+  /**
+   * Rails attached to numaNode first, then all others. -1 uses the node
+   * the calling thread runs on.
+   */
+  std::vector<uint32_t> getRailsByLocality(int32_t numaNode = -1);
+
+  /**
+   * Restrict the calling thread to the CPUs local to the rail
+   */
+  bool bindCurrentThreadToRail(uint32_t rail);
+
+public:
+  /**
+   * Check if a receive operation completed on any rail. Rails are polled
+   * round robin, rail is set to the one the message arrived on.
+   */
+  bool receive(receive_element_t &receiveElement, uint32_t &rail);
+
+protected:
+  std::vector<rail_t> rails;
+  std::vector<std::shared_ptr<Context> > contexts;
+  uint32_t nextReceiveRail = 0;
+};
+
+} /* namespace core */
+} /* namespace infinity */
+
+#endif /* CORE_MULTIRAILCONTEXT_H_ */
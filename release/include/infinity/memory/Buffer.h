@@ -0,0 +1,120 @@
+/*
+ * Memory - Buffer
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef MEMORY_BUFFER_H_
+#define MEMORY_BUFFER_H_
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Region.h>
+#include <infinity/memory/RegisteredMemory.h>
+#include <memory>
+
+namespace infinity {
+namespace memory {
+
+/**
+
+ */
+class Buffer : public Region,
+               public std::enable_shared_from_this<infinity::memory::Buffer> {
+
+private:
+  // The Token class is used to make the Buffer constructors
+  // unreachable from outside the Buffer class, but still let
+  // Buffer create std::shared_ptrs.
+  class Token {};
+  // Selects the growable constructor, whose arguments match the chunked one
+  class GrowableToken {};
+
+public:
+  static std::shared_ptr<Buffer>
+  createBuffer(std::shared_ptr<infinity::core::Context> context,
+               uint64_t sizeInBytes, bool zero_memory = true);
+  static std::shared_ptr<Buffer>
+  createBuffer(std::shared_ptr<infinity::core::Context> context,
+               infinity::memory::RegisteredMemory *memory, uint64_t offset,
+               uint64_t sizeInBytes);
+  static std::shared_ptr<Buffer>
+  createBuffer(std::shared_ptr<infinity::core::Context> context, void *memory,
+               uint64_t sizeInBytes);
+
+  /**
+   * Allocates a large buffer and registers it as one memory region per
+   * chunk. Chunks are prefaulted and registered in parallel on the device's
+   * NUMA node. If numberOfThreads is 0, one thread per device-local CPU is
+   * used.
+   */
+  static std::shared_ptr<Buffer>
+  createChunkedBuffer(std::shared_ptr<infinity::core::Context> context,
+                      uint64_t sizeInBytes, uint64_t chunkSizeInBytes,
+                      uint32_t numberOfThreads = 0);
+
+  /**
+   * Reserves maximumSizeInBytes of address space and registers it one extent
+   * at a time as the buffer grows. resize() never moves or copies the data,
+   * so region tokens for existing extents stay valid.
+   */
+  static std::shared_ptr<Buffer>
+  createGrowableBuffer(std::shared_ptr<infinity::core::Context> context,
+                       uint64_t sizeInBytes, uint64_t maximumSizeInBytes,
+                       uint64_t extentSizeInBytes);
+
+  /**
+   * Maps a file and registers the mapping, so peers can read the file
+   * directly from the page cache. Read-only buffers only allow remote reads.
+   * populate maps with MAP_POPULATE, prefault touches every page up front.
+   */
+  static std::shared_ptr<Buffer>
+  createBufferFromFile(std::shared_ptr<infinity::core::Context> context,
+                       const char *path, bool writable = false,
+                       bool populate = false, bool prefault = false);
+
+  Buffer(std::shared_ptr<infinity::core::Context> context, uint64_t sizeInBytes,
+         bool zero_memory, Token);
+  Buffer(std::shared_ptr<infinity::core::Context> context,
+         infinity::memory::RegisteredMemory *memory, uint64_t offset,
+         uint64_t sizeInBytes, Token);
+  Buffer(std::shared_ptr<infinity::core::Context> context, void *memory,
+         uint64_t sizeInBytes, Token);
+  Buffer(std::shared_ptr<infinity::core::Context> context, uint64_t sizeInBytes,
+         uint64_t chunkSizeInBytes, uint32_t numberOfThreads, Token);
+  Buffer(std::shared_ptr<infinity::core::Context> context, uint64_t sizeInBytes,
+         uint64_t maximumSizeInBytes, uint64_t extentSizeInBytes,
+         GrowableToken);
+  Buffer(std::shared_ptr<infinity::core::Context> context, const char *path,
+         bool writable, bool populate, bool prefault, Token);
+  ~Buffer();
+  Buffer(const Buffer &) = delete;
+  Buffer(const Buffer &&) = delete;
+  Buffer &operator=(const Buffer &) = delete;
+  Buffer &operator=(Buffer &&other) = delete;
+
+public:
+  void *getData();
+  void resize(uint64_t newSize);
+  bool isGrowable();
+
+public:
+  std::shared_ptr<Buffer> getptr() { return shared_from_this(); }
+
+protected:
+  bool memoryRegistered = false;
+  bool memoryAllocated = false;
+
+protected:
+  bool memoryMapped = false;
+  uint64_t mappedSizeInBytes = 0;
+  bool growable = false;
+
+  void resizeInPlace(uint64_t newSize);
+};
+
+} /* namespace memory */
+} /* namespace infinity */
+
+#endif /* MEMORY_BUFFER_H_ */
@@ -0,0 +1,36 @@
+/*
+ * Memory - File Mapping
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef MEMORY_FILEMAPPING_H_
+#define MEMORY_FILEMAPPING_H_
+
+#include <stdint.h>
+
+namespace infinity {
+namespace memory {
+
+/**
+ * Maps a whole file into memory so it can be registered and served from the
+ * page cache without a staging copy. Read-only mappings are registered for
+ * remote reads only, writable mappings are shared with the file.
+ */
+class FileMapping {
+
+public:
+  static void *map(const char *path, bool writable, bool populate,
+                   bool prefault, uint64_t &sizeInBytes);
+
+  static void unmap(void *data, uint64_t sizeInBytes);
+
+  static int getAccessFlags(bool writable);
+};
+
+} /* namespace memory */
+} /* namespace infinity */
+
+#endif /* MEMORY_FILEMAPPING_H_ */
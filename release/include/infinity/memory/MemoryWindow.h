@@ -0,0 +1,86 @@
+/*
+ * Memory - Memory Window
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef MEMORY_MEMORYWINDOW_H_
+#define MEMORY_MEMORYWINDOW_H_
+
+#include <memory>
+#include <stdint.h>
+#include <infiniband/verbs.h>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/memory/RegionToken.h>
+
+namespace infinity {
+namespace queues {
+class QueuePair;
+}
+}
+
+namespace infinity {
+namespace memory {
+
+/**
+ * Type 2 memory window. A window exposes a sub-range of a registered buffer
+ * under its own remote key. It is bound and invalidated through a queue
+ * pair, which is much cheaper than registering or deregistering memory.
+ * Once bound, the window can only be accessed through that queue pair.
+ */
+class MemoryWindow {
+
+  friend class infinity::queues::QueuePair;
+
+public:
+  MemoryWindow(std::shared_ptr<infinity::core::Context> context);
+  ~MemoryWindow();
+
+  MemoryWindow(const MemoryWindow &) = delete;
+  MemoryWindow(const MemoryWindow &&) = delete;
+  MemoryWindow &operator=(const MemoryWindow &) = delete;
+  MemoryWindow &operator=(MemoryWindow &&) = delete;
+
+public:
+  /**
+   * Token for the bound range, the window needs to be bound first
+   */
+  RegionToken createRegionToken();
+
+public:
+  bool isBound();
+  std::shared_ptr<Buffer> getBuffer();
+  uint64_t getAddress();
+  uint64_t getSizeInBytes();
+  uint32_t getRemoteKey();
+
+protected:
+  /**
+   * Returns the key for the next binding, every binding changes the tag so
+   * remote nodes holding an old token are rejected
+   */
+  uint32_t nextRemoteKey();
+
+  void setBound(std::shared_ptr<Buffer> buffer, uint64_t address,
+                uint64_t sizeInBytes, uint32_t remoteKey);
+  void setUnbound();
+
+protected:
+  std::shared_ptr<infinity::core::Context> context;
+  ibv_mw *ibvMemoryWindow = nullptr;
+
+  std::shared_ptr<Buffer> buffer;
+  uint64_t address = 0;
+  uint64_t sizeInBytes = 0;
+  uint32_t remoteKey = 0;
+  bool bound = false;
+};
+
+} /* namespace memory */
+} /* namespace infinity */
+
+#endif /* MEMORY_MEMORYWINDOW_H_ */
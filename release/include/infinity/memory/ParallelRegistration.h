@@ -0,0 +1,45 @@
+/*
+ * Memory - Parallel Registration
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef MEMORY_PARALLELREGISTRATION_H_
+#define MEMORY_PARALLELREGISTRATION_H_
+
+#include <stdint.h>
+#include <vector>
+#include <infiniband/verbs.h>
+
+#include <infinity/core/Context.h>
+
+namespace infinity {
+namespace memory {
+
+/**
+ * Registers a large memory area as a sequence of equally sized chunks (the
+ * last one may be shorter), one memory region per chunk. Chunks are
+ * prefaulted and registered concurrently by threads which are pinned to the
+ * CPUs local to the device, so first-touch places the pages on the device's
+ * NUMA node.
+ */
+class ParallelRegistration {
+
+public:
+  static std::vector<ibv_mr *>
+  registerChunks(infinity::core::Context *context, void *data,
+                 uint64_t sizeInBytes, uint64_t chunkSizeInBytes,
+                 uint32_t numberOfThreads, bool prefault, int accessFlags);
+
+  static void deregisterChunks(std::vector<ibv_mr *> &chunks);
+
+  static uint32_t getNumberOfChunks(uint64_t sizeInBytes,
+                                    uint64_t chunkSizeInBytes);
+};
+
+} /* namespace memory */
+} /* namespace infinity */
+
+#endif /* MEMORY_PARALLELREGISTRATION_H_ */
@@ -0,0 +1,155 @@
+/*
+ * Memory - Region Directory
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef MEMORY_REGIONDIRECTORY_H_
+#define MEMORY_REGIONDIRECTORY_H_
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/memory/RegionToken.h>
+
+namespace infinity {
+namespace queues {
+class QueuePair;
+}
+namespace requests {
+class RequestToken;
+}
+}
+
+namespace infinity {
+namespace memory {
+
+/**
+ * Registered, versioned table of named region tokens on the serving side.
+ * The version is odd while the table is being changed, readers retry until
+ * they see the same even version before and after reading the entries.
+ *
+ * Layout: version (8 bytes), number of entries (4 bytes), entry size
+ * (4 bytes), followed by entries of a zero padded name and a serialized
+ * token.
+ */
+class RegionDirectory {
+
+public:
+  static const uint32_t NAME_SIZE_IN_BYTES = 32;
+  static const uint32_t HEADER_SIZE_IN_BYTES = 16;
+  static const uint32_t ENTRY_SIZE_IN_BYTES =
+      NAME_SIZE_IN_BYTES + RegionToken::SERIALIZED_SIZE_IN_BYTES;
+
+public:
+  RegionDirectory(std::shared_ptr<infinity::core::Context> context,
+                  uint32_t maxNumberOfEntries);
+
+  RegionDirectory(const RegionDirectory &) = delete;
+  RegionDirectory(const RegionDirectory &&) = delete;
+  RegionDirectory &operator=(const RegionDirectory &) = delete;
+  RegionDirectory &operator=(RegionDirectory &&) = delete;
+
+public:
+  /**
+   * Add a region or replace the token of an existing one, e.g. after the
+   * buffer was resized
+   */
+  void publish(const std::string &name, const RegionToken &token);
+
+  /**
+   * Returns false if there is no region with that name
+   */
+  bool remove(const std::string &name);
+
+public:
+  /**
+   * Token for the directory itself, handed to clients once
+   */
+  RegionToken createRegionToken();
+
+  uint64_t getVersion();
+  uint32_t getNumberOfEntries();
+  uint32_t getMaxNumberOfEntries();
+
+  static uint64_t getSizeInBytes(uint32_t maxNumberOfEntries);
+
+protected:
+  void beginUpdate();
+  void endUpdate();
+  char *getEntry(uint32_t index);
+
+protected:
+  std::shared_ptr<Buffer> buffer;
+  uint32_t maxNumberOfEntries = 0;
+  std::unordered_map<std::string, uint32_t> entryIndex;
+};
+
+/**
+ * Client side cache of a remote region directory. Lookups are served
+ * locally, revalidate() reads only the remote version word and fetches the
+ * entries again if it changed.
+ */
+class RemoteRegionDirectory {
+
+public:
+  static const uint32_t REFRESH_TIMEOUT_IN_MILLISECONDS = 1000;
+
+public:
+  RemoteRegionDirectory(
+      std::shared_ptr<infinity::core::Context> context,
+      std::shared_ptr<infinity::queues::QueuePair> queuePair,
+      const RegionToken &directoryToken);
+
+  RemoteRegionDirectory(const RemoteRegionDirectory &) = delete;
+  RemoteRegionDirectory(const RemoteRegionDirectory &&) = delete;
+  RemoteRegionDirectory &operator=(const RemoteRegionDirectory &) = delete;
+  RemoteRegionDirectory &operator=(RemoteRegionDirectory &&) = delete;
+
+public:
+  /**
+   * Returns false if the cached directory has no region with that name
+   */
+  bool lookup(const std::string &name, RegionToken &token);
+
+  /**
+   * Fetch the remote entries, retries with a growing backoff until a
+   * consistent version was read or the refresh timeout expired
+   */
+  void refresh();
+
+  /**
+   * Check the remote version, returns true if the cache was refreshed
+   */
+  bool revalidate();
+
+public:
+  uint64_t getVersion();
+  uint32_t getNumberOfEntries();
+
+protected:
+  uint64_t readRemoteVersion();
+  void waitForRead(infinity::requests::RequestToken &requestToken);
+
+protected:
+  std::shared_ptr<infinity::core::Context> context;
+  std::shared_ptr<infinity::queues::QueuePair> queuePair;
+  RegionToken directoryToken;
+
+  std::shared_ptr<Buffer> buffer;
+  std::shared_ptr<Buffer> versionBuffer;
+
+  uint64_t version = 0;
+  std::unordered_map<std::string, RegionToken> entries;
+};
+
+} /* namespace memory */
+} /* namespace infinity */
+
+#endif /* MEMORY_REGIONDIRECTORY_H_ */
@@ -0,0 +1,81 @@
+/*
+ * Memory - Region Token
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef MEMORY_REGIONTOKEN_H_
+#define MEMORY_REGIONTOKEN_H_
+
+#include <iostream>
+#include <stdint.h>
+#include <infinity/memory/RegionType.h>
+#include <infinity/memory/Region.h>
+
+namespace infinity {
+namespace memory {
+
+/**
+ * Wire encoding of a region token. Only what a peer can use is encoded,
+ * the local region pointer and local key are left out.
+ */
+typedef struct __attribute__((packed)) {
+
+  uint64_t address;
+  uint64_t sizeInBytes;
+  uint32_t remoteKey;
+  uint32_t memoryRegionType;
+
+} serializedRegionToken;
+
+class RegionToken {
+
+public:
+  static const uint32_t SERIALIZED_SIZE_IN_BYTES =
+      sizeof(serializedRegionToken);
+
+public:
+  RegionToken();
+  RegionToken(Region *memoryRegion, RegionType memoryRegionType,
+              uint64_t sizeInBytes, uint64_t address, uint32_t localKey,
+              uint32_t remoteKey);
+
+public:
+  Region *getMemoryRegion() const;
+  RegionType getMemoryRegionType() const;
+  uint64_t getSizeInBytes() const;
+  uint64_t getRemainingSizeInBytes(uint64_t offset) const;
+  uint64_t getAddress() const;
+  uint64_t getAddressWithOffset(uint64_t offset) const;
+  uint32_t getLocalKey() const;
+  uint32_t getRemoteKey() const;
+
+public:
+  /**
+   * Write the wire encoding to destination, which needs to hold
+   * SERIALIZED_SIZE_IN_BYTES bytes. No alignment is required.
+   */
+  void serialize(void *destination) const;
+
+  /**
+   * Decode a token from its wire encoding. The result has no local region
+   * and can only be used as a remote destination or source.
+   */
+  static RegionToken deserialize(const void *source);
+
+private:
+  Region *memoryRegion = nullptr;
+  RegionType memoryRegionType = UNKNOWN;
+  uint64_t sizeInBytes = 0;
+  uint64_t address = 0;
+  uint32_t localKey = 0;
+  uint32_t remoteKey = 0;
+};
+
+std::ostream &operator<<(std::ostream &os, const RegionToken &regionToken);
+} /* namespace memory */
+} /* namespace infinity */
+
+#endif /* MEMORY_REGIONTOKEN_H_ */
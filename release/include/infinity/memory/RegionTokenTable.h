@@ -0,0 +1,91 @@
+/*
+ * Memory - Region Token Table
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef MEMORY_REGIONTOKENTABLE_H_
+#define MEMORY_REGIONTOKENTABLE_H_
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/memory/RegionToken.h>
+
+namespace infinity {
+namespace queues {
+class QueuePair;
+}
+}
+
+namespace infinity {
+namespace memory {
+
+/**
+ * A registered table of serialized region tokens. The publishing side
+ * hands out a single token for the table itself, the peer pulls the whole
+ * table with RDMA reads. The number of tokens is only limited by memory.
+ * Tokens are decoded on access, nothing is allocated per token.
+ */
+class RegionTokenTable {
+
+public:
+  static const uint32_t HEADER_SIZE_IN_BYTES = 2 * sizeof(uint32_t);
+  static const uint32_t READ_CHUNK_SIZE_IN_BYTES = 1024 * 1024;
+
+public:
+  /**
+   * Empty table with room for numberOfTokens tokens
+   */
+  RegionTokenTable(std::shared_ptr<infinity::core::Context> context,
+                   uint32_t numberOfTokens);
+
+  RegionTokenTable(std::shared_ptr<infinity::core::Context> context,
+                   const std::vector<RegionToken> &tokens);
+
+  /**
+   * Read a remote table, tableToken is the token of the remote table
+   */
+  static std::unique_ptr<RegionTokenTable>
+  fetch(std::shared_ptr<infinity::core::Context> context,
+        const std::shared_ptr<infinity::queues::QueuePair> &queuePair,
+        const RegionToken &tableToken);
+
+  RegionTokenTable(const RegionTokenTable &) = delete;
+  RegionTokenTable(const RegionTokenTable &&) = delete;
+  RegionTokenTable &operator=(const RegionTokenTable &) = delete;
+  RegionTokenTable &operator=(RegionTokenTable &&) = delete;
+
+public:
+  void setToken(uint32_t index, const RegionToken &token);
+  RegionToken getToken(uint32_t index);
+  uint32_t getNumberOfTokens();
+
+public:
+  /**
+   * Token for the table itself, small enough for the connection user data
+   */
+  RegionToken createRegionToken();
+  std::shared_ptr<Buffer> getBuffer();
+
+  static uint64_t getSizeInBytes(uint32_t numberOfTokens);
+
+protected:
+  explicit RegionTokenTable(std::shared_ptr<Buffer> buffer);
+
+  char *getEntry(uint32_t index);
+
+protected:
+  std::shared_ptr<Buffer> buffer;
+  uint32_t numberOfTokens = 0;
+};
+
+} /* namespace memory */
+} /* namespace infinity */
+
+#endif /* MEMORY_REGIONTOKENTABLE_H_ */
@@ -0,0 +1,140 @@
+/**
+ * Queues - Aggregating Sender
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef QUEUES_AGGREGATINGSENDER_H_
+#define QUEUES_AGGREGATINGSENDER_H_
+
+#include <chrono>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/requests/RequestToken.h>
+
+namespace infinity {
+namespace queues {
+
+/**
+ * Packs small messages into registered staging buffers and sends each
+ * buffer as one batch, when it is full or when the deadline after its
+ * first message expired. The deadline is checked by send() and poll(),
+ * an idle producer has to call poll() or flush(). A deadline of 0 sends
+ * every message on its own.
+ *
+ * A batch starts with the number of messages, every message with its size
+ * and is padded to 4 bytes. Receive buffers need to hold a whole batch,
+ * BatchIterator unpacks them.
+ */
+class AggregatingSender {
+
+public:
+  static const uint32_t DEFAULT_BATCH_SIZE_IN_BYTES = 4096;
+  static const uint32_t DEFAULT_DEADLINE_IN_MICROSECONDS = 10;
+  static const uint32_t DEFAULT_NUMBER_OF_STAGING_BUFFERS = 4;
+
+public:
+  AggregatingSender(
+      std::shared_ptr<infinity::core::Context> context,
+      std::shared_ptr<QueuePair> queuePair,
+      uint32_t batchSizeInBytes = DEFAULT_BATCH_SIZE_IN_BYTES,
+      uint32_t deadlineInMicroseconds = DEFAULT_DEADLINE_IN_MICROSECONDS,
+      uint32_t numberOfStagingBuffers = DEFAULT_NUMBER_OF_STAGING_BUFFERS);
+  ~AggregatingSender();
+
+  AggregatingSender(const AggregatingSender &) = delete;
+  AggregatingSender(const AggregatingSender &&) = delete;
+  AggregatingSender &operator=(const AggregatingSender &) = delete;
+  AggregatingSender &operator=(AggregatingSender &&) = delete;
+
+public:
+  /**
+   * Copies the message into the current batch
+   */
+  void send(const void *data, uint32_t sizeInBytes);
+
+  /**
+   * Sends the current batch if its deadline expired. Returns true if a
+   * batch was sent.
+   */
+  bool poll();
+
+  /**
+   * Sends the current batch right away
+   */
+  void flush();
+
+  /**
+   * Waits until all batches sent so far have completed
+   */
+  void waitUntilCompleted();
+
+public:
+  void setDeadline(uint32_t deadlineInMicroseconds);
+  uint32_t getDeadline();
+
+  /**
+   * Largest message which fits into a batch
+   */
+  uint32_t getMaxMessageSize();
+
+  uint64_t getNumberOfMessages();
+  uint64_t getNumberOfBatches();
+
+protected:
+  void startBatch();
+
+protected:
+  std::shared_ptr<infinity::core::Context> context;
+  std::shared_ptr<QueuePair> queuePair;
+  uint32_t batchSizeInBytes = 0;
+  std::chrono::microseconds deadline;
+
+  std::vector<std::shared_ptr<infinity::memory::Buffer> > stagingBuffers;
+  std::vector<std::unique_ptr<infinity::requests::RequestToken> > tokens;
+  std::vector<bool> inFlight;
+
+  uint32_t currentBuffer = 0;
+  uint32_t currentOffset = 0;
+  uint32_t currentNumberOfMessages = 0;
+  std::chrono::steady_clock::time_point batchStart;
+
+  uint64_t numberOfMessages = 0;
+  uint64_t numberOfBatches = 0;
+};
+
+/**
+ * Unpacks a batch of an AggregatingSender
+ */
+class BatchIterator {
+
+public:
+  BatchIterator(const void *data, uint32_t bytesWritten);
+
+public:
+  /**
+   * Next message of the batch, false at the end
+   */
+  bool next(const void *&message, uint32_t &sizeInBytes);
+
+  uint32_t getNumberOfMessages();
+
+protected:
+  const char *data = nullptr;
+  uint32_t bytesWritten = 0;
+  uint32_t offset = 0;
+  uint32_t numberOfMessages = 0;
+  uint32_t message = 0;
+};
+
+} /* namespace queues */
+} /* namespace infinity */
+
+#endif /* QUEUES_AGGREGATINGSENDER_H_ */
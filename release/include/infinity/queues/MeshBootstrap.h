@@ -0,0 +1,87 @@
+/**
+ * Queues - Mesh Bootstrap
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef QUEUES_MESHBOOTSTRAP_H_
+#define QUEUES_MESHBOOTSTRAP_H_
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/utils/RendezvousStore.h>
+
+namespace infinity {
+namespace queues {
+
+/**
+ * Connects every rank of a job to every other rank with one queue pair per
+ * pair of ranks. Instead of one TCP handshake per queue pair, each rank
+ * publishes a single record with all its queue pairs in a rendezvous store
+ * and reads one record per peer.
+ *
+ * In lazy mode a pair is only connected when getQueuePair() is called for
+ * it. Both ranks of the pair need to ask for it, the call blocks until the
+ * peer did.
+ */
+class MeshBootstrap {
+
+public:
+  MeshBootstrap(std::shared_ptr<infinity::core::Context> context,
+                std::shared_ptr<infinity::utils::RendezvousStore> store,
+                uint32_t rank, uint32_t numberOfRanks, bool lazy = false,
+                uint32_t timeoutInMilliseconds = 60000,
+                const QueuePairOptions &options = QueuePairOptions());
+
+  MeshBootstrap(const MeshBootstrap &) = delete;
+  MeshBootstrap(const MeshBootstrap &&) = delete;
+  MeshBootstrap &operator=(const MeshBootstrap &) = delete;
+  MeshBootstrap &operator=(MeshBootstrap &&) = delete;
+
+public:
+  /**
+   * Creates, exchanges and connects the queue pairs to all other ranks and
+   * waits until all ranks are connected. Does nothing in lazy mode.
+   */
+  void connect();
+
+  /**
+   * Queue pair to rank, connects it first in lazy mode
+   */
+  std::shared_ptr<QueuePair> getQueuePair(uint32_t rank);
+
+  bool isConnected(uint32_t rank);
+
+public:
+  uint32_t getRank();
+  uint32_t getNumberOfRanks();
+
+protected:
+  void publish(const std::string &key, uint32_t firstPeer,
+               uint32_t numberOfPeers);
+  void pair(const std::string &key, uint32_t peer, uint32_t entryIndex);
+
+protected:
+  std::shared_ptr<infinity::core::Context> context;
+  std::shared_ptr<infinity::utils::RendezvousStore> store;
+  uint32_t rank = 0;
+  uint32_t numberOfRanks = 0;
+  bool lazy = false;
+  uint32_t timeoutInMilliseconds = 0;
+  QueuePairOptions options;
+
+  std::vector<std::shared_ptr<QueuePair> > queuePairs;
+  std::vector<bool> connected;
+};
+
+} /* namespace queues */
+} /* namespace infinity */
+
+#endif /* QUEUES_MESHBOOTSTRAP_H_ */
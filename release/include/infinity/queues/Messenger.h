@@ -0,0 +1,147 @@
+/**
+ * Queues - Messenger
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef QUEUES_MESSENGER_H_
+#define QUEUES_MESSENGER_H_
+
+#include <deque>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/memory/RegionToken.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/requests/RequestToken.h>
+
+namespace infinity {
+namespace queues {
+
+/**
+ * Announces a message which the receiver reads from the sender's buffer
+ */
+typedef struct __attribute__((packed)) {
+  infinity::memory::serializedRegionToken source;
+  uint32_t sizeInBytes;
+  uint32_t slot;
+} rendezvous_header_t;
+
+typedef struct {
+  std::shared_ptr<QueuePair> queuePair;
+  // Receive buffer holding an eager message, null for rendezvous messages
+  std::shared_ptr<infinity::memory::Buffer> buffer;
+  uint32_t sizeInBytes = 0;
+  rendezvous_header_t header;
+} message_t;
+
+/**
+ * Messaging on top of the queue pairs of a context. Messages up to the
+ * eager threshold are sent directly and land in a posted receive buffer.
+ * Larger messages send a header with a token for the source buffer, the
+ * receiver reads the payload straight into its destination buffer and
+ * acknowledges, which completes the request token of the sender. Receive
+ * buffers only need to hold the eager threshold.
+ *
+ * The messenger owns all receives of the context and marks its messages
+ * with immediate values. Acknowledgements arrive as receives, so senders
+ * have to call receive() or waitUntilCompleted() to make progress.
+ */
+class Messenger {
+
+public:
+  static const uint32_t DEFAULT_EAGER_THRESHOLD_IN_BYTES = 4096;
+  static const uint32_t DEFAULT_MAX_OUTSTANDING_RENDEZVOUS = 64;
+
+public:
+  Messenger(
+      std::shared_ptr<infinity::core::Context> context,
+      uint32_t eagerThresholdInBytes = DEFAULT_EAGER_THRESHOLD_IN_BYTES,
+      uint32_t maxOutstandingRendezvous = DEFAULT_MAX_OUTSTANDING_RENDEZVOUS);
+  ~Messenger();
+
+  Messenger(const Messenger &) = delete;
+  Messenger(const Messenger &&) = delete;
+  Messenger &operator=(const Messenger &) = delete;
+  Messenger &operator=(Messenger &&) = delete;
+
+public:
+  /**
+   * Sends sizeInBytes bytes of the buffer. The buffer must not be changed
+   * until the request token completed. Returns false if the message needs
+   * a rendezvous and maxOutstandingRendezvous are already outstanding.
+   */
+  bool send(std::shared_ptr<QueuePair> queuePair,
+            const std::shared_ptr<infinity::memory::Buffer> &buffer,
+            uint64_t localOffset, uint32_t sizeInBytes,
+            infinity::requests::RequestToken *requestToken);
+
+  /**
+   * Returns the next message. Every message has to be released or
+   * fetched.
+   */
+  bool receive(message_t &message);
+
+  /**
+   * Copies or reads the message into the destination buffer, acknowledges
+   * it and releases it
+   */
+  void fetch(message_t &message,
+             const std::shared_ptr<infinity::memory::Buffer> &buffer,
+             uint64_t localOffset = 0);
+
+  /**
+   * Posts the receive buffer of an eager message again. A rendezvous
+   * message is acknowledged without reading it.
+   */
+  void release(message_t &message);
+
+  /**
+   * Waits for a request token of send(), processing acknowledgements.
+   * Messages arriving in the meantime are returned by receive() later.
+   */
+  void waitUntilCompleted(infinity::requests::RequestToken *requestToken);
+
+public:
+  uint32_t getEagerThreshold();
+  uint32_t getNumberOfOutstandingRendezvous();
+
+protected:
+  typedef struct {
+    bool inUse;
+    bool headerInFlight;
+    std::shared_ptr<infinity::memory::Buffer> buffer;
+    infinity::requests::RequestToken *requestToken;
+  } outstanding_rendezvous_t;
+
+protected:
+  bool poll(message_t &message);
+  void acknowledge(message_t &message);
+  int32_t findFreeSlot();
+
+protected:
+  std::shared_ptr<infinity::core::Context> context;
+  uint32_t eagerThresholdInBytes = 0;
+
+  std::shared_ptr<infinity::memory::Buffer> headerBuffer;
+  std::vector<std::unique_ptr<infinity::requests::RequestToken> > headerTokens;
+  std::vector<outstanding_rendezvous_t> outstanding;
+  uint32_t numberOfOutstanding = 0;
+  uint32_t nextSlot = 0;
+
+  std::shared_ptr<infinity::memory::Buffer> acknowledgementBuffer;
+  infinity::requests::RequestToken acknowledgementToken;
+  bool acknowledgementInFlight = false;
+
+  std::deque<message_t> deferredMessages;
+};
+
+} /* namespace queues */
+} /* namespace infinity */
+
+#endif /* QUEUES_MESSENGER_H_ */
@@ -0,0 +1,75 @@
+/**
+ * Requests - Multi-Rail Request Token
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef REQUESTS_MULTIRAILREQUESTTOKEN_H_
+#define REQUESTS_MULTIRAILREQUESTTOKEN_H_
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include <infinity/core/MultiRailContext.h>
+#include <infinity/requests/RequestToken.h>
+
+namespace infinity {
+namespace queues {
+class MultiRailQueuePair;
+} /* namespace queues */
+} /* namespace infinity */
+
+namespace infinity {
+namespace requests {
+
+/**
+ * Completion of an operation of a multi-rail queue pair, which may have
+ * been striped over several rails. Holds one request token per rail and
+ * completes when all parts have completed. Completing the token releases
+ * its bytes from the rail accounting of the queue pair, so it has to be
+ * waited on or checked before the queue pair is destroyed.
+ */
+class MultiRailRequestToken {
+
+  friend class infinity::queues::MultiRailQueuePair;
+
+public:
+  MultiRailRequestToken(
+      std::shared_ptr<infinity::core::MultiRailContext> context);
+
+  MultiRailRequestToken(const MultiRailRequestToken &) = delete;
+  MultiRailRequestToken(const MultiRailRequestToken &&) = delete;
+  MultiRailRequestToken &operator=(const MultiRailRequestToken &) = delete;
+  MultiRailRequestToken &operator=(MultiRailRequestToken &&) = delete;
+
+public:
+  bool checkIfCompleted();
+  void waitUntilCompleted();
+  bool wasSuccessful();
+
+  /**
+   * Number of rails the last operation used
+   */
+  uint32_t getNumberOfRailsUsed();
+
+protected:
+  void reset(infinity::queues::MultiRailQueuePair *queuePair);
+  RequestToken *useRail(uint32_t rail, uint64_t sizeInBytes);
+
+protected:
+  std::vector<std::unique_ptr<RequestToken> > tokens;
+  std::vector<uint64_t> pendingBytes;
+  std::vector<bool> pending;
+  infinity::queues::MultiRailQueuePair *queuePair = nullptr;
+  uint32_t numberOfRailsUsed = 0;
+  uint32_t numberOfRailsPending = 0;
+  bool successful = true;
+};
+
+} /* namespace requests */
+} /* namespace infinity */
+
+#endif /* REQUESTS_MULTIRAILREQUESTTOKEN_H_ */
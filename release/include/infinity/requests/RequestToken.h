@@ -0,0 +1,88 @@
+/**
+ * Requests - Request Token
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef REQUESTS_REQUESTTOKEN_H_
+#define REQUESTS_REQUESTTOKEN_H_
+
+#include <atomic>
+#include <stdint.h>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/AtomicArray.h>
+#include <infinity/memory/Region.h>
+
+namespace infinity {
+namespace requests {
+
+class RequestToken {
+
+public:
+  RequestToken(std::shared_ptr<infinity::core::Context> context);
+
+  void reset();
+
+  void setRegion(std::shared_ptr<infinity::memory::Region> region);
+  std::shared_ptr<infinity::memory::Region> getRegion();
+
+  void setStatus(ibv_wc_status);
+  const char *getStatusString() const;
+  ibv_wc_status getStatus() const;
+  bool wasSuccessful();
+
+  bool checkIfCompleted();
+  void waitUntilCompleted();
+
+  void setImmediateValue(uint32_t immediateValue);
+  bool hasImmediateValue();
+  uint32_t getImmediateValue();
+
+  /**
+   * Result of an atomic operation which used a slot of an atomic array. The
+   * value is copied and the slot released when the operation completes, or
+   * when the token is reset before that.
+   */
+  void setAtomicSlot(infinity::memory::AtomicArray *atomicArray, uint32_t slot);
+  bool hasAtomicValue();
+  uint64_t getAtomicValue();
+
+  void setUserData(void *userData, uint32_t userDataSize);
+  bool hasUserData();
+  void *getUserData();
+  uint32_t getUserDataSize();
+
+  RequestToken(const RequestToken &) = delete;
+  RequestToken(const RequestToken &&) = delete;
+  RequestToken &operator=(const RequestToken &) = delete;
+  RequestToken &operator=(RequestToken &&) = delete;
+
+protected:
+  std::shared_ptr<infinity::core::Context> const context;
+  std::shared_ptr<infinity::memory::Region> region;
+
+  std::atomic<bool> completed;
+  // The int is really a ibv_wc_status, but we need ibv_wc_status +
+  // uninitialized.
+  std::atomic<int> status;
+
+  void *userData = nullptr;
+  uint32_t userDataSize = 0;
+  bool userDataValid = false;
+
+  uint32_t immediateValue = 0;
+  bool immediateValueValid = false;
+
+  infinity::memory::AtomicArray *atomicArray = nullptr;
+  uint32_t atomicSlot = 0;
+  uint64_t atomicValue = 0;
+  bool atomicValueValid = false;
+};
+
+} /* namespace requests */
+} /* namespace infinity */
+
+#endif /* REQUESTS_REQUESTTOKEN_H_ */
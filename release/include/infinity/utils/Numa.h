@@ -0,0 +1,46 @@
+/**
+ * Utils - NUMA
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef UTILS_NUMA_H_
+#define UTILS_NUMA_H_
+
+#include <stdint.h>
+#include <vector>
+#include <infiniband/verbs.h>
+
+namespace infinity {
+namespace utils {
+
+class Numa {
+
+public:
+  /**
+   * NUMA node the device is attached to, -1 if unknown
+   */
+  static int32_t getNumaNodeOfDevice(ibv_device *device);
+
+  /**
+   * CPUs which are local to the device, empty if unknown
+   */
+  static std::vector<uint32_t> getLocalCpusOfDevice(ibv_device *device);
+
+  /**
+   * NUMA node the calling thread currently runs on, -1 if unknown
+   */
+  static int32_t getNumaNodeOfCurrentThread();
+
+  /**
+   * Restrict the calling thread to the given CPUs
+   */
+  static bool bindCurrentThreadToCpus(const std::vector<uint32_t> &cpus);
+};
+
+} /* namespace utils */
+} /* namespace infinity */
+
+#endif /* UTILS_NUMA_H_ */
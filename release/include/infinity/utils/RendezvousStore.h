@@ -0,0 +1,63 @@
+/**
+ * Utils - Rendezvous Store
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef UTILS_RENDEZVOUSSTORE_H_
+#define UTILS_RENDEZVOUSSTORE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace infinity {
+namespace utils {
+
+/**
+ * Out-of-band key value store used to exchange connection information
+ * between processes. Values are written once and never change.
+ */
+class RendezvousStore {
+
+public:
+  virtual ~RendezvousStore() {}
+
+  virtual void put(const std::string &key, const std::vector<char> &value) = 0;
+
+  /**
+   * Returns false if the key has not been written yet
+   */
+  virtual bool get(const std::string &key, std::vector<char> &value) = 0;
+
+  /**
+   * Polls until the key was written, fails after timeoutInMilliseconds
+   */
+  void waitFor(const std::string &key, std::vector<char> &value,
+               uint32_t timeoutInMilliseconds);
+};
+
+/**
+ * Store backed by a directory which all processes can access, e.g. on a
+ * shared file system or in /tmp for processes on a single machine. Values
+ * are written to a temporary file and renamed, readers never see partial
+ * values.
+ */
+class FileRendezvousStore : public RendezvousStore {
+
+public:
+  FileRendezvousStore(const std::string &directory);
+
+  void put(const std::string &key, const std::vector<char> &value) override;
+  bool get(const std::string &key, std::vector<char> &value) override;
+
+protected:
+  std::string directory;
+};
+
+} /* namespace utils */
+} /* namespace infinity */
+
+#endif /* UTILS_RENDEZVOUSSTORE_H_ */
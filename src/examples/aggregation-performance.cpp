@@ -0,0 +1,221 @@
+/**
+ * Examples - Aggregation Performance
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <algorithm>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/queues/AggregatingSender.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/queues/QueuePairFactory.h>
+#include <infinity/requests/RequestToken.h>
+
+#define MESSAGE_COUNT 1000000
+#define LATENCY_MESSAGE_COUNT 20000
+#define MESSAGE_SIZE 64
+#define BATCH_SIZE 4096
+#define PACE 2
+#define RECEIVE_BUFFER_COUNT 256
+
+uint64_t timeDiff(struct timeval stop, struct timeval start);
+
+void printLatency(const char *name, std::vector<uint64_t> &latencies) {
+  std::sort(latencies.begin(), latencies.end());
+  uint64_t sum = 0;
+  for (uint64_t latency : latencies) {
+    sum += latency;
+  }
+  std::cout << name << ":\t" << std::setprecision(1) << std::fixed
+            << (double)sum / latencies.size() << " usec average, "
+            << latencies[latencies.size() / 2] << " usec median, "
+            << latencies[latencies.size() * 99 / 100] << " usec 99th"
+            << std::endl;
+}
+
+// Server side of a phase. Acknowledges every batch with the number of
+// messages it held if acknowledgeBatches is set, otherwise only the last.
+void receiveMessages(std::shared_ptr<infinity::core::Context> context,
+                     std::shared_ptr<infinity::queues::QueuePair> qp,
+                     std::shared_ptr<infinity::memory::Buffer> ackBuffer,
+                     uint32_t messageCount, bool acknowledgeBatches) {
+
+  infinity::requests::RequestToken requestToken(context);
+  infinity::core::receive_element_t receiveElement;
+  uint32_t received = 0;
+  while (received < messageCount) {
+    while (!context->receive(receiveElement)) {
+    }
+    infinity::queues::BatchIterator batch(receiveElement.buffer->getData(),
+                                          receiveElement.bytesWritten);
+    const void *message = nullptr;
+    uint32_t sizeInBytes = 0;
+    uint32_t count = 0;
+    while (batch.next(message, sizeInBytes)) {
+      ++count;
+    }
+    received += count;
+    context->postReceiveBuffer(receiveElement.buffer);
+
+    if (acknowledgeBatches || received == messageCount) {
+      memcpy(ackBuffer->getData(), &count, sizeof(count));
+      qp->send(ackBuffer, sizeof(count), &requestToken);
+      requestToken.waitUntilCompleted();
+    }
+  }
+}
+
+// Returns the number of messages acknowledged, 0 if none arrived
+uint32_t
+receiveAcknowledgement(std::shared_ptr<infinity::core::Context> context) {
+
+  infinity::core::receive_element_t receiveElement;
+  if (!context->receive(receiveElement)) {
+    return 0;
+  }
+  uint32_t count = 0;
+  memcpy(&count, receiveElement.buffer->getData(), sizeof(count));
+  context->postReceiveBuffer(receiveElement.buffer);
+  return count;
+}
+
+// Usage: ./progam -s for server and ./program for client component
+// For every deadline, the client first sends MESSAGE_COUNT messages of
+// MESSAGE_SIZE bytes as fast as it can through an aggregating sender and
+// reports the message rate. It then sends LATENCY_MESSAGE_COUNT messages,
+// one every PACE usec, and the server acknowledges every batch. The
+// latency is the time from handing a message to the sender until the
+// acknowledgement of its batch arrived. A deadline of 0 sends every
+// message on its own.
+int main(int argc, char **argv) {
+
+  bool isServer = false;
+  int port_number = 8011;
+  const char *server_ip = "192.0.0.1";
+
+  while (argc > 1) {
+    if (argv[1][0] == '-') {
+      switch (argv[1][1]) {
+
+      case 's': {
+        isServer = true;
+        break;
+      }
+      case 'h': {
+        server_ip = argv[2];
+        ++argv;
+        --argc;
+        break;
+      }
+      case 'p': {
+        port_number = atoi(argv[2]);
+        ++argv;
+        --argc;
+      }
+      }
+    }
+    ++argv;
+    --argc;
+  }
+
+  auto context = std::make_shared<infinity::core::Context>();
+  infinity::queues::QueuePairFactory qpFactory(context);
+  auto ackBuffer = infinity::memory::Buffer::createBuffer(context, 64);
+  const uint32_t deadlines[] = {0, 1, 10, 100};
+
+  if (isServer) {
+
+    for (uint32_t i = 0; i < RECEIVE_BUFFER_COUNT; ++i) {
+      context->postReceiveBuffer(
+          infinity::memory::Buffer::createBuffer(context, BATCH_SIZE));
+    }
+    qpFactory.bindToPort(port_number);
+    auto qp = qpFactory.acceptIncomingConnection();
+
+    for (uint32_t deadline : deadlines) {
+      receiveMessages(context, qp, ackBuffer, MESSAGE_COUNT, false);
+      receiveMessages(context, qp, ackBuffer, LATENCY_MESSAGE_COUNT, true);
+      std::cout << "Finished deadline of " << deadline << " usec"
+                << std::endl;
+    }
+
+  } else {
+
+    for (uint32_t i = 0; i < RECEIVE_BUFFER_COUNT; ++i) {
+      context->postReceiveBuffer(
+          infinity::memory::Buffer::createBuffer(context, 64));
+    }
+    auto qp = qpFactory.connectToRemoteHost(server_ip, port_number);
+    char message[MESSAGE_SIZE];
+    memset(message, 0, sizeof(message));
+
+    for (uint32_t deadline : deadlines) {
+      infinity::queues::AggregatingSender sender(context, qp, BATCH_SIZE,
+                                                 deadline);
+
+      struct timeval start;
+      struct timeval stop;
+      gettimeofday(&start, nullptr);
+      for (uint32_t i = 0; i < MESSAGE_COUNT; ++i) {
+        sender.send(message, MESSAGE_SIZE);
+      }
+      sender.flush();
+      while (receiveAcknowledgement(context) == 0) {
+      }
+      gettimeofday(&stop, nullptr);
+      uint64_t batches = sender.getNumberOfBatches();
+
+      std::deque<struct timeval> pending;
+      std::vector<uint64_t> latencies;
+      latencies.reserve(LATENCY_MESSAGE_COUNT);
+      struct timeval now;
+      uint32_t sent = 0;
+      while (latencies.size() < LATENCY_MESSAGE_COUNT) {
+        gettimeofday(&now, nullptr);
+        if (sent < LATENCY_MESSAGE_COUNT &&
+            timeDiff(now, stop) >= (uint64_t)sent * PACE) {
+          pending.push_back(now);
+          sender.send(message, MESSAGE_SIZE);
+          ++sent;
+        } else {
+          sender.poll();
+        }
+        uint32_t acknowledged = receiveAcknowledgement(context);
+        if (acknowledged > 0) {
+          gettimeofday(&now, nullptr);
+          for (uint32_t i = 0; i < acknowledged; ++i) {
+            latencies.push_back(timeDiff(now, pending.front()));
+            pending.pop_front();
+          }
+        }
+      }
+
+      std::cout << "Deadline " << deadline << " usec:\t"
+                << std::setprecision(2) << std::fixed
+                << (double)MESSAGE_COUNT / timeDiff(stop, start)
+                << " million messages/sec, " << std::setprecision(1)
+                << (double)MESSAGE_COUNT / batches << " messages per batch"
+                << std::endl;
+      printLatency("  paced", latencies);
+    }
+  }
+
+  return 0;
+}
+
+uint64_t timeDiff(struct timeval stop, struct timeval start) {
+  return (stop.tv_sec * 1000000L + stop.tv_usec) -
+         (start.tv_sec * 1000000L + start.tv_usec);
+}
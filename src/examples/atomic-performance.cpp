@@ -0,0 +1,165 @@
+/**
+ * Examples - Atomic Performance
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Atomic.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/memory/RegionToken.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/queues/QueuePairFactory.h>
+#include <infinity/requests/RequestToken.h>
+
+#define OPERATIONS_COUNT 100000
+#define MAX_IN_FLIGHT 64
+#define LOOPBACK_COUNT 256
+
+uint64_t timeDiff(struct timeval stop, struct timeval start);
+
+// Usage: ./progam -s for server and ./program for client component
+int main(int argc, char **argv) {
+
+  bool isServer = false;
+  int port_number = 8011;
+  const char *server_ip = "192.0.0.1";
+
+  while (argc > 1) {
+    if (argv[1][0] == '-') {
+      switch (argv[1][1]) {
+
+      case 's': {
+        isServer = true;
+        break;
+      }
+      case 'h': {
+        server_ip = argv[2];
+        ++argv;
+        --argc;
+        break;
+      }
+      case 'p': {
+        port_number = atoi(argv[2]);
+        ++argv;
+        --argc;
+      }
+      }
+    }
+    ++argv;
+    --argc;
+  }
+
+  auto context = std::make_shared<infinity::core::Context>();
+  auto qpFactory =
+      std::make_shared<infinity::queues::QueuePairFactory>(context);
+  std::shared_ptr<infinity::queues::QueuePair> qp;
+
+  if (isServer) {
+
+    std::cout << "Creating atomic value\n";
+    auto atomic = std::make_shared<infinity::memory::Atomic>(context);
+    infinity::memory::RegionToken atomicToken = atomic->createRegionToken();
+
+    auto receiveBuffer = infinity::memory::Buffer::createBuffer(context, 1);
+    context->postReceiveBuffer(receiveBuffer);
+
+    std::cout << "Waiting for incoming connection on " << port_number << "\n";
+    qpFactory->bindToPort(port_number);
+    char serializedToken
+        [infinity::memory::RegionToken::SERIALIZED_SIZE_IN_BYTES];
+    atomicToken.serialize(serializedToken);
+    qp = qpFactory->acceptIncomingConnection(serializedToken,
+                                             sizeof(serializedToken));
+
+    std::cout << "Waiting for notification from client\n";
+    infinity::core::receive_element_t receiveElement;
+    while (!context->receive(receiveElement))
+      ;
+    std::cout << "Final value " << atomic->getValue() << "\n";
+
+  } else {
+
+    struct timeval start;
+    struct timeval stop;
+
+    std::cout << "Creating " << LOOPBACK_COUNT << " queue pairs\n";
+    std::vector<std::shared_ptr<infinity::queues::QueuePair> > loopbacks;
+    gettimeofday(&start, nullptr);
+    for (uint32_t i = 0; i < LOOPBACK_COUNT; ++i) {
+      loopbacks.emplace_back(qpFactory->createLoopback(std::vector<char>()));
+    }
+    gettimeofday(&stop, nullptr);
+    std::cout << std::setprecision(1) << std::fixed
+              << ((double)timeDiff(stop, start)) / LOOPBACK_COUNT
+              << " usec per queue pair\n";
+    loopbacks.clear();
+
+    std::cout << "Connecting to remote node " << server_ip << ":" << port_number
+              << "\n";
+    qp = qpFactory->connectToRemoteHost(server_ip, port_number);
+    infinity::memory::RegionToken atomicToken =
+        infinity::memory::RegionToken::deserialize(qp->getUserData());
+
+    std::vector<std::unique_ptr<infinity::requests::RequestToken> > tokens;
+    for (uint32_t i = 0; i < MAX_IN_FLIGHT; ++i) {
+      tokens.emplace_back(new infinity::requests::RequestToken(context));
+    }
+
+    for (uint32_t inFlight = 1; inFlight <= MAX_IN_FLIGHT; inFlight *= 2) {
+
+      for (uint32_t operation = 0; operation < 2; ++operation) {
+
+        gettimeofday(&start, nullptr);
+        for (uint32_t i = 0; i < OPERATIONS_COUNT; ++i) {
+          infinity::requests::RequestToken *token =
+              tokens[i % inFlight].get();
+          if (i >= inFlight) {
+            token->waitUntilCompleted();
+          }
+          if (operation == 0) {
+            qp->fetchAndAdd(atomicToken, 1, token);
+          } else {
+            qp->compareAndSwap(atomicToken, 0, 0, token);
+          }
+        }
+        for (uint32_t i = 0; i < inFlight; ++i) {
+          tokens[i]->waitUntilCompleted();
+        }
+        gettimeofday(&stop, nullptr);
+
+        uint64_t time = timeDiff(stop, start);
+        double opRate = ((double)(OPERATIONS_COUNT * 1000000L)) / time;
+        std::cout << (operation == 0 ? "FAA" : "CAS") << " with " << inFlight
+                  << " in flight\t" << std::setprecision(3) << std::fixed
+                  << opRate << " ops/sec" << std::endl;
+      }
+    }
+
+    infinity::requests::RequestToken requestToken(context);
+    qp->fetchAndAdd(atomicToken, 0, &requestToken);
+    requestToken.waitUntilCompleted();
+    std::cout << "Remote value " << requestToken.getAtomicValue() << "\n";
+
+    std::cout << "Sending notification to server\n";
+    auto sendBuffer = infinity::memory::Buffer::createBuffer(context, 1);
+    qp->send(sendBuffer, &requestToken);
+    requestToken.waitUntilCompleted();
+  }
+
+  return 0;
+}
+
+uint64_t timeDiff(struct timeval stop, struct timeval start) {
+  return (stop.tv_sec * 1000000L + stop.tv_usec) -
+         (start.tv_sec * 1000000L + start.tv_usec);
+}
@@ -0,0 +1,181 @@
+/**
+ * Examples - Connection Performance
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/queues/ConnectionEngine.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/queues/QueuePairFactory.h>
+#include <infinity/queues/RdmaCmQueuePairFactory.h>
+
+#define CONNECTION_COUNT 1000
+#define MAX_CONCURRENT_HANDSHAKES 128
+
+uint64_t timeDiff(struct timeval stop, struct timeval start);
+
+// Usage: ./progam -s for server and ./program for client component
+// The client connects CONNECTION_COUNT times one after another with the
+// blocking factory, then CONNECTION_COUNT times through the connection
+// engine with up to MAX_CONCURRENT_HANDSHAKES handshakes in flight. The
+// server accepts all of them with the engine. When built with RDMACM=1,
+// the client finally connects CONNECTION_COUNT times through the RDMA
+// connection manager on the next port.
+int main(int argc, char **argv) {
+
+  bool isServer = false;
+  int port_number = 8011;
+  const char *server_ip = "192.0.0.1";
+
+  while (argc > 1) {
+    if (argv[1][0] == '-') {
+      switch (argv[1][1]) {
+
+      case 's': {
+        isServer = true;
+        break;
+      }
+      case 'h': {
+        server_ip = argv[2];
+        ++argv;
+        --argc;
+        break;
+      }
+      case 'p': {
+        port_number = atoi(argv[2]);
+        ++argv;
+        --argc;
+      }
+      }
+    }
+    ++argv;
+    --argc;
+  }
+
+  auto context = std::make_shared<infinity::core::Context>();
+  auto qpFactory =
+      std::make_shared<infinity::queues::QueuePairFactory>(context);
+  infinity::queues::ConnectionEngine engine(qpFactory);
+  std::vector<std::shared_ptr<infinity::queues::QueuePair> > queuePairs;
+
+  struct timeval start;
+  struct timeval stop;
+
+  if (isServer) {
+
+    std::cout << "Accepting connections on " << port_number << "\n";
+    qpFactory->bindToPort(port_number);
+    engine.acceptConnections();
+#ifdef INFINITY_RDMACM_ON
+    infinity::queues::RdmaCmQueuePairFactory cmFactory(context);
+    cmFactory.bindToPort(port_number + 1);
+#endif
+
+    std::shared_ptr<infinity::queues::QueuePair> qp;
+    while (queuePairs.size() + engine.getNumberOfFailedHandshakes() <
+           2 * CONNECTION_COUNT) {
+      engine.poll(100);
+      while (engine.getReadyQueuePair(qp)) {
+        if (queuePairs.empty()) {
+          gettimeofday(&start, nullptr);
+        }
+        queuePairs.push_back(qp);
+      }
+    }
+    gettimeofday(&stop, nullptr);
+
+    std::cout << "Accepted " << queuePairs.size() << " connections, "
+              << engine.getNumberOfFailedHandshakes() << " failed, "
+              << std::setprecision(1) << std::fixed
+              << ((double)queuePairs.size() * 1000000L) /
+                     timeDiff(stop, start)
+              << " connections/sec" << std::endl;
+
+#ifdef INFINITY_RDMACM_ON
+    gettimeofday(&start, nullptr);
+    for (uint32_t i = 0; i < CONNECTION_COUNT; ++i) {
+      queuePairs.push_back(cmFactory.acceptIncomingConnection());
+    }
+    gettimeofday(&stop, nullptr);
+    std::cout << "Accepted " << CONNECTION_COUNT
+              << " connection manager connections, " << std::setprecision(1)
+              << std::fixed
+              << ((double)CONNECTION_COUNT * 1000000L) / timeDiff(stop, start)
+              << " connections/sec" << std::endl;
+#endif
+
+  } else {
+
+    std::cout << "Connecting " << CONNECTION_COUNT
+              << " times with the blocking factory\n";
+    gettimeofday(&start, nullptr);
+    for (uint32_t i = 0; i < CONNECTION_COUNT; ++i) {
+      queuePairs.push_back(
+          qpFactory->connectToRemoteHost(server_ip, port_number));
+    }
+    gettimeofday(&stop, nullptr);
+    std::cout << std::setprecision(1) << std::fixed
+              << ((double)CONNECTION_COUNT * 1000000L) / timeDiff(stop, start)
+              << " connections/sec" << std::endl;
+
+    std::cout << "Connecting " << CONNECTION_COUNT
+              << " times with the connection engine\n";
+    uint32_t started = 0;
+    uint32_t completed = 0;
+    gettimeofday(&start, nullptr);
+    while (completed + engine.getNumberOfFailedHandshakes() <
+           CONNECTION_COUNT) {
+      while (started < CONNECTION_COUNT &&
+             engine.getNumberOfPendingHandshakes() <
+                 MAX_CONCURRENT_HANDSHAKES) {
+        engine.connect(server_ip, port_number);
+        ++started;
+      }
+      engine.poll(1);
+      std::shared_ptr<infinity::queues::QueuePair> qp;
+      while (engine.getReadyQueuePair(qp)) {
+        queuePairs.push_back(qp);
+        ++completed;
+      }
+    }
+    gettimeofday(&stop, nullptr);
+    std::cout << std::setprecision(1) << std::fixed
+              << ((double)CONNECTION_COUNT * 1000000L) / timeDiff(stop, start)
+              << " connections/sec, " << engine.getNumberOfFailedHandshakes()
+              << " failed" << std::endl;
+
+#ifdef INFINITY_RDMACM_ON
+    std::cout << "Connecting " << CONNECTION_COUNT
+              << " times with the connection manager\n";
+    infinity::queues::RdmaCmQueuePairFactory cmFactory(context);
+    gettimeofday(&start, nullptr);
+    for (uint32_t i = 0; i < CONNECTION_COUNT; ++i) {
+      queuePairs.push_back(
+          cmFactory.connectToRemoteHost(server_ip, port_number + 1));
+    }
+    gettimeofday(&stop, nullptr);
+    std::cout << std::setprecision(1) << std::fixed
+              << ((double)CONNECTION_COUNT * 1000000L) / timeDiff(stop, start)
+              << " connections/sec, " << std::setprecision(2)
+              << (double)timeDiff(stop, start) / CONNECTION_COUNT
+              << " usec/connection" << std::endl;
+#endif
+  }
+
+  return 0;
+}
+
+uint64_t timeDiff(struct timeval stop, struct timeval start) {
+  return (stop.tv_sec * 1000000L + stop.tv_usec) -
+         (start.tv_sec * 1000000L + start.tv_usec);
+}
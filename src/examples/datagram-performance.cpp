@@ -0,0 +1,170 @@
+/**
+ * Examples - Datagram Performance
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/queues/DatagramQueuePair.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/queues/QueuePairFactory.h>
+#include <infinity/requests/RequestToken.h>
+
+#define BUFFER_COUNT 256
+#define PING_COUNT 10000
+#define SEGMENTED_MESSAGE_SIZE (256 * 1024)
+
+uint64_t timeDiff(struct timeval stop, struct timeval start);
+
+// Usage: ./progam -s for server and ./program for client component
+// The datagram addresses are exchanged while setting up a connected queue
+// pair. The client measures the round trip time of single datagrams, which
+// the server echoes to the source of the datagram, and then sends one
+// segmented message which the server reassembles. The message fits into
+// the posted receive buffers for any MTU of at least 1024 bytes.
+int main(int argc, char **argv) {
+  bool isServer = false;
+  int port_number = 8011;
+  const char *server_ip = "192.0.0.1";
+
+  while (argc > 1) {
+    if (argv[1][0] == '-') {
+      switch (argv[1][1]) {
+
+      case 's': {
+        isServer = true;
+        break;
+      }
+      case 'h': {
+        server_ip = argv[2];
+        ++argv;
+        --argc;
+        break;
+      }
+      case 'p': {
+        port_number = atoi(argv[2]);
+        ++argv;
+        --argc;
+      }
+      }
+    }
+    ++argv;
+    --argc;
+  }
+
+  auto context = std::make_shared<infinity::core::Context>();
+  auto qpFactory =
+      std::make_shared<infinity::queues::QueuePairFactory>(context);
+  infinity::queues::DatagramQueuePair datagramQueuePair(context);
+  infinity::queues::datagram_address_t localAddress =
+      datagramQueuePair.getAddress();
+  uint32_t messageSize = datagramQueuePair.getMaxMessageSize();
+  uint32_t receiveSize =
+      messageSize +
+      infinity::queues::DatagramQueuePair::ROUTING_HEADER_SIZE_IN_BYTES;
+
+  std::vector<std::shared_ptr<infinity::memory::Buffer> > receiveBuffers;
+  for (uint32_t i = 0; i < BUFFER_COUNT; ++i) {
+    receiveBuffers.push_back(
+        infinity::memory::Buffer::createBuffer(context, receiveSize));
+    datagramQueuePair.postReceiveBuffer(receiveBuffers.back());
+  }
+  std::cout << "Datagram queue pair " << localAddress.queuePairNumber
+            << ", messages of up to " << messageSize << " bytes\n";
+
+  infinity::queues::datagram_element_t element;
+  std::shared_ptr<infinity::queues::QueuePair> qp;
+
+  if (isServer) {
+
+    std::cout << "Waiting for incoming connection\n";
+    qpFactory->bindToPort(port_number);
+    qp = qpFactory->acceptIncomingConnection(&localAddress,
+                                             sizeof(localAddress));
+
+    auto replyBuffer = infinity::memory::Buffer::createBuffer(context, 64);
+    for (uint32_t i = 0; i < PING_COUNT; ++i) {
+      while (!datagramQueuePair.receive(element))
+        ;
+      datagramQueuePair.send(element.source, replyBuffer, 0, 64);
+      datagramQueuePair.postReceiveBuffer(element.buffer);
+    }
+
+    std::cout << "Reassembling segmented message\n";
+    auto message =
+        infinity::memory::Buffer::createBuffer(context, SEGMENTED_MESSAGE_SIZE);
+    uint32_t received = 0;
+    uint32_t numberOfSegments = 0;
+    do {
+      while (!datagramQueuePair.receive(element))
+        ;
+      uint32_t index = infinity::queues::DatagramQueuePair::getSegmentIndex(
+          element.immediateValue);
+      numberOfSegments =
+          infinity::queues::DatagramQueuePair::getNumberOfSegments(
+              element.immediateValue);
+      memcpy(reinterpret_cast<char *>(message->getData()) +
+                 index * messageSize,
+             element.data, element.bytesWritten);
+      datagramQueuePair.postReceiveBuffer(element.buffer);
+      ++received;
+    } while (received < numberOfSegments);
+    std::cout << "Received " << received << " segments\n";
+
+  } else {
+
+    std::cout << "Connecting to remote node\n";
+    qp = qpFactory->connectToRemoteHost(server_ip, port_number, &localAddress,
+                                        sizeof(localAddress));
+    infinity::queues::datagram_address_t serverAddress;
+    memcpy(&serverAddress, qp->getUserData(), sizeof(serverAddress));
+
+    auto sendBuffer = infinity::memory::Buffer::createBuffer(context, 64);
+    struct timeval start;
+    struct timeval stop;
+
+    gettimeofday(&start, nullptr);
+    for (uint32_t i = 0; i < PING_COUNT; ++i) {
+      datagramQueuePair.send(serverAddress, sendBuffer, 0, 64);
+      while (!datagramQueuePair.receive(element))
+        ;
+      datagramQueuePair.postReceiveBuffer(element.buffer);
+    }
+    gettimeofday(&stop, nullptr);
+    std::cout << "Round trip of 64 bytes: " << std::setprecision(2)
+              << std::fixed << (double)timeDiff(stop, start) / PING_COUNT
+              << " usec (" << datagramQueuePair.getNumberOfAddressHandles()
+              << " address handles)\n";
+
+    auto message =
+        infinity::memory::Buffer::createBuffer(context, SEGMENTED_MESSAGE_SIZE);
+    infinity::requests::RequestToken requestToken(context);
+    gettimeofday(&start, nullptr);
+    uint32_t numberOfSegments = datagramQueuePair.sendSegmented(
+        serverAddress, message, 0, SEGMENTED_MESSAGE_SIZE, &requestToken);
+    requestToken.waitUntilCompleted();
+    gettimeofday(&stop, nullptr);
+    std::cout << "Sent " << SEGMENTED_MESSAGE_SIZE << " bytes as "
+              << numberOfSegments << " segments: " << std::setprecision(2)
+              << std::fixed
+              << ((double)SEGMENTED_MESSAGE_SIZE) / timeDiff(stop, start)
+              << " MB/sec\n";
+  }
+
+  return 0;
+}
+
+uint64_t timeDiff(struct timeval stop, struct timeval start) {
+  return (stop.tv_sec * 1000000L + stop.tv_usec) -
+         (start.tv_sec * 1000000L + start.tv_usec);
+}
@@ -0,0 +1,212 @@
+/**
+ * Examples - Demultiplexing Performance
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unordered_map>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/queues/QueuePairFactory.h>
+#include <infinity/requests/RequestToken.h>
+
+#define QUEUE_PAIR_COUNT 10000
+#define GROUP_COUNT 10
+#define BATCH 256
+#define ROUNDS 200
+#define CHURN 1000
+#define CHURN_ROUNDS 10
+#define MESSAGE_SIZE 64
+#define LOOKUPS 10000000
+
+uint64_t timeDiff(struct timeval stop, struct timeval start);
+
+// Sends BATCH messages over random queue pairs and waits until they have
+// arrived, so that only the receive side is timed
+void sendBatch(
+    std::vector<std::shared_ptr<infinity::queues::QueuePair> > &queuePairs,
+    std::shared_ptr<infinity::memory::Buffer> buffer,
+    std::vector<std::unique_ptr<infinity::requests::RequestToken> > &tokens) {
+  for (uint32_t i = 0; i < BATCH; ++i) {
+    queuePairs[rand() % queuePairs.size()]->send(buffer, MESSAGE_SIZE,
+                                                 tokens[i].get());
+  }
+  for (uint32_t i = 0; i < BATCH; ++i) {
+    tokens[i]->waitUntilCompleted();
+  }
+}
+
+void printResult(const char *name, uint64_t time, uint64_t received) {
+  std::cout << name << ":\t" << std::setprecision(1) << std::fixed
+            << (double)time * 1000.0 / received << " nsec per receive"
+            << std::endl;
+}
+
+// Usage: ./program
+// Creates QUEUE_PAIR_COUNT loopback queue pairs on one context and sends
+// batches of messages over random queue pairs. The receives are taken
+// apart three times: returned by receive() and attributed by the
+// application with a map of its own, dispatched to a handler per queue
+// pair, and dispatched to one of GROUP_COUNT handlers shared by groups of
+// queue pairs. The cost of a registry lookup, which every receive pays to
+// attribute it, is measured on its own. Finally, CHURN queue pairs are
+// replaced repeatedly, the number of registered queue pairs stays
+// constant. The queue pairs use the small RPC profile, default sized ones
+// would need gigabytes.
+int main() {
+
+  auto context = std::make_shared<infinity::core::Context>();
+  infinity::queues::QueuePairFactory qpFactory(context);
+
+  for (uint32_t i = 0; i < BATCH; ++i) {
+    context->postReceiveBuffer(
+        infinity::memory::Buffer::createBuffer(context, MESSAGE_SIZE));
+  }
+  auto buffer = infinity::memory::Buffer::createBuffer(context, MESSAGE_SIZE);
+  std::vector<std::unique_ptr<infinity::requests::RequestToken> > tokens;
+  for (uint32_t i = 0; i < BATCH; ++i) {
+    tokens.emplace_back(new infinity::requests::RequestToken(context));
+  }
+
+  infinity::queues::QueuePairOptions options =
+      infinity::queues::QueuePairOptions::forProfile(
+          infinity::queues::RPC_SMALL);
+  std::vector<std::shared_ptr<infinity::queues::QueuePair> > queuePairs;
+  for (uint32_t i = 0; i < QUEUE_PAIR_COUNT; ++i) {
+    queuePairs.push_back(
+        qpFactory.createLoopback(std::vector<char>(), &options));
+  }
+  std::cout << context->getNumberOfRegisteredQueuePairs()
+            << " registered queue pairs" << std::endl;
+
+  struct timeval start;
+  struct timeval stop;
+  infinity::core::receive_element_t receiveElement;
+  // Handlers are owned by the context and must not keep it alive
+  infinity::core::Context *handlerContext = context.get();
+  uint64_t received = 0;
+
+  // Returned receives, attributed by the application
+  std::unordered_map<infinity::queues::QueuePair *, uint64_t> counters;
+  for (auto &queuePair : queuePairs) {
+    counters[queuePair.get()] = 0;
+  }
+  uint64_t time = 0;
+  for (uint32_t round = 0; round < ROUNDS; ++round) {
+    sendBatch(queuePairs, buffer, tokens);
+    gettimeofday(&start, nullptr);
+    for (uint32_t i = 0; i < BATCH; ++i) {
+      while (!context->receive(receiveElement)) {
+      }
+      ++counters[receiveElement.queuePair.get()];
+      context->postReceiveBuffer(receiveElement.buffer);
+    }
+    gettimeofday(&stop, nullptr);
+    time += timeDiff(stop, start);
+  }
+  printResult("Returned", time, (uint64_t)ROUNDS * BATCH);
+
+  // Registry lookups in a scattered order
+  std::vector<uint32_t> queuePairNumbers;
+  for (auto &queuePair : queuePairs) {
+    queuePairNumbers.push_back(queuePair->getQueuePairNumber());
+  }
+  uint64_t found = 0;
+  gettimeofday(&start, nullptr);
+  for (uint32_t i = 0; i < LOOKUPS; ++i) {
+    uint32_t index = (uint64_t)i * 7919 % QUEUE_PAIR_COUNT;
+    if (context->findQueuePair(queuePairNumbers[index]) != nullptr) {
+      ++found;
+    }
+  }
+  gettimeofday(&stop, nullptr);
+  std::cout << "Lookup:\t" << std::setprecision(1) << std::fixed
+            << (double)timeDiff(stop, start) * 1000.0 / LOOKUPS
+            << " nsec per lookup, " << found << " found" << std::endl;
+
+  // Handler per queue pair
+  std::vector<uint64_t> queuePairCounters(QUEUE_PAIR_COUNT, 0);
+  for (uint32_t i = 0; i < QUEUE_PAIR_COUNT; ++i) {
+    uint64_t *counter = &queuePairCounters[i];
+    context->setReceiveHandler(
+        queuePairs[i],
+        std::make_shared<infinity::core::Context::ReceiveHandler>(
+            [handlerContext, counter,
+             &received](infinity::core::receive_element_t &element) {
+              ++*counter;
+              ++received;
+              handlerContext->postReceiveBuffer(element.buffer);
+            }));
+  }
+  time = 0;
+  received = 0;
+  for (uint32_t round = 0; round < ROUNDS; ++round) {
+    sendBatch(queuePairs, buffer, tokens);
+    gettimeofday(&start, nullptr);
+    while (received < (uint64_t)(round + 1) * BATCH) {
+      context->receive(receiveElement);
+    }
+    gettimeofday(&stop, nullptr);
+    time += timeDiff(stop, start);
+  }
+  printResult("Per queue pair", time, (uint64_t)ROUNDS * BATCH);
+
+  // Handler per group of queue pairs
+  std::vector<uint64_t> groupCounters(GROUP_COUNT, 0);
+  for (uint32_t group = 0; group < GROUP_COUNT; ++group) {
+    uint64_t *counter = &groupCounters[group];
+    auto handler = std::make_shared<infinity::core::Context::ReceiveHandler>(
+        [handlerContext, counter,
+         &received](infinity::core::receive_element_t &element) {
+          ++*counter;
+          ++received;
+          handlerContext->postReceiveBuffer(element.buffer);
+        });
+    for (uint32_t i = group; i < QUEUE_PAIR_COUNT; i += GROUP_COUNT) {
+      context->setReceiveHandler(queuePairs[i], handler);
+    }
+  }
+  time = 0;
+  received = 0;
+  for (uint32_t round = 0; round < ROUNDS; ++round) {
+    sendBatch(queuePairs, buffer, tokens);
+    gettimeofday(&start, nullptr);
+    while (received < (uint64_t)(round + 1) * BATCH) {
+      context->receive(receiveElement);
+    }
+    gettimeofday(&stop, nullptr);
+    time += timeDiff(stop, start);
+  }
+  printResult("Per group", time, (uint64_t)ROUNDS * BATCH);
+
+  // Connection churn
+  gettimeofday(&start, nullptr);
+  for (uint32_t round = 0; round < CHURN_ROUNDS; ++round) {
+    for (uint32_t i = 0; i < CHURN; ++i) {
+      queuePairs[rand() % QUEUE_PAIR_COUNT] =
+          qpFactory.createLoopback(std::vector<char>(), &options);
+    }
+  }
+  gettimeofday(&stop, nullptr);
+  std::cout << "Replaced " << CHURN_ROUNDS * CHURN << " queue pairs in "
+            << timeDiff(stop, start) / 1000 << " msec, "
+            << context->getNumberOfRegisteredQueuePairs()
+            << " registered queue pairs" << std::endl;
+
+  return 0;
+}
+
+uint64_t timeDiff(struct timeval stop, struct timeval start) {
+  return (stop.tv_sec * 1000000L + stop.tv_usec) -
+         (start.tv_sec * 1000000L + start.tv_usec);
+}
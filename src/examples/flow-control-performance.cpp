@@ -0,0 +1,175 @@
+/**
+ * Examples - Flow Control Performance
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/queues/QueuePairFactory.h>
+#include <infinity/requests/RequestToken.h>
+
+#define QUEUE_PAIR_COUNT 4
+#define MESSAGE_COUNT 10000
+#define MESSAGE_SIZE 64
+#define WINDOW 16
+#define RECEIVE_BUFFER_COUNT 32
+#define PROCESSING_TIME 2
+
+uint64_t timeDiff(struct timeval stop, struct timeval start);
+
+void printLatency(const char *name, std::vector<uint64_t> &latencies) {
+  std::sort(latencies.begin(), latencies.end());
+  uint64_t sum = 0;
+  for (uint64_t latency : latencies) {
+    sum += latency;
+  }
+  std::cout << name << ":\t" << std::setprecision(1) << std::fixed
+            << (double)sum / latencies.size() << " usec average, "
+            << latencies[latencies.size() / 2] << " usec median, "
+            << latencies[latencies.size() * 99 / 100] << " usec 99th, "
+            << latencies.back() << " usec max" << std::endl;
+}
+
+// Usage: ./progam -s for server and ./program for client component
+// The server has RECEIVE_BUFFER_COUNT receive buffers and spends
+// PROCESSING_TIME usec on every message before it posts the buffer again.
+// The client keeps WINDOW sends outstanding on each of QUEUE_PAIR_COUNT
+// queue pairs, more than the server has buffers, and measures the time
+// from posting to completion of every send. It runs once without flow
+// control, where the overload ends in RNR retries, and once with the
+// buffers split into credits among the queue pairs.
+int main(int argc, char **argv) {
+
+  bool isServer = false;
+  int port_number = 8011;
+  const char *server_ip = "192.0.0.1";
+
+  while (argc > 1) {
+    if (argv[1][0] == '-') {
+      switch (argv[1][1]) {
+
+      case 's': {
+        isServer = true;
+        break;
+      }
+      case 'h': {
+        server_ip = argv[2];
+        ++argv;
+        --argc;
+        break;
+      }
+      case 'p': {
+        port_number = atoi(argv[2]);
+        ++argv;
+        --argc;
+      }
+      }
+    }
+    ++argv;
+    --argc;
+  }
+
+  auto context = std::make_shared<infinity::core::Context>();
+  infinity::queues::QueuePairFactory qpFactory(context);
+  const uint32_t phases[] = {0, RECEIVE_BUFFER_COUNT / QUEUE_PAIR_COUNT};
+
+  if (isServer) {
+
+    for (uint32_t i = 0; i < RECEIVE_BUFFER_COUNT; ++i) {
+      context->postReceiveBuffer(
+          infinity::memory::Buffer::createBuffer(context, MESSAGE_SIZE));
+    }
+    qpFactory.bindToPort(port_number);
+
+    for (uint32_t credits : phases) {
+      infinity::queues::QueuePairOptions options;
+      options.receiveCredits = credits;
+      qpFactory.setQueuePairOptions(options);
+
+      std::vector<std::shared_ptr<infinity::queues::QueuePair> > queuePairs;
+      for (uint32_t i = 0; i < QUEUE_PAIR_COUNT; ++i) {
+        queuePairs.push_back(qpFactory.acceptIncomingConnection());
+      }
+
+      infinity::core::receive_element_t receiveElement;
+      for (uint32_t i = 0; i < QUEUE_PAIR_COUNT * MESSAGE_COUNT; ++i) {
+        while (!context->receive(receiveElement)) {
+        }
+        struct timeval start;
+        struct timeval now;
+        gettimeofday(&start, nullptr);
+        do {
+          gettimeofday(&now, nullptr);
+        } while (timeDiff(now, start) < PROCESSING_TIME);
+        context->postReceiveBuffer(receiveElement.buffer);
+      }
+      std::cout << "Received " << QUEUE_PAIR_COUNT * MESSAGE_COUNT
+                << " messages with " << credits << " credits per queue pair"
+                << std::endl;
+    }
+
+  } else {
+
+    auto buffer = infinity::memory::Buffer::createBuffer(context, MESSAGE_SIZE);
+
+    for (uint32_t credits : phases) {
+      infinity::queues::QueuePairOptions options;
+      options.receiveCredits = credits;
+
+      std::vector<std::shared_ptr<infinity::queues::QueuePair> > queuePairs;
+      std::vector<std::unique_ptr<infinity::requests::RequestToken> > tokens;
+      for (uint32_t i = 0; i < QUEUE_PAIR_COUNT; ++i) {
+        queuePairs.push_back(qpFactory.connectToRemoteHost(
+            server_ip, port_number, nullptr, 0, &options));
+      }
+      for (uint32_t i = 0; i < QUEUE_PAIR_COUNT * WINDOW; ++i) {
+        tokens.emplace_back(new infinity::requests::RequestToken(context));
+      }
+
+      std::vector<struct timeval> starts(QUEUE_PAIR_COUNT * WINDOW);
+      std::vector<uint64_t> latencies;
+      latencies.reserve(QUEUE_PAIR_COUNT * MESSAGE_COUNT);
+      struct timeval stop;
+
+      for (uint32_t i = 0; i < MESSAGE_COUNT; ++i) {
+        for (uint32_t q = 0; q < QUEUE_PAIR_COUNT; ++q) {
+          uint32_t slot = q * WINDOW + i % WINDOW;
+          if (i >= WINDOW) {
+            tokens[slot]->waitUntilCompleted();
+            gettimeofday(&stop, nullptr);
+            latencies.push_back(timeDiff(stop, starts[slot]));
+          }
+          gettimeofday(&starts[slot], nullptr);
+          queuePairs[q]->send(buffer, tokens[slot].get());
+        }
+      }
+      for (uint32_t slot = 0; slot < QUEUE_PAIR_COUNT * WINDOW; ++slot) {
+        tokens[slot]->waitUntilCompleted();
+        gettimeofday(&stop, nullptr);
+        latencies.push_back(timeDiff(stop, starts[slot]));
+      }
+
+      printLatency(credits == 0 ? "Without credits" : "With credits",
+                   latencies);
+    }
+  }
+
+  return 0;
+}
+
+uint64_t timeDiff(struct timeval stop, struct timeval start) {
+  return (stop.tv_sec * 1000000L + stop.tv_usec) -
+         (start.tv_sec * 1000000L + start.tv_usec);
+}
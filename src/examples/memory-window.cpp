@@ -0,0 +1,174 @@
+/**
+ * Examples - Memory Window
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <string.h>
+
+#include <infinity/core/Configuration.h>
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/memory/MemoryWindow.h>
+#include <infinity/memory/RegionToken.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/queues/QueuePairFactory.h>
+#include <infinity/requests/RequestToken.h>
+
+#define BUFFER_SIZE 4096
+#define WINDOW_SIZE 1024
+#define MESSAGE_SIZE 64
+
+// Receives a message and returns the region token it holds
+infinity::memory::RegionToken
+receiveToken(std::shared_ptr<infinity::core::Context> context) {
+  infinity::core::receive_element_t receiveElement;
+  while (!context->receive(receiveElement)) {
+  }
+  infinity::memory::RegionToken token =
+      infinity::memory::RegionToken::deserialize(
+          receiveElement.buffer->getData());
+  context->postReceiveBuffer(receiveElement.buffer);
+  return token;
+}
+
+// Reads the window and checks that every byte has the expected value
+bool readWindow(std::shared_ptr<infinity::core::Context> context,
+                std::shared_ptr<infinity::queues::QueuePair> qp,
+                const infinity::memory::RegionToken &token, char expected) {
+  auto buffer = infinity::memory::Buffer::createBuffer(context, WINDOW_SIZE);
+  infinity::requests::RequestToken requestToken(context);
+  qp->read(buffer, token, WINDOW_SIZE, &requestToken);
+  requestToken.waitUntilCompleted();
+  if (!requestToken.wasSuccessful()) {
+    std::cout << "Read failed: " << requestToken.getStatusString()
+              << std::endl;
+    return false;
+  }
+  const char *data = reinterpret_cast<const char *>(buffer->getData());
+  for (uint32_t i = 0; i < WINDOW_SIZE; ++i) {
+    if (data[i] != expected) {
+      std::cout << "Read returned unexpected data" << std::endl;
+      return false;
+    }
+  }
+  std::cout << "Read " << WINDOW_SIZE << " bytes of '" << expected
+            << "' through key " << token.getRemoteKey() << std::endl;
+  return true;
+}
+
+// Usage: ./progam -s for server and ./program for client component
+// The server binds a memory window to the first part of a buffer and
+// sends its token to the client, which reads through it. The server then
+// rebinds the window to the second part and sends the new token. The
+// client reads through the new token and finally tries the old one, which
+// the device has to reject.
+int main(int argc, char **argv) {
+
+  bool isServer = false;
+  int port_number = 8011;
+  const char *server_ip = "192.0.0.1";
+
+  while (argc > 1) {
+    if (argv[1][0] == '-') {
+      switch (argv[1][1]) {
+
+      case 's': {
+        isServer = true;
+        break;
+      }
+      case 'h': {
+        server_ip = argv[2];
+        ++argv;
+        --argc;
+        break;
+      }
+      case 'p': {
+        port_number = atoi(argv[2]);
+        ++argv;
+        --argc;
+      }
+      }
+    }
+    ++argv;
+    --argc;
+  }
+
+  infinity::core::Configuration configuration =
+      infinity::core::Configuration::fromEnvironment();
+  configuration.memoryWindows = true;
+  auto context =
+      std::make_shared<infinity::core::Context>(0, 1, configuration);
+  infinity::queues::QueuePairFactory qpFactory(context);
+  infinity::requests::RequestToken requestToken(context);
+  for (uint32_t i = 0; i < 4; ++i) {
+    context->postReceiveBuffer(
+        infinity::memory::Buffer::createBuffer(context, MESSAGE_SIZE));
+  }
+  auto message = infinity::memory::Buffer::createBuffer(context, MESSAGE_SIZE);
+
+  if (isServer) {
+
+    auto buffer = infinity::memory::Buffer::createBuffer(context, BUFFER_SIZE);
+    char *data = reinterpret_cast<char *>(buffer->getData());
+    memset(data, 'A', WINDOW_SIZE);
+    memset(data + WINDOW_SIZE, 'B', WINDOW_SIZE);
+    auto window = std::make_shared<infinity::memory::MemoryWindow>(context);
+
+    qpFactory.bindToPort(port_number);
+    auto qp = qpFactory.acceptIncomingConnection();
+
+    uint64_t offsets[] = {0, WINDOW_SIZE};
+    for (uint64_t offset : offsets) {
+      qp->bindMemoryWindow(window, buffer, offset, WINDOW_SIZE,
+                           IBV_ACCESS_REMOTE_READ, &requestToken);
+      requestToken.waitUntilCompleted();
+      std::cout << "Bound window at offset " << offset << " with key "
+                << window->getRemoteKey() << std::endl;
+      window->createRegionToken().serialize(message->getData());
+      qp->send(message, infinity::memory::RegionToken::SERIALIZED_SIZE_IN_BYTES,
+               &requestToken);
+      requestToken.waitUntilCompleted();
+
+      // Wait until the client has read through the window
+      infinity::core::receive_element_t receiveElement;
+      while (!context->receive(receiveElement)) {
+      }
+      context->postReceiveBuffer(receiveElement.buffer);
+    }
+
+    qp->invalidateMemoryWindow(window, &requestToken);
+    requestToken.waitUntilCompleted();
+    std::cout << "Invalidated window" << std::endl;
+
+  } else {
+
+    auto qp = qpFactory.connectToRemoteHost(server_ip, port_number);
+
+    infinity::memory::RegionToken firstToken = receiveToken(context);
+    bool success = readWindow(context, qp, firstToken, 'A');
+    qp->send(message, MESSAGE_SIZE, &requestToken);
+    requestToken.waitUntilCompleted();
+
+    infinity::memory::RegionToken secondToken = receiveToken(context);
+    success = readWindow(context, qp, secondToken, 'B') && success;
+    qp->send(message, MESSAGE_SIZE, &requestToken);
+    requestToken.waitUntilCompleted();
+
+    // The rebind changed the key, the first token must not work anymore.
+    // The failed read moves the queue pair to the error state.
+    std::cout << "Reading through the old key" << std::endl;
+    bool staleRead = readWindow(context, qp, firstToken, 'A');
+    std::cout << (success && !staleRead ? "Memory window behaves correctly"
+                                        : "Memory window check FAILED")
+              << std::endl;
+    return (success && !staleRead) ? 0 : 1;
+  }
+
+  return 0;
+}
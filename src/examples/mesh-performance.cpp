@@ -0,0 +1,161 @@
+/**
+ * Examples - Mesh Performance
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <string>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/queues/MeshBootstrap.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/requests/RequestToken.h>
+#include <infinity/utils/RendezvousStore.h>
+
+#define DEFAULT_RANK_COUNT 8
+
+uint64_t timeDiff(struct timeval stop, struct timeval start);
+void runRank(uint32_t rank, uint32_t numberOfRanks,
+             const std::string &directory, bool lazy);
+
+// Usage: ./program [-n ranks] [-d directory] [-l] [-r rank]
+// Without -r, forks one process per rank on this machine. With -r, runs a
+// single rank, e.g. on several machines sharing the directory. Eager mode
+// connects a full mesh and sends one message to every peer. Lazy mode
+// only connects and uses the two ring neighbours of every rank.
+int main(int argc, char **argv) {
+
+  uint32_t numberOfRanks = DEFAULT_RANK_COUNT;
+  int32_t rank = -1;
+  bool lazy = false;
+  std::string directory = "/tmp/infinity-mesh-" + std::to_string(getpid());
+
+  while (argc > 1) {
+    if (argv[1][0] == '-') {
+      switch (argv[1][1]) {
+
+      case 'n': {
+        numberOfRanks = atoi(argv[2]);
+        ++argv;
+        --argc;
+        break;
+      }
+      case 'd': {
+        directory = argv[2];
+        ++argv;
+        --argc;
+        break;
+      }
+      case 'r': {
+        rank = atoi(argv[2]);
+        ++argv;
+        --argc;
+        break;
+      }
+      case 'l': {
+        lazy = true;
+        break;
+      }
+      }
+    }
+    ++argv;
+    --argc;
+  }
+
+  if (rank >= 0) {
+    runRank(rank, numberOfRanks, directory, lazy);
+    return 0;
+  }
+
+  // Devices are opened after forking, verbs resources do not survive fork
+  for (uint32_t i = 0; i < numberOfRanks; ++i) {
+    if (fork() == 0) {
+      runRank(i, numberOfRanks, directory, lazy);
+      return 0;
+    }
+  }
+  for (uint32_t i = 0; i < numberOfRanks; ++i) {
+    wait(nullptr);
+  }
+
+  return 0;
+}
+
+void runRank(uint32_t rank, uint32_t numberOfRanks,
+             const std::string &directory, bool lazy) {
+
+  auto context = std::make_shared<infinity::core::Context>();
+  auto store =
+      std::make_shared<infinity::utils::FileRendezvousStore>(directory);
+  infinity::queues::MeshBootstrap mesh(context, store, rank, numberOfRanks,
+                                       lazy);
+
+  std::vector<uint32_t> peers;
+  if (lazy) {
+    // Lower neighbour first, so no two ranks wait for each other in a cycle
+    uint32_t next = (rank + 1) % numberOfRanks;
+    uint32_t previous = (rank + numberOfRanks - 1) % numberOfRanks;
+    peers.push_back(std::min(next, previous));
+    if (next != previous) {
+      peers.push_back(std::max(next, previous));
+    }
+  } else {
+    for (uint32_t peer = 0; peer < numberOfRanks; ++peer) {
+      if (peer != rank) {
+        peers.push_back(peer);
+      }
+    }
+  }
+
+  std::vector<std::shared_ptr<infinity::memory::Buffer> > receiveBuffers;
+  for (uint32_t i = 0; i < peers.size(); ++i) {
+    receiveBuffers.emplace_back(
+        infinity::memory::Buffer::createBuffer(context, sizeof(uint32_t)));
+    context->postReceiveBuffer(receiveBuffers.back());
+  }
+
+  struct timeval start;
+  struct timeval stop;
+  gettimeofday(&start, nullptr);
+  mesh.connect();
+  for (uint32_t peer : peers) {
+    mesh.getQueuePair(peer);
+  }
+  gettimeofday(&stop, nullptr);
+
+  auto sendBuffer =
+      infinity::memory::Buffer::createBuffer(context, sizeof(uint32_t));
+  *reinterpret_cast<uint32_t *>(sendBuffer->getData()) = rank;
+  infinity::requests::RequestToken requestToken(context);
+  for (uint32_t peer : peers) {
+    mesh.getQueuePair(peer)->send(sendBuffer, &requestToken);
+    requestToken.waitUntilCompleted();
+  }
+
+  infinity::core::receive_element_t receiveElement;
+  for (uint32_t i = 0; i < peers.size(); ++i) {
+    while (!context->receive(receiveElement))
+      ;
+  }
+
+  std::cout << "Rank " << rank << " connected to " << peers.size()
+            << " peers in " << std::setprecision(1) << std::fixed
+            << timeDiff(stop, start) / 1000.0 << " ms" << std::endl;
+}
+
+uint64_t timeDiff(struct timeval stop, struct timeval start) {
+  return (stop.tv_sec * 1000000L + stop.tv_usec) -
+         (start.tv_sec * 1000000L + start.tv_usec);
+}
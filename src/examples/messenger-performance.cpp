@@ -0,0 +1,145 @@
+/**
+ * Examples - Messenger Performance
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/queues/Messenger.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/queues/QueuePairFactory.h>
+#include <infinity/requests/RequestToken.h>
+
+#define MAX_MESSAGE_SIZE (4 * 1024 * 1024)
+#define EAGER_THRESHOLD 4096
+#define RECEIVE_BUFFER_COUNT 16
+#define ROUNDS 256
+#define REPLY_SIZE 4
+
+uint64_t timeDiff(struct timeval stop, struct timeval start);
+
+// Usage: ./progam -s for server and ./program for client component
+// The client sends messages of growing size to the server, which fetches
+// every message into its destination buffer and replies with a small
+// message. The first run sends everything eagerly, so the server needs
+// receive buffers for the largest message and copies out of them. The
+// second run uses a rendezvous above EAGER_THRESHOLD bytes, the server
+// reads large messages straight into the destination buffer. Each run
+// uses its own context, on the given port and the port after it.
+int main(int argc, char **argv) {
+
+  bool isServer = false;
+  int port_number = 8011;
+  const char *server_ip = "192.0.0.1";
+
+  while (argc > 1) {
+    if (argv[1][0] == '-') {
+      switch (argv[1][1]) {
+
+      case 's': {
+        isServer = true;
+        break;
+      }
+      case 'h': {
+        server_ip = argv[2];
+        ++argv;
+        --argc;
+        break;
+      }
+      case 'p': {
+        port_number = atoi(argv[2]);
+        ++argv;
+        --argc;
+      }
+      }
+    }
+    ++argv;
+    --argc;
+  }
+
+  const uint32_t thresholds[] = {MAX_MESSAGE_SIZE, EAGER_THRESHOLD};
+  const uint32_t sizes[] = {1024, 16 * 1024, 256 * 1024, MAX_MESSAGE_SIZE};
+
+  for (uint32_t run = 0; run < 2; ++run) {
+
+    uint32_t threshold = thresholds[run];
+    auto context = std::make_shared<infinity::core::Context>();
+    infinity::queues::QueuePairFactory qpFactory(context);
+    infinity::queues::Messenger messenger(context, threshold);
+    infinity::requests::RequestToken requestToken(context);
+    infinity::queues::message_t message;
+
+    if (isServer) {
+
+      for (uint32_t i = 0; i < RECEIVE_BUFFER_COUNT; ++i) {
+        context->postReceiveBuffer(
+            infinity::memory::Buffer::createBuffer(context, threshold));
+      }
+      auto destination =
+          infinity::memory::Buffer::createBuffer(context, MAX_MESSAGE_SIZE);
+      auto reply = infinity::memory::Buffer::createBuffer(context, REPLY_SIZE);
+      qpFactory.bindToPort(port_number + run);
+      auto qp = qpFactory.acceptIncomingConnection();
+
+      for (uint32_t i = 0; i < ROUNDS * sizeof(sizes) / sizeof(sizes[0]);
+           ++i) {
+        while (!messenger.receive(message)) {
+        }
+        messenger.fetch(message, destination);
+        messenger.send(qp, reply, 0, REPLY_SIZE, &requestToken);
+        messenger.waitUntilCompleted(&requestToken);
+      }
+      std::cout << "Finished run with eager threshold of " << threshold
+                << " bytes" << std::endl;
+
+    } else {
+
+      for (uint32_t i = 0; i < RECEIVE_BUFFER_COUNT; ++i) {
+        context->postReceiveBuffer(
+            infinity::memory::Buffer::createBuffer(context, EAGER_THRESHOLD));
+      }
+      auto source =
+          infinity::memory::Buffer::createBuffer(context, MAX_MESSAGE_SIZE);
+      auto qp = qpFactory.connectToRemoteHost(server_ip, port_number + run);
+
+      std::cout << (run == 0 ? "Eager" : "Rendezvous") << ", "
+                << RECEIVE_BUFFER_COUNT << " receive buffers of " << threshold
+                << " bytes on the server" << std::endl;
+      for (uint32_t size : sizes) {
+        struct timeval start;
+        struct timeval stop;
+        gettimeofday(&start, nullptr);
+        for (uint32_t i = 0; i < ROUNDS; ++i) {
+          messenger.send(qp, source, 0, size, &requestToken);
+          while (!messenger.receive(message)) {
+          }
+          messenger.release(message);
+          messenger.waitUntilCompleted(&requestToken);
+        }
+        gettimeofday(&stop, nullptr);
+        uint64_t time = timeDiff(stop, start);
+        std::cout << "  " << size << " bytes:\t" << std::setprecision(1)
+                  << std::fixed << (double)time / ROUNDS
+                  << " usec round trip, " << std::setprecision(2)
+                  << (double)size * ROUNDS / time / 1000.0 << " GB/sec"
+                  << std::endl;
+      }
+    }
+  }
+
+  return 0;
+}
+
+uint64_t timeDiff(struct timeval stop, struct timeval start) {
+  return (stop.tv_sec * 1000000L + stop.tv_usec) -
+         (start.tv_sec * 1000000L + start.tv_usec);
+}
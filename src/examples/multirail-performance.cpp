@@ -0,0 +1,222 @@
+/**
+ * Examples - Multi-Rail Performance
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/core/MultiRailContext.h>
+#include <infinity/memory/MultiRailBuffer.h>
+#include <infinity/queues/MultiRailQueuePair.h>
+#include <infinity/queues/MultiRailQueuePairFactory.h>
+#include <infinity/requests/MultiRailRequestToken.h>
+#include <infinity/requests/RequestToken.h>
+
+#define BUFFER_SIZE (64 * 1024 * 1024)
+#define MESSAGE_SIZE (64 * 1024)
+#define WINDOW 16
+#define ROUNDS 16
+
+uint64_t timeDiff(struct timeval stop, struct timeval start);
+std::vector<infinity::core::rail_t> parseRails(const char *list);
+void printThroughput(const char *name, uint64_t bytes, uint64_t time);
+
+// Usage: ./progam -s for server and ./program for client component
+// Both sides open one context per rail, by default every active port of
+// every device, or the rails given with -r device:port,device:port. Two
+// soft-RoCE devices on one host are enough to try it out. The client
+// writes BUFFER_SIZE bytes ROUNDS times over the first rail only, then
+// as MESSAGE_SIZE writes spread over all rails by bytes outstanding, and
+// finally as single writes striped over all rails.
+int main(int argc, char **argv) {
+
+  bool isServer = false;
+  int port_number = 8011;
+  const char *server_ip = "192.0.0.1";
+  std::vector<infinity::core::rail_t> rails;
+
+  while (argc > 1) {
+    if (argv[1][0] == '-') {
+      switch (argv[1][1]) {
+
+      case 's': {
+        isServer = true;
+        break;
+      }
+      case 'h': {
+        server_ip = argv[2];
+        ++argv;
+        --argc;
+        break;
+      }
+      case 'p': {
+        port_number = atoi(argv[2]);
+        ++argv;
+        --argc;
+        break;
+      }
+      case 'r': {
+        rails = parseRails(argv[2]);
+        ++argv;
+        --argc;
+        break;
+      }
+      }
+    }
+    ++argv;
+    --argc;
+  }
+
+  if (rails.empty()) {
+    rails = infinity::core::MultiRailContext::findActiveRails();
+  }
+  auto context = std::make_shared<infinity::core::MultiRailContext>(rails);
+  for (uint32_t rail = 0; rail < context->getNumberOfRails(); ++rail) {
+    std::cout << "Rail " << rail << ": device " << rails[rail].device
+              << " port " << rails[rail].devicePort << ", NUMA node "
+              << context->getNumaNode(rail) << "\n";
+  }
+
+  infinity::queues::MultiRailQueuePairFactory qpFactory(context);
+  auto buffer = std::make_shared<infinity::memory::MultiRailBuffer>(
+      context, BUFFER_SIZE, context->getRailsByLocality()[0]);
+  auto controlBuffer =
+      std::make_shared<infinity::memory::MultiRailBuffer>(context, 64);
+
+  if (isServer) {
+
+    for (uint32_t rail = 0; rail < context->getNumberOfRails(); ++rail) {
+      context->getContext(rail)->postReceiveBuffer(
+          controlBuffer->getBuffer(rail));
+    }
+
+    infinity::memory::multi_rail_token_t token = buffer->createToken();
+    qpFactory.bindToPort(port_number);
+    auto qp = qpFactory.acceptIncomingConnection(&token, sizeof(token));
+
+    infinity::core::receive_element_t receiveElement;
+    uint32_t rail = 0;
+    while (!context->receive(receiveElement, rail)) {
+    }
+    std::cout << "Client finished, message arrived on rail " << rail << "\n";
+
+  } else {
+
+    auto qp = qpFactory.connectToRemoteHost(server_ip, port_number);
+    infinity::memory::multi_rail_token_t token;
+    memcpy(&token, qp->getUserData(), sizeof(token));
+
+    struct timeval start;
+    struct timeval stop;
+    uint64_t bytes = (uint64_t)BUFFER_SIZE * ROUNDS;
+
+    // Single rail
+    std::vector<std::unique_ptr<infinity::requests::RequestToken> > tokens;
+    for (uint32_t i = 0; i < WINDOW; ++i) {
+      tokens.emplace_back(
+          new infinity::requests::RequestToken(context->getContext(0)));
+    }
+    infinity::memory::RegionToken railToken =
+        infinity::memory::MultiRailBuffer::getRegionToken(token, 0);
+    uint32_t operations = bytes / MESSAGE_SIZE;
+    gettimeofday(&start, nullptr);
+    for (uint32_t i = 0; i < operations; ++i) {
+      infinity::requests::RequestToken *requestToken =
+          tokens[i % WINDOW].get();
+      if (i >= WINDOW) {
+        requestToken->waitUntilCompleted();
+      }
+      uint64_t offset = ((uint64_t)i * MESSAGE_SIZE) % BUFFER_SIZE;
+      qp->getQueuePair(0)->write(buffer->getBuffer(0), offset, railToken,
+                                 offset, MESSAGE_SIZE,
+                                 infinity::queues::OperationFlags(),
+                                 requestToken);
+    }
+    for (uint32_t i = 0; i < WINDOW; ++i) {
+      tokens[i]->waitUntilCompleted();
+    }
+    gettimeofday(&stop, nullptr);
+    printThroughput("Single rail", bytes, timeDiff(stop, start));
+
+    // Spread over all rails
+    std::vector<std::unique_ptr<infinity::requests::MultiRailRequestToken> >
+        multiRailTokens;
+    for (uint32_t i = 0; i < WINDOW; ++i) {
+      multiRailTokens.emplace_back(
+          new infinity::requests::MultiRailRequestToken(context));
+    }
+    std::vector<uint64_t> railOperations(context->getNumberOfRails(), 0);
+    gettimeofday(&start, nullptr);
+    for (uint32_t i = 0; i < operations; ++i) {
+      infinity::requests::MultiRailRequestToken *requestToken =
+          multiRailTokens[i % WINDOW].get();
+      if (i >= WINDOW) {
+        requestToken->waitUntilCompleted();
+      }
+      ++railOperations[qp->selectRail(buffer->getNumaNode())];
+      uint64_t offset = ((uint64_t)i * MESSAGE_SIZE) % BUFFER_SIZE;
+      qp->write(buffer, offset, token, offset, MESSAGE_SIZE, requestToken);
+    }
+    for (uint32_t i = 0; i < WINDOW; ++i) {
+      multiRailTokens[i]->waitUntilCompleted();
+    }
+    gettimeofday(&stop, nullptr);
+    printThroughput("Spread", bytes, timeDiff(stop, start));
+    for (uint32_t rail = 0; rail < railOperations.size(); ++rail) {
+      std::cout << "  rail " << rail << ": " << railOperations[rail]
+                << " writes\n";
+    }
+
+    // Striped over all rails
+    gettimeofday(&start, nullptr);
+    for (uint32_t i = 0; i < ROUNDS; ++i) {
+      qp->write(buffer, 0, token, 0, BUFFER_SIZE, multiRailTokens[0].get());
+      multiRailTokens[0]->waitUntilCompleted();
+    }
+    gettimeofday(&stop, nullptr);
+    printThroughput("Striped", bytes, timeDiff(stop, start));
+
+    qp->send(controlBuffer, 0, controlBuffer->getSizeInBytes(),
+             multiRailTokens[0].get());
+    multiRailTokens[0]->waitUntilCompleted();
+  }
+
+  return 0;
+}
+
+uint64_t timeDiff(struct timeval stop, struct timeval start) {
+  return (stop.tv_sec * 1000000L + stop.tv_usec) -
+         (start.tv_sec * 1000000L + start.tv_usec);
+}
+
+std::vector<infinity::core::rail_t> parseRails(const char *list) {
+  std::vector<infinity::core::rail_t> rails;
+  unsigned int device = 0;
+  unsigned int port = 0;
+  int consumed = 0;
+  while (sscanf(list, "%u:%u%n", &device, &port, &consumed) == 2) {
+    rails.push_back({(uint16_t)device, (uint16_t)port});
+    list += consumed;
+    if (*list != ',') {
+      break;
+    }
+    ++list;
+  }
+  return rails;
+}
+
+void printThroughput(const char *name, uint64_t bytes, uint64_t time) {
+  std::cout << name << ": " << std::setprecision(2) << std::fixed
+            << (double)bytes / time / 1000.0 << " GB/sec\n";
+}
@@ -0,0 +1,129 @@
+/**
+ * Examples - Queue Pair Pool Performance
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/queues/QueuePairFactory.h>
+#include <infinity/queues/QueuePairPool.h>
+
+#define CONNECTION_COUNT 1000
+
+uint64_t timeDiff(struct timeval stop, struct timeval start);
+
+void printLatency(const char *name, std::vector<uint64_t> &latencies) {
+  std::sort(latencies.begin(), latencies.end());
+  uint64_t sum = 0;
+  for (uint64_t latency : latencies) {
+    sum += latency;
+  }
+  std::cout << name << ":\t" << std::setprecision(1) << std::fixed
+            << (double)sum / latencies.size() << " usec average, "
+            << latencies[latencies.size() / 2] << " usec median, "
+            << latencies[latencies.size() * 99 / 100] << " usec 99th"
+            << std::endl;
+}
+
+// Usage: ./progam -s for server and ./program for client component
+// The client opens CONNECTION_COUNT short-lived connections one after
+// another and drops each one right away, first with new queue pairs on
+// both sides and then with queue pairs from a pool, which are recycled
+// when dropped. Pool size and refill rate come from the configuration,
+// e.g. INFINITY_QP_POOL_SIZE.
+int main(int argc, char **argv) {
+
+  bool isServer = false;
+  int port_number = 8011;
+  const char *server_ip = "192.0.0.1";
+
+  while (argc > 1) {
+    if (argv[1][0] == '-') {
+      switch (argv[1][1]) {
+
+      case 's': {
+        isServer = true;
+        break;
+      }
+      case 'h': {
+        server_ip = argv[2];
+        ++argv;
+        --argc;
+        break;
+      }
+      case 'p': {
+        port_number = atoi(argv[2]);
+        ++argv;
+        --argc;
+      }
+      }
+    }
+    ++argv;
+    --argc;
+  }
+
+  auto context = std::make_shared<infinity::core::Context>();
+  auto qpFactory =
+      std::make_shared<infinity::queues::QueuePairFactory>(context);
+  auto pool = std::make_shared<infinity::queues::QueuePairPool>(context);
+
+  struct timeval start;
+  struct timeval stop;
+
+  if (isServer) {
+
+    std::cout << "Accepting connections on " << port_number << "\n";
+    qpFactory->bindToPort(port_number);
+    for (uint32_t i = 0; i < 2 * CONNECTION_COUNT; ++i) {
+      if (i == CONNECTION_COUNT) {
+        qpFactory->setQueuePairPool(pool);
+      }
+      qpFactory->acceptIncomingConnection();
+    }
+
+  } else {
+
+    std::vector<uint64_t> latencies(CONNECTION_COUNT);
+    for (uint32_t i = 0; i < CONNECTION_COUNT; ++i) {
+      gettimeofday(&start, nullptr);
+      qpFactory->connectToRemoteHost(server_ip, port_number);
+      gettimeofday(&stop, nullptr);
+      latencies[i] = timeDiff(stop, start);
+    }
+    printLatency("New queue pairs", latencies);
+
+    pool->waitUntilFull(10000);
+    qpFactory->setQueuePairPool(pool);
+    for (uint32_t i = 0; i < CONNECTION_COUNT; ++i) {
+      gettimeofday(&start, nullptr);
+      qpFactory->connectToRemoteHost(server_ip, port_number);
+      gettimeofday(&stop, nullptr);
+      latencies[i] = timeDiff(stop, start);
+    }
+    printLatency("Pooled queue pairs", latencies);
+
+    std::cout << "Pool of " << pool->getSize() << ": "
+              << pool->getNumberOfHits() << " hits, "
+              << pool->getNumberOfMisses() << " misses, "
+              << pool->getNumberOfRecycledQueuePairs() << " recycled"
+              << std::endl;
+  }
+
+  return 0;
+}
+
+uint64_t timeDiff(struct timeval stop, struct timeval start) {
+  return (stop.tv_sec * 1000000L + stop.tv_usec) -
+         (start.tv_sec * 1000000L + start.tv_usec);
+}
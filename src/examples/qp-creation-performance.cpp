@@ -0,0 +1,115 @@
+/**
+ * Examples - Queue Pair Creation Performance
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <string>
+#include <sys/time.h>
+#include <vector>
+
+#include <infinity/core/Configuration.h>
+#include <infinity/core/Context.h>
+#include <infinity/queues/QueuePair.h>
+
+#define QUEUE_PAIR_COUNT 1000
+#define ROUNDS 5
+
+uint64_t timeDiff(struct timeval stop, struct timeval start);
+
+// Usage: ./program [-d depth]
+// Creates and destroys QUEUE_PAIR_COUNT queue pairs ROUNDS times. No
+// remote side is needed. The queue lengths come from the environment
+// (e.g. INFINITY_SEND_QUEUE_DEPTH) or from -d, which sets the send and
+// receive depth of every queue pair in code. Afterwards, the estimated
+// memory of QUEUE_PAIR_COUNT queue pairs of every sizing profile is shown.
+int main(int argc, char **argv) {
+
+  infinity::core::Configuration configuration =
+      infinity::core::Configuration::fromEnvironment();
+
+  while (argc > 1) {
+    if (argv[1][0] == '-') {
+      switch (argv[1][1]) {
+
+      case 'd': {
+        configuration.sendQueueDepth = atoi(argv[2]);
+        configuration.recvQueueDepth = atoi(argv[2]);
+        ++argv;
+        --argc;
+        break;
+      }
+      }
+    }
+    ++argv;
+    --argc;
+  }
+
+  auto context =
+      std::make_shared<infinity::core::Context>(0, 1, configuration);
+  std::cout << "Send queue depth "
+            << infinity::core::Configuration::sendQueueLength(context)
+            << ", receive queue depth "
+            << infinity::core::Configuration::recvQueueLength(context)
+            << ", " << infinity::core::Configuration::maxNumberOfSGEElements(
+                           context)
+            << " scatter/gather elements\n";
+
+  std::vector<std::shared_ptr<infinity::queues::QueuePair> > queuePairs;
+  queuePairs.reserve(QUEUE_PAIR_COUNT);
+
+  for (uint32_t round = 0; round < ROUNDS; ++round) {
+
+    struct timeval start;
+    struct timeval stop;
+
+    gettimeofday(&start, nullptr);
+    for (uint32_t i = 0; i < QUEUE_PAIR_COUNT; ++i) {
+      queuePairs.emplace_back(
+          std::make_shared<infinity::queues::QueuePair>(context));
+    }
+    gettimeofday(&stop, nullptr);
+    uint64_t createTime = timeDiff(stop, start);
+
+    gettimeofday(&start, nullptr);
+    queuePairs.clear();
+    gettimeofday(&stop, nullptr);
+    uint64_t destroyTime = timeDiff(stop, start);
+
+    std::cout << "Round " << round << ":\t" << std::setprecision(1)
+              << std::fixed
+              << ((double)QUEUE_PAIR_COUNT * 1000000L) / createTime
+              << " created/sec\t"
+              << ((double)QUEUE_PAIR_COUNT * 1000000L) / destroyTime
+              << " destroyed/sec" << std::endl;
+  }
+
+  const char *profileNames[] = {"default", "rpc-small", "bulk",
+                                "atomic-only"};
+  for (const char *name : profileNames) {
+    infinity::queues::QueuePairProfile profile;
+    infinity::queues::QueuePairOptions::parseProfile(name, profile);
+    infinity::queues::QueuePairOptions options =
+        infinity::queues::QueuePairOptions::forProfile(profile);
+    for (uint32_t i = 0; i < QUEUE_PAIR_COUNT; ++i) {
+      queuePairs.emplace_back(
+          std::make_shared<infinity::queues::QueuePair>(context, options));
+    }
+    std::cout << "\nProfile " << name << ":\n" << std::flush;
+    context->printMemoryUsage();
+    queuePairs.clear();
+  }
+
+  return 0;
+}
+
+uint64_t timeDiff(struct timeval stop, struct timeval start) {
+  return (stop.tv_sec * 1000000L + stop.tv_usec) -
+         (start.tv_sec * 1000000L + start.tv_usec);
+}
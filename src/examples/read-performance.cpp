@@ -18,6 +18,7 @@
 #include <infinity/core/Context.h>
 #include <infinity/memory/Buffer.h>
 #include <infinity/memory/RegionToken.h>
+#include <infinity/memory/RegionTokenTable.h>
 #include <infinity/queues/QueuePair.h>
 #include <infinity/queues/QueuePairFactory.h>
 #include <infinity/requests/RequestToken.h>
@@ -25,10 +26,16 @@
 #define BUFFER_COUNT 128
 #define MAX_BUFFER_SIZE 4096 * 8 * 4 * 4 * 4
 #define OPERATIONS_COUNT 1024
+#define MAX_READ_DEPTH 64
+#define READ_DEPTH_MESSAGE_SIZE 4096
 
 uint64_t timeDiff(struct timeval stop, struct timeval start);
 
 // Usage: ./progam -s for server and ./program for client component
+// The client first reads one message at a time for every message size,
+// then keeps 1 to MAX_READ_DEPTH reads of READ_DEPTH_MESSAGE_SIZE bytes in
+// flight. Depths beyond what the queue pairs agreed on are queued by the
+// device.
 int main(int argc, char **argv) {
   bool isServer = false;
   int port_number = 8011;
@@ -78,10 +85,17 @@ int main(int argc, char **argv) {
       }
     }
 
+    // Only the token of the table goes through the connection user data,
+    // the client reads the table itself
+    infinity::memory::RegionTokenTable tokenTable(context, regionTokens);
+    char serializedToken
+        [infinity::memory::RegionToken::SERIALIZED_SIZE_IN_BYTES];
+    tokenTable.createRegionToken().serialize(serializedToken);
+
     std::cout << "Waiting for incoming connection on " << port_number << "\n";
     qpFactory->bindToPort(port_number);
-    qp = qpFactory->acceptIncomingConnection(
-        &regionTokens[0], sizeof(regionTokens[0]) * regionTokens.size());
+    qp = qpFactory->acceptIncomingConnection(serializedToken,
+                                             sizeof(serializedToken));
 
     auto receiveBuffer = infinity::memory::Buffer::createBuffer(context, 1);
     context->postReceiveBuffer(receiveBuffer);
@@ -97,8 +111,11 @@ int main(int argc, char **argv) {
               << "\n";
     qp = qpFactory->connectToRemoteHost(server_ip, port_number);
 
-    infinity::memory::RegionToken *remoteBufferTokens =
-        (infinity::memory::RegionToken *)qp->getUserData();
+    std::cout << "Fetching region tokens\n";
+    std::unique_ptr<infinity::memory::RegionTokenTable> remoteBufferTokens =
+        infinity::memory::RegionTokenTable::fetch(
+            context, qp,
+            infinity::memory::RegionToken::deserialize(qp->getUserData()));
 
     std::cout << "Creating buffers\n";
     auto readBuffer =
@@ -116,13 +133,14 @@ int main(int argc, char **argv) {
 
       for (uint32_t i = 0; i < OPERATIONS_COUNT; ++i) {
         infinity::requests::RequestToken requestToken(context);
-        qp->read(readBuffer, remoteBufferTokens[sizeIndex], &requestToken);
+        qp->read(readBuffer, remoteBufferTokens->getToken(sizeIndex),
+                 &requestToken);
         requestToken.waitUntilCompleted();
       }
 
       /* Make sure we really did the read. */
-      for (uint64_t i = 0; i < remoteBufferTokens[sizeIndex].getSizeInBytes();
-           i++) {
+      for (uint64_t i = 0;
+           i < remoteBufferTokens->getToken(sizeIndex).getSizeInBytes(); i++) {
         const char value = reinterpret_cast<char *>(readBuffer->getData())[i];
         if (value != char(i)) {
           std::cout << "data not properly transfered " << int(i)
@@ -143,6 +161,48 @@ int main(int argc, char **argv) {
       messageSize *= 2;
     }
 
+    std::cout << "Reading messages of size " << READ_DEPTH_MESSAGE_SIZE
+              << " bytes with up to " << MAX_READ_DEPTH
+              << " reads in flight, the queue pair allows "
+              << (uint32_t)qp->getOptions().maxReadAtomic << "\n";
+    std::vector<std::unique_ptr<infinity::requests::RequestToken> >
+        requestTokens;
+    for (uint32_t i = 0; i < MAX_READ_DEPTH; ++i) {
+      requestTokens.emplace_back(
+          new infinity::requests::RequestToken(context));
+    }
+
+    for (uint32_t depth = 1; depth <= MAX_READ_DEPTH; depth *= 2) {
+
+      struct timeval start;
+      gettimeofday(&start, nullptr);
+
+      for (uint32_t i = 0; i < OPERATIONS_COUNT; ++i) {
+        infinity::requests::RequestToken *requestToken =
+            requestTokens[i % depth].get();
+        if (i >= depth) {
+          requestToken->waitUntilCompleted();
+        }
+        qp->read(readBuffer, remoteBufferTokens->getToken(0),
+                 READ_DEPTH_MESSAGE_SIZE, requestToken);
+      }
+      for (uint32_t i = 0; i < depth && i < OPERATIONS_COUNT; ++i) {
+        requestTokens[i]->waitUntilCompleted();
+      }
+
+      struct timeval stop;
+      gettimeofday(&stop, nullptr);
+
+      uint64_t time = timeDiff(stop, start);
+      double msgRate = ((double)(OPERATIONS_COUNT * 1000000L)) / time;
+      double bandwidth =
+          ((double)(OPERATIONS_COUNT * READ_DEPTH_MESSAGE_SIZE)) /
+          (1024 * 1024) / (((double)time) / 1000000L);
+      std::cout << "Depth " << depth << ":\t" << std::setprecision(3)
+                << std::fixed << msgRate << " msg/sec\t" << bandwidth
+                << " MB/sec" << std::endl;
+    }
+
     std::cout << "Sending notification to server\n";
     auto sendBuffer = infinity::memory::Buffer::createBuffer(context, 1);
     infinity::requests::RequestToken defaultRequestToken(context);
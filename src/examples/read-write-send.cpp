@@ -69,7 +69,11 @@ int main(int argc, char **argv) {
 
     std::cout << "Setting up connection (blocking)\n";
     qpFactory->bindToPort(port_number);
-    qp = qpFactory->acceptIncomingConnection(&bufferToken, sizeof(bufferToken));
+    char serializedToken
+        [infinity::memory::RegionToken::SERIALIZED_SIZE_IN_BYTES];
+    bufferToken.serialize(serializedToken);
+    qp = qpFactory->acceptIncomingConnection(serializedToken,
+                                             sizeof(serializedToken));
     std::cout << "Waiting for message (blocking)\n";
     infinity::core::receive_element_t receiveElement;
     while (!context->receive(receiveElement))
@@ -81,8 +85,8 @@ int main(int argc, char **argv) {
 
     std::cout << "Connecting to remote node\n";
     qp = qpFactory->connectToRemoteHost(server_ip, port_number);
-    infinity::memory::RegionToken *remoteBufferToken =
-        (infinity::memory::RegionToken *)qp->getUserData();
+    infinity::memory::RegionToken remoteBufferToken =
+        infinity::memory::RegionToken::deserialize(qp->getUserData());
 
     std::cout << "Creating buffers\n";
     auto buffer1Sided = infinity::memory::Buffer::createBuffer(context, 128);
@@ -90,11 +94,11 @@ int main(int argc, char **argv) {
 
     std::cout << "Reading content from remote buffer\n";
     infinity::requests::RequestToken requestToken(context);
-    qp->read(buffer1Sided, *remoteBufferToken, &requestToken);
+    qp->read(buffer1Sided, remoteBufferToken, &requestToken);
     requestToken.waitUntilCompleted();
 
     std::cout << "Writing content to remote buffer\n";
-    qp->write(buffer1Sided, *remoteBufferToken, &requestToken);
+    qp->write(buffer1Sided, remoteBufferToken, &requestToken);
     requestToken.waitUntilCompleted();
 
     std::cout << "Sending message to remote host\n";
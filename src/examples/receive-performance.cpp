@@ -0,0 +1,123 @@
+/**
+ * Examples - Receive Performance
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/core/ReceiveSlab.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/queues/QueuePairFactory.h>
+#include <infinity/requests/RequestToken.h>
+
+#define SLOT_COUNT 1024
+#define MESSAGE_SIZE 64
+#define ROUNDS 256
+
+uint64_t timeDiff(struct timeval stop, struct timeval start);
+void sendBatch(std::shared_ptr<infinity::core::Context> context,
+               std::shared_ptr<infinity::queues::QueuePair> qp,
+               std::shared_ptr<infinity::memory::Buffer> sendBuffer);
+
+// Usage: ./program
+// Sends messages over a loopback queue pair and measures the time spent
+// receiving and reposting them, once with one Buffer per receive and once
+// with a receive slab. Nothing is reposted in the last round, so no
+// receives are left behind when a mode is torn down.
+int main(int argc, char **argv) {
+
+  auto context = std::make_shared<infinity::core::Context>();
+  auto qpFactory =
+      std::make_shared<infinity::queues::QueuePairFactory>(context);
+  auto qp = qpFactory->createLoopback(std::vector<char>());
+  auto sendBuffer =
+      infinity::memory::Buffer::createBuffer(context, MESSAGE_SIZE);
+
+  struct timeval start;
+  struct timeval stop;
+  uint64_t receiveTime = 0;
+
+  std::cout << "Receiving into " << SLOT_COUNT << " buffers\n";
+  {
+    std::vector<std::shared_ptr<infinity::memory::Buffer> > receiveBuffers;
+    for (uint32_t i = 0; i < SLOT_COUNT; ++i) {
+      receiveBuffers.emplace_back(
+          infinity::memory::Buffer::createBuffer(context, MESSAGE_SIZE));
+      context->postReceiveBuffer(receiveBuffers.back());
+    }
+
+    infinity::core::receive_element_t receiveElement;
+    for (uint32_t round = 0; round < ROUNDS; ++round) {
+      sendBatch(context, qp, sendBuffer);
+      gettimeofday(&start, nullptr);
+      for (uint32_t i = 0; i < SLOT_COUNT; ++i) {
+        while (!context->receive(receiveElement))
+          ;
+        if (round + 1 < ROUNDS) {
+          context->postReceiveBuffer(receiveElement.buffer);
+        }
+      }
+      gettimeofday(&stop, nullptr);
+      receiveTime += timeDiff(stop, start);
+    }
+  }
+  double bufferNanos = receiveTime * 1000.0 / (ROUNDS * SLOT_COUNT);
+  std::cout << std::setprecision(1) << std::fixed << bufferNanos
+            << " ns per receive\t"
+            << sizeof(infinity::memory::Buffer) + sizeof(ibv_mr) + MESSAGE_SIZE
+            << " bytes per slot (plus NIC translation entries)\n";
+
+  std::cout << "Receiving into a slab of " << SLOT_COUNT << " slots\n";
+  receiveTime = 0;
+  {
+    infinity::core::ReceiveSlab receiveSlab(context, SLOT_COUNT, MESSAGE_SIZE);
+
+    infinity::core::receive_view_t receiveView;
+    for (uint32_t round = 0; round < ROUNDS; ++round) {
+      sendBatch(context, qp, sendBuffer);
+      gettimeofday(&start, nullptr);
+      for (uint32_t i = 0; i < SLOT_COUNT; ++i) {
+        while (!context->receive(receiveView))
+          ;
+        if (round + 1 < ROUNDS) {
+          receiveSlab.postSlot(receiveView.slot);
+        }
+      }
+      gettimeofday(&stop, nullptr);
+      receiveTime += timeDiff(stop, start);
+    }
+  }
+  double slabNanos = receiveTime * 1000.0 / (ROUNDS * SLOT_COUNT);
+  std::cout << std::setprecision(1) << std::fixed << slabNanos
+            << " ns per receive\t" << MESSAGE_SIZE << " bytes per slot"
+            << std::endl;
+
+  return 0;
+}
+
+void sendBatch(std::shared_ptr<infinity::core::Context> context,
+               std::shared_ptr<infinity::queues::QueuePair> qp,
+               std::shared_ptr<infinity::memory::Buffer> sendBuffer) {
+
+  infinity::requests::RequestToken requestToken(context);
+  for (uint32_t i = 0; i < SLOT_COUNT; ++i) {
+    qp->send(sendBuffer, MESSAGE_SIZE,
+             (i == SLOT_COUNT - 1) ? &requestToken : nullptr);
+  }
+  requestToken.waitUntilCompleted();
+}
+
+uint64_t timeDiff(struct timeval stop, struct timeval start) {
+  return (stop.tv_sec * 1000000L + stop.tv_usec) -
+         (start.tv_sec * 1000000L + start.tv_usec);
+}
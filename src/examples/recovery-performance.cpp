@@ -0,0 +1,145 @@
+/**
+ * Examples - Recovery Performance
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/memory/RegionToken.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/queues/QueuePairFactory.h>
+#include <infinity/requests/RequestToken.h>
+
+#define CYCLES 100
+#define BUFFER_SIZE 4096
+
+uint64_t timeDiff(struct timeval stop, struct timeval start);
+
+// Usage: ./progam -s for server and ./program for client component
+// The client breaks its connection CYCLES times by writing with an invalid
+// remote key, which moves the queue pair into the error state. It then
+// recovers the queue pair in place and writes again with the old region
+// token. For comparison, it finally sets up CYCLES new connections and
+// fetches the region token again, as an application without recovery
+// has to.
+int main(int argc, char **argv) {
+
+  bool isServer = false;
+  int port_number = 8011;
+  const char *server_ip = "192.0.0.1";
+
+  while (argc > 1) {
+    if (argv[1][0] == '-') {
+      switch (argv[1][1]) {
+
+      case 's': {
+        isServer = true;
+        break;
+      }
+      case 'h': {
+        server_ip = argv[2];
+        ++argv;
+        --argc;
+        break;
+      }
+      case 'p': {
+        port_number = atoi(argv[2]);
+        ++argv;
+        --argc;
+      }
+      }
+    }
+    ++argv;
+    --argc;
+  }
+
+  auto context = std::make_shared<infinity::core::Context>();
+  auto qpFactory =
+      std::make_shared<infinity::queues::QueuePairFactory>(context);
+  auto buffer = infinity::memory::Buffer::createBuffer(context, BUFFER_SIZE);
+
+  if (isServer) {
+
+    char token[infinity::memory::RegionToken::SERIALIZED_SIZE_IN_BYTES];
+    buffer->createRegionToken().serialize(token);
+
+    // Reconnecting clients get their old queue pair back, which therefore
+    // needs to stay alive
+    std::vector<std::shared_ptr<infinity::queues::QueuePair> > queuePairs;
+    qpFactory->bindToPort(port_number);
+    for (uint32_t i = 0; i < 1 + 2 * CYCLES; ++i) {
+      queuePairs.push_back(
+          qpFactory->acceptIncomingConnection(token, sizeof(token)));
+    }
+    std::cout << "Accepted " << queuePairs.size() << " connections\n";
+
+  } else {
+
+    auto qp = qpFactory->connectToRemoteHost(server_ip, port_number);
+    infinity::memory::RegionToken token =
+        infinity::memory::RegionToken::deserialize(qp->getUserData());
+    infinity::memory::RegionToken invalidToken(
+        nullptr, token.getMemoryRegionType(), token.getSizeInBytes(),
+        token.getAddress(), 0, token.getRemoteKey() + 1);
+    infinity::requests::RequestToken requestToken(context);
+
+    struct timeval start;
+    struct timeval stop;
+    uint64_t recoveryTime = 0;
+    uint32_t failed = 0;
+
+    for (uint32_t i = 0; i < CYCLES; ++i) {
+      qp->write(buffer, invalidToken, &requestToken);
+      requestToken.waitUntilCompleted();
+      if (qp->hasFailed()) {
+        ++failed;
+      }
+
+      gettimeofday(&start, nullptr);
+      qpFactory->reconnectToRemoteHost(qp, server_ip, port_number);
+      gettimeofday(&stop, nullptr);
+      recoveryTime += timeDiff(stop, start);
+
+      qp->write(buffer, token, &requestToken);
+      requestToken.waitUntilCompleted();
+      if (!requestToken.wasSuccessful()) {
+        std::cout << "Write after recovery failed: "
+                  << requestToken.getStatusString() << "\n";
+        return 1;
+      }
+    }
+    std::cout << "Recovered " << CYCLES << " times (" << failed
+              << " failed queue pairs): " << std::setprecision(3)
+              << std::fixed << recoveryTime / 1000.0 / CYCLES
+              << " msec per recovery\n";
+
+    uint64_t reconnectTime = 0;
+    for (uint32_t i = 0; i < CYCLES; ++i) {
+      gettimeofday(&start, nullptr);
+      qp = qpFactory->connectToRemoteHost(server_ip, port_number);
+      token = infinity::memory::RegionToken::deserialize(qp->getUserData());
+      gettimeofday(&stop, nullptr);
+      reconnectTime += timeDiff(stop, start);
+    }
+    std::cout << "Reconnected " << CYCLES << " times: " << std::setprecision(3)
+              << std::fixed << reconnectTime / 1000.0 / CYCLES
+              << " msec per new connection\n";
+  }
+
+  return 0;
+}
+
+uint64_t timeDiff(struct timeval stop, struct timeval start) {
+  return (stop.tv_sec * 1000000L + stop.tv_usec) -
+         (start.tv_sec * 1000000L + start.tv_usec);
+}
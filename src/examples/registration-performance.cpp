@@ -0,0 +1,170 @@
+/**
+ * Examples - Registration Performance
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+
+#define DEFAULT_BUFFER_SIZE_MB 4096
+#define DEFAULT_CHUNK_SIZE_MB 256
+
+uint64_t timeDiff(struct timeval stop, struct timeval start);
+uint64_t residentMemoryKB(const char *field);
+void compareFileRegistration(std::shared_ptr<infinity::core::Context> context,
+                             const char *path);
+
+// Usage: ./program [-m buffer size in MB] [-c chunk size in MB] [-t threads]
+//        ./program -f file
+int main(int argc, char **argv) {
+
+  uint64_t bufferSize = DEFAULT_BUFFER_SIZE_MB * 1024UL * 1024UL;
+  uint64_t chunkSize = DEFAULT_CHUNK_SIZE_MB * 1024UL * 1024UL;
+  uint32_t numberOfThreads = 0;
+  const char *path = nullptr;
+
+  while (argc > 2) {
+    if (argv[1][0] == '-') {
+      switch (argv[1][1]) {
+
+      case 'm': {
+        bufferSize = atol(argv[2]) * 1024UL * 1024UL;
+        break;
+      }
+      case 'c': {
+        chunkSize = atol(argv[2]) * 1024UL * 1024UL;
+        break;
+      }
+      case 't': {
+        numberOfThreads = atoi(argv[2]);
+        break;
+      }
+      case 'f': {
+        path = argv[2];
+        break;
+      }
+      }
+    }
+    argv += 2;
+    argc -= 2;
+  }
+
+  auto context = std::make_shared<infinity::core::Context>();
+  std::cout << "Device is attached to NUMA node " << context->getNumaNode()
+            << " with " << context->getLocalCpus().size() << " local CPUs\n";
+
+  if (path != nullptr) {
+    compareFileRegistration(context, path);
+    return 0;
+  }
+
+  struct timeval start;
+  struct timeval stop;
+
+  std::cout << "Allocating and registering " << (bufferSize >> 20)
+            << " MB as a single region\n";
+  gettimeofday(&start, nullptr);
+  {
+    auto buffer = infinity::memory::Buffer::createBuffer(context, bufferSize);
+    gettimeofday(&stop, nullptr);
+  }
+  double serialTime = timeDiff(stop, start) / 1000000.0;
+  std::cout << std::setprecision(3) << std::fixed << serialTime << " sec\n";
+
+  std::cout << "Allocating and registering " << (bufferSize >> 20)
+            << " MB in chunks of " << (chunkSize >> 20) << " MB\n";
+  gettimeofday(&start, nullptr);
+  {
+    auto buffer = infinity::memory::Buffer::createChunkedBuffer(
+        context, bufferSize, chunkSize, numberOfThreads);
+    gettimeofday(&stop, nullptr);
+    std::cout << buffer->getNumberOfChunks() << " chunks\n";
+  }
+  double chunkedTime = timeDiff(stop, start) / 1000000.0;
+  std::cout << std::setprecision(3) << std::fixed << chunkedTime << " sec\t"
+            << serialTime / chunkedTime << "x speedup" << std::endl;
+
+  return 0;
+}
+
+void compareFileRegistration(std::shared_ptr<infinity::core::Context> context,
+                             const char *path) {
+
+  struct timeval start;
+  struct timeval stop;
+
+  std::cout << "Reading " << path << " into a registered buffer\n";
+  uint64_t anonymousBefore = residentMemoryKB("RssAnon:");
+  gettimeofday(&start, nullptr);
+  {
+    int fileDescriptor = open(path, O_RDONLY);
+    uint64_t fileSize = lseek(fileDescriptor, 0, SEEK_END);
+    lseek(fileDescriptor, 0, SEEK_SET);
+    auto buffer =
+        infinity::memory::Buffer::createBuffer(context, fileSize, false);
+    char *data = reinterpret_cast<char *>(buffer->getData());
+    uint64_t bytesRead = 0;
+    while (bytesRead < fileSize) {
+      ssize_t returnValue =
+          read(fileDescriptor, data + bytesRead, fileSize - bytesRead);
+      if (returnValue <= 0) {
+        break;
+      }
+      bytesRead += returnValue;
+    }
+    close(fileDescriptor);
+    gettimeofday(&stop, nullptr);
+    std::cout << std::setprecision(3) << std::fixed
+              << timeDiff(stop, start) / 1000000.0 << " sec\t"
+              << (residentMemoryKB("RssAnon:") - anonymousBefore) / 1024
+              << " MB anonymous memory\n";
+  }
+
+  std::cout << "Mapping " << path << " and registering the mapping\n";
+  anonymousBefore = residentMemoryKB("RssAnon:");
+  gettimeofday(&start, nullptr);
+  {
+    auto buffer = infinity::memory::Buffer::createBufferFromFile(
+        context, path, false, true);
+    gettimeofday(&stop, nullptr);
+    std::cout << std::setprecision(3) << std::fixed
+              << timeDiff(stop, start) / 1000000.0 << " sec\t"
+              << (residentMemoryKB("RssAnon:") - anonymousBefore) / 1024
+              << " MB anonymous memory\t"
+              << residentMemoryKB("RssFile:") / 1024 << " MB file-backed memory"
+              << std::endl;
+  }
+}
+
+uint64_t residentMemoryKB(const char *field) {
+  uint64_t value = 0;
+  FILE *status = fopen("/proc/self/status", "r");
+  char line[256];
+  while (status != nullptr && fgets(line, sizeof(line), status) != nullptr) {
+    if (strncmp(line, field, strlen(field)) == 0) {
+      value = strtoull(line + strlen(field), nullptr, 10);
+      break;
+    }
+  }
+  if (status != nullptr) {
+    fclose(status);
+  }
+  return value;
+}
+
+uint64_t timeDiff(struct timeval stop, struct timeval start) {
+  return (stop.tv_sec * 1000000L + stop.tv_usec) -
+         (start.tv_sec * 1000000L + start.tv_usec);
+}
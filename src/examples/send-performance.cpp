@@ -14,6 +14,7 @@
 #include <unistd.h>
 
 #include <infinity/core/Context.h>
+#include <infinity/core/ReceivePool.h>
 #include <infinity/memory/Buffer.h>
 #include <infinity/memory/RegionToken.h>
 #include <infinity/queues/QueuePair.h>
@@ -65,12 +66,8 @@ int main(int argc, char **argv) {
   if (isServer) {
 
     std::cout << "Creating buffers to receive a messages\n";
-    std::vector<std::shared_ptr<infinity::memory::Buffer> > receiveBuffers;
-    for (uint32_t i = 0; i < BUFFER_COUNT; ++i) {
-      receiveBuffers.emplace_back(
-          infinity::memory::Buffer::createBuffer(context, MAX_BUFFER_SIZE));
-      context->postReceiveBuffer(receiveBuffers[i]);
-    }
+    infinity::core::ReceivePool receivePool(context, BUFFER_COUNT,
+                                            MAX_BUFFER_SIZE);
 
     std::cout << "Waiting for incoming connection\n";
     qpFactory->bindToPort(port_number);
@@ -79,9 +76,9 @@ int main(int argc, char **argv) {
     std::cout << "Waiting for first message (first message has additional "
                  "setup costs)\n";
     infinity::core::receive_element_t receiveElement;
-    while (!context->receive(receiveElement))
+    while (!receivePool.receive(receiveElement))
       ;
-    context->postReceiveBuffer(receiveElement.buffer);
+    receivePool.release(receiveElement.buffer);
 
     std::cout << "Performing measurement\n";
 
@@ -95,10 +92,10 @@ int main(int argc, char **argv) {
 
       uint32_t numberOfReceivedMessages = 0;
       while (numberOfReceivedMessages < OPERATIONS_COUNT) {
-        while (!context->receive(receiveElement))
+        while (!receivePool.receive(receiveElement))
           ;
         ++numberOfReceivedMessages;
-        context->postReceiveBuffer(receiveElement.buffer);
+        receivePool.release(receiveElement.buffer);
       }
 
       messageSize *= 2;
@@ -0,0 +1,131 @@
+/**
+ * Examples - XRC Mesh Performance
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <vector>
+
+#include <infinity/core/Configuration.h>
+#include <infinity/core/Context.h>
+#include <infinity/queues/QueuePair.h>
+
+#define REMOTE_NODES 15
+#define PROCESSES_PER_NODE 64
+
+uint64_t timeDiff(struct timeval stop, struct timeval start);
+
+void printUsage(const char *name, infinity::core::Context &context,
+                uint64_t createTime, uint64_t queuePairsPerNode) {
+  infinity::core::memory_usage_t usage = context.getMemoryUsage();
+  std::cout << name << ": " << usage.numberOfQueuePairs
+            << " queue pairs per process, " << queuePairsPerNode
+            << " per node, " << std::setprecision(1) << std::fixed
+            << usage.totalBytes / (1024.0 * 1024.0)
+            << " MB per process (estimated), created in "
+            << createTime / 1000.0 << " msec\n";
+}
+
+// Usage: ./program [-n remote nodes] [-p processes per node]
+// Simulates one process of an all-to-all mesh locally. With RC, a process
+// needs one queue pair per remote process. With XRC, it needs one send
+// queue pair per remote node, all processes of that node are reached
+// through it. Every send queue pair needs a target on the remote node, so
+// a process also holds one target per remote node on average. No remote
+// side is needed, queue pairs are created but not connected.
+int main(int argc, char **argv) {
+
+  uint32_t remoteNodes = REMOTE_NODES;
+  uint32_t processesPerNode = PROCESSES_PER_NODE;
+
+  while (argc > 1) {
+    if (argv[1][0] == '-') {
+      switch (argv[1][1]) {
+
+      case 'n': {
+        remoteNodes = atoi(argv[2]);
+        ++argv;
+        --argc;
+        break;
+      }
+      case 'p': {
+        processesPerNode = atoi(argv[2]);
+        ++argv;
+        --argc;
+        break;
+      }
+      }
+    }
+    ++argv;
+    --argc;
+  }
+
+  std::cout << "Mesh of " << remoteNodes + 1 << " nodes with "
+            << processesPerNode << " processes each\n";
+
+  struct timeval start;
+  struct timeval stop;
+  bool xrcSupported = false;
+
+  {
+    auto context = std::make_shared<infinity::core::Context>();
+    xrcSupported =
+        (context->getDeviceAttributes().device_cap_flags & IBV_DEVICE_XRC) !=
+        0;
+
+    std::vector<std::shared_ptr<infinity::queues::QueuePair> > queuePairs;
+    gettimeofday(&start, nullptr);
+    for (uint32_t i = 0; i < remoteNodes * processesPerNode; ++i) {
+      queuePairs.emplace_back(
+          std::make_shared<infinity::queues::QueuePair>(context));
+    }
+    gettimeofday(&stop, nullptr);
+    printUsage("RC ", *context, timeDiff(stop, start),
+               (uint64_t)processesPerNode * remoteNodes * processesPerNode);
+  }
+
+  if (!xrcSupported) {
+    std::cout << "XRC: not supported by the device, would need "
+              << 2 * remoteNodes << " queue pairs per process and "
+              << 2ul * processesPerNode * remoteNodes << " per node\n";
+    return 0;
+  }
+
+  {
+    infinity::core::Configuration configuration =
+        infinity::core::Configuration::fromEnvironment();
+    configuration.xrc = true;
+    auto context =
+        std::make_shared<infinity::core::Context>(0, 1, configuration);
+
+    std::vector<std::shared_ptr<infinity::queues::QueuePair> > queuePairs;
+    gettimeofday(&start, nullptr);
+    for (uint32_t node = 0; node < remoteNodes; ++node) {
+      auto nodeQueuePair =
+          std::make_shared<infinity::queues::QueuePair>(context);
+      queuePairs.push_back(nodeQueuePair);
+      // The process index stands in for its shared receive queue number
+      for (uint32_t process = 1; process < processesPerNode; ++process) {
+        queuePairs.emplace_back(std::make_shared<infinity::queues::QueuePair>(
+            nodeQueuePair, process));
+      }
+    }
+    gettimeofday(&stop, nullptr);
+    printUsage("XRC", *context, timeDiff(stop, start),
+               2ul * processesPerNode * remoteNodes);
+  }
+
+  return 0;
+}
+
+uint64_t timeDiff(struct timeval stop, struct timeval start) {
+  return (stop.tv_sec * 1000000L + stop.tv_usec) -
+         (start.tv_sec * 1000000L + start.tv_usec);
+}
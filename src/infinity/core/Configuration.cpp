@@ -1,20 +1,100 @@
 #include "Context.h"
 #include "Configuration.h"
 
+#include <algorithm>
+#include <ctype.h>
+#include <fstream>
+#include <stdlib.h>
+
+#include <infinity/utils/Debug.h>
+
+namespace {
+
+const char *const KEYS[] = {"send_cq_size",
+                            "recv_cq_size",
+                            "srq_size",
+                            "send_queue_depth",
+                            "recv_queue_depth",
+                            "sge_count",
+                            "queue_length_fraction",
+                            "sge_fraction",
+                            "xrc",
+                            "xrc_domain_file",
+                            "memory_windows",
+                            "qp_pool_size",
+                            "qp_pool_refill_rate"};
+
+uint32_t parseLength(const std::string &key, const std::string &value) {
+  char *end = nullptr;
+  unsigned long length = strtoul(value.c_str(), &end, 10);
+  INFINITY_ASSERT(!value.empty() && *end == '\0' && length <= UINT32_MAX,
+                  "[INFINITY][CORE][CONFIGURATION] Invalid value '%s' for "
+                  "%s.\n",
+                  value.c_str(), key.c_str());
+  return length;
+}
+
+double parseFraction(const std::string &key, const std::string &value) {
+  char *end = nullptr;
+  double fraction = strtod(value.c_str(), &end);
+  INFINITY_ASSERT(!value.empty() && *end == '\0' && fraction > 0 &&
+                      fraction <= 1,
+                  "[INFINITY][CORE][CONFIGURATION] Invalid value '%s' for "
+                  "%s.\n",
+                  value.c_str(), key.c_str());
+  return fraction;
+}
+
+bool parseFlag(const std::string &key, const std::string &value) {
+  INFINITY_ASSERT(value == "0" || value == "1",
+                  "[INFINITY][CORE][CONFIGURATION] Invalid value '%s' for "
+                  "%s.\n",
+                  value.c_str(), key.c_str());
+  return value == "1";
+}
+
+std::string trim(const std::string &text) {
+  size_t first = text.find_first_not_of(" \t\r");
+  if (first == std::string::npos) {
+    return "";
+  }
+  size_t last = text.find_last_not_of(" \t\r");
+  return text.substr(first, last - first + 1);
+}
+
+// Overrides are capped by the device limit, derived values are computed
+// from it
+uint32_t deriveLength(uint32_t override, int limit, double fraction) {
+  if (override != 0) {
+    return std::min<uint32_t>(override, limit);
+  }
+  return limit * fraction;
+}
+
+} /* namespace */
+
 // Must be less than MAX_CQE
 uint32_t
 infinity::core::Configuration::sendCompletionQueueLength(Context *context) {
-  ibv_device_attr deviceAttributes;
-  context->getDeviceAttr(&deviceAttributes);
-  return deviceAttributes.max_qp_wr * .25;
+  const Configuration &configuration = context->getConfiguration();
+  const ibv_device_attr &deviceAttributes = context->getDeviceAttributes();
+  return std::min<uint32_t>(
+      deriveLength(configuration.sendCompletionQueueSize,
+                   deviceAttributes.max_qp_wr,
+                   configuration.queueLengthFraction),
+      deviceAttributes.max_cqe);
 }
 
 // Must be less than MAX_CQE
 uint32_t
 infinity::core::Configuration::recvCompletionQueueLength(Context *context) {
-  ibv_device_attr deviceAttributes;
-  context->getDeviceAttr(&deviceAttributes);
-  return deviceAttributes.max_qp_wr * .25;
+  const Configuration &configuration = context->getConfiguration();
+  const ibv_device_attr &deviceAttributes = context->getDeviceAttributes();
+  return std::min<uint32_t>(
+      deriveLength(configuration.recvCompletionQueueSize,
+                   deviceAttributes.max_qp_wr,
+                   configuration.queueLengthFraction),
+      deviceAttributes.max_cqe);
 }
 
 uint32_t infinity::core::Configuration::sendCompletionQueueLength(
@@ -30,22 +110,132 @@ uint32_t infinity::core::Configuration::recvCompletionQueueLength(
 // Must be less than MAX_SRQ_WR
 uint32_t
 infinity::core::Configuration::sharedRecvQueueLength(Context *context) {
-  ibv_device_attr deviceAttributes;
-  context->getDeviceAttr(&deviceAttributes);
+  const Configuration &configuration = context->getConfiguration();
+  const ibv_device_attr &deviceAttributes = context->getDeviceAttributes();
+  if (configuration.sharedRecvQueueSize != 0) {
+    return std::min<uint32_t>(configuration.sharedRecvQueueSize,
+                              deviceAttributes.max_srq_wr - 1);
+  }
   return deviceAttributes.max_srq_wr - 1;
 }
 
+// Must be less than MAX_QP_WR
+uint32_t infinity::core::Configuration::sendQueueLength(
+    const std::shared_ptr<Context> &context) {
+  const Configuration &configuration = context->getConfiguration();
+  if (configuration.sendQueueDepth != 0) {
+    return std::min<uint32_t>(configuration.sendQueueDepth,
+                              context->getDeviceAttributes().max_qp_wr);
+  }
+  return sendCompletionQueueLength(context);
+}
+
+// Must be less than MAX_QP_WR
+uint32_t infinity::core::Configuration::recvQueueLength(
+    const std::shared_ptr<Context> &context) {
+  const Configuration &configuration = context->getConfiguration();
+  if (configuration.recvQueueDepth != 0) {
+    return std::min<uint32_t>(configuration.recvQueueDepth,
+                              context->getDeviceAttributes().max_qp_wr);
+  }
+  return recvCompletionQueueLength(context);
+}
+
 // Must be less than (MAX_QP_WR * MAX_QP)
 uint32_t infinity::core::Configuration::maxNumberOfOutstandingRequests(
     Context *context) {
-  ibv_device_attr deviceAttributes;
-  context->getDeviceAttr(&deviceAttributes);
-  return deviceAttributes.max_qp_wr;
+  return context->getDeviceAttributes().max_qp_wr;
 }
 
 uint32_t infinity::core::Configuration::maxNumberOfSGEElements(
     const std::shared_ptr<Context> &context) {
-  ibv_device_attr deviceAttributes;
-  context->getDeviceAttr(&deviceAttributes);
-  return deviceAttributes.max_sge * .125;
+  const Configuration &configuration = context->getConfiguration();
+  return deriveLength(configuration.numberOfSGEElements,
+                      context->getDeviceAttributes().max_sge,
+                      configuration.sgeFraction);
+}
+
+void infinity::core::Configuration::set(const std::string &key,
+                                        const std::string &value) {
+  if (key == "send_cq_size") {
+    this->sendCompletionQueueSize = parseLength(key, value);
+  } else if (key == "recv_cq_size") {
+    this->recvCompletionQueueSize = parseLength(key, value);
+  } else if (key == "srq_size") {
+    this->sharedRecvQueueSize = parseLength(key, value);
+  } else if (key == "send_queue_depth") {
+    this->sendQueueDepth = parseLength(key, value);
+  } else if (key == "recv_queue_depth") {
+    this->recvQueueDepth = parseLength(key, value);
+  } else if (key == "sge_count") {
+    this->numberOfSGEElements = parseLength(key, value);
+  } else if (key == "queue_length_fraction") {
+    this->queueLengthFraction = parseFraction(key, value);
+  } else if (key == "sge_fraction") {
+    this->sgeFraction = parseFraction(key, value);
+  } else if (key == "xrc") {
+    this->xrc = parseFlag(key, value);
+  } else if (key == "xrc_domain_file") {
+    this->xrcDomainFile = value;
+  } else if (key == "memory_windows") {
+    this->memoryWindows = parseFlag(key, value);
+  } else if (key == "qp_pool_size") {
+    this->queuePairPoolSize = parseLength(key, value);
+  } else if (key == "qp_pool_refill_rate") {
+    this->queuePairPoolRefillRate = parseLength(key, value);
+  } else {
+    INFINITY_ASSERT(false,
+                    "[INFINITY][CORE][CONFIGURATION] Unknown setting %s.\n",
+                    key.c_str());
+  }
+}
+
+void infinity::core::Configuration::loadFile(const std::string &path) {
+
+  std::ifstream file(path);
+  INFINITY_ASSERT(file.is_open(),
+                  "[INFINITY][CORE][CONFIGURATION] Cannot open %s.\n",
+                  path.c_str());
+
+  std::string line;
+  uint32_t lineNumber = 0;
+  while (std::getline(file, line)) {
+    ++lineNumber;
+    line = trim(line.substr(0, line.find('#')));
+    if (line.empty()) {
+      continue;
+    }
+    size_t separator = line.find('=');
+    INFINITY_ASSERT(separator != std::string::npos,
+                    "[INFINITY][CORE][CONFIGURATION] Expected key = value in "
+                    "line %u of %s.\n",
+                    lineNumber, path.c_str());
+    set(trim(line.substr(0, separator)), trim(line.substr(separator + 1)));
+  }
+}
+
+void infinity::core::Configuration::loadEnvironment() {
+
+  for (const char *key : KEYS) {
+    std::string variable = "INFINITY_";
+    for (const char *c = key; *c != '\0'; ++c) {
+      variable += toupper(*c);
+    }
+    const char *value = getenv(variable.c_str());
+    if (value != nullptr) {
+      set(key, value);
+    }
+  }
+}
+
+infinity::core::Configuration
+infinity::core::Configuration::fromEnvironment() {
+
+  Configuration configuration;
+  const char *path = getenv("INFINITY_CONFIG_FILE");
+  if (path != nullptr) {
+    configuration.loadFile(path);
+  }
+  configuration.loadEnvironment();
+  return configuration;
 }
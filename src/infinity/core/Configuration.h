@@ -11,6 +11,7 @@
 
 #include <memory>
 #include <stdint.h>
+#include <string>
 
 namespace infinity {
 namespace core {
@@ -20,7 +21,8 @@ class Configuration {
 
 public:
   /**
-   * Queue length settings
+   * Queue length settings, derived from the configuration of the context
+   * and capped by the device limits
    */
 
   static uint32_t sendCompletionQueueLength(Context *context); // Must be less
@@ -38,6 +40,12 @@ public:
   static uint32_t sharedRecvQueueLength(Context *context); // Must be less than
                                                            // MAX_SRQ_WR
 
+  static uint32_t sendQueueLength(
+      const std::shared_ptr<Context> &context); // Must be less than MAX_QP_WR
+
+  static uint32_t recvQueueLength(
+      const std::shared_ptr<Context> &context); // Must be less than MAX_QP_WR
+
   static uint32_t maxNumberOfOutstandingRequests(
       Context *context); // Must be less than (MAX_QP_WR * MAX_QP)
                          // Since we use one single shared receive queue,
@@ -46,6 +54,67 @@ public:
   static uint32_t maxNumberOfSGEElements(
       const std::shared_ptr<Context> &context); // Must be less than MAX_SGE
 
+public:
+  /**
+   * Overrides of the queue lengths, 0 derives the value from the device.
+   * Completion queues default to queueLengthFraction of MAX_QP_WR, queue
+   * pairs to the length of the completion queues and scatter/gather lists
+   * to sgeFraction of MAX_SGE.
+   */
+
+  uint32_t sendCompletionQueueSize = 0;
+  uint32_t recvCompletionQueueSize = 0;
+  uint32_t sharedRecvQueueSize = 0;
+  uint32_t sendQueueDepth = 0;
+  uint32_t recvQueueDepth = 0;
+  uint32_t numberOfSGEElements = 0;
+
+  double queueLengthFraction = 0.25;
+  double sgeFraction = 0.125;
+
+  /**
+   * Connect queue pairs with XRC instead of RC. Processes which name the
+   * same domain file share one XRC domain, so that a remote process needs
+   * only one send queue pair per node instead of one per process.
+   */
+  bool xrc = false;
+  std::string xrcDomainFile;
+
+  /**
+   * Register memory so that type 2 memory windows can be bound to it, if
+   * the device supports them
+   */
+  bool memoryWindows = false;
+
+  /**
+   * Queue pairs kept ready by a QueuePairPool and how many it creates per
+   * second in the background, 0 creates them as fast as possible
+   */
+  uint32_t queuePairPoolSize = 16;
+  uint32_t queuePairPoolRefillRate = 0;
+
+public:
+  /**
+   * Set a value by name, e.g. "send_cq_size" or "sge_fraction"
+   */
+  void set(const std::string &key, const std::string &value);
+
+  /**
+   * Read "key = value" lines, # starts a comment
+   */
+  void loadFile(const std::string &path);
+
+  /**
+   * Read INFINITY_<KEY> variables, e.g. INFINITY_SEND_CQ_SIZE
+   */
+  void loadEnvironment();
+
+  /**
+   * Defaults, overridden by the file named in INFINITY_CONFIG_FILE and then
+   * by the environment
+   */
+  static Configuration fromEnvironment();
+
 public:
   /**
    * System settings
@@ -58,6 +127,9 @@ public:
       1024; // Size of the user data which can be transmitted when establishing
             // a connection
 
+  static const uint32_t ATOMIC_ARRAY_SLOTS =
+      1024; // Result slots shared by all atomic operations of a context
+
   static constexpr const char *DEFAULT_IB_DEVICE =
       "ib0"; // Default name of IB device
 };
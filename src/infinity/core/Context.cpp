@@ -8,25 +8,53 @@
 
 #include "Context.h"
 
+#include <algorithm>
+#include <fcntl.h>
+#include <stdio.h>
 #include <string.h>
 #include <limits>
+#include <unistd.h>
 #include <arpa/inet.h>
 
 #include <infinity/core/Configuration.h>
+#include <infinity/core/ReceivePool.h>
+#include <infinity/core/ReceiveSlab.h>
 #include <infinity/queues/QueuePair.h>
 #include <infinity/memory/Atomic.h>
+#include <infinity/memory/AtomicArray.h>
 #include <infinity/memory/Buffer.h>
 #include <infinity/requests/RequestToken.h>
 #include <infinity/utils/Debug.h>
+#include <infinity/utils/Numa.h>
 
 namespace infinity {
 namespace core {
 
+namespace {
+
+const uint32_t COMPLETION_ENTRY_SIZE_IN_BYTES = 64;
+const uint32_t RECEIVE_ENTRY_SIZE_IN_BYTES = 32;
+
+/**
+ * Control and address segments, then one segment per scatter/gather
+ * element or the inline data, whichever is larger
+ */
+uint64_t estimateSendEntrySize(uint32_t numberOfSGEElements,
+                               uint32_t maxInlineData) {
+  uint64_t size = 48 + std::max<uint64_t>(16 * numberOfSGEElements,
+                                          maxInlineData + 4);
+  return (size + 63) / 64 * 64;
+}
+
+} /* namespace */
+
 /*******************************
  * Context
  ******************************/
 
-Context::Context(uint16_t device, uint16_t devicePort) {
+Context::Context(uint16_t device, uint16_t devicePort,
+                 const Configuration &configuration)
+    : configuration(configuration) {
 
   // Get IB device list
   int32_t numberOfInstalledDevices = 0;
@@ -56,12 +84,34 @@ Context::Context(uint16_t device, uint16_t devicePort) {
       this->ibvProtectionDomain != nullptr,
       "[INFINITY][CORE][CONTEXT] Could not allocate protection domain.\n");
 
-  // Get the LID
-  ibv_port_attr portAttributes;
-  ibv_query_port(this->ibvContext, devicePort, &portAttributes);
-  this->ibvLocalDeviceId = portAttributes.lid;
+  // Query the device and port once, everything else uses the cached copies
+  memset(&this->ibvDeviceAttributes, 0, sizeof(ibv_device_attr));
+  int32_t returnValue =
+      ibv_query_device(this->ibvContext, &this->ibvDeviceAttributes);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][CORE][CONTEXT] Cannot get device attributes.\n");
+  memset(&this->ibvPortAttributes, 0, sizeof(ibv_port_attr));
+  returnValue =
+      ibv_query_port(this->ibvContext, devicePort, &this->ibvPortAttributes);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][CORE][CONTEXT] Cannot get attributes of port "
+                  "%u.\n",
+                  devicePort);
+  this->ibvLocalDeviceId = this->ibvPortAttributes.lid;
   this->ibvDevicePort = devicePort;
 
+  // Find out where the device is attached
+  this->numaNode = infinity::utils::Numa::getNumaNodeOfDevice(this->ibvDevice);
+  this->localCpus =
+      infinity::utils::Numa::getLocalCpusOfDevice(this->ibvDevice);
+
+  // Type 2 memory windows are opt-in, binding them needs an extra access
+  // flag on every registration
+  this->memoryWindowsSupported =
+      this->configuration.memoryWindows &&
+      (this->ibvDeviceAttributes.device_cap_flags &
+       (IBV_DEVICE_MEM_WINDOW_TYPE_2A | IBV_DEVICE_MEM_WINDOW_TYPE_2B)) != 0;
+
   // Allocate completion queues
   this->ibvSendCompletionQueue = ibv_create_cq(
       this->ibvContext,
@@ -73,25 +123,61 @@ Context::Context(uint16_t device, uint16_t devicePort) {
       nullptr, 0);
 
   // Allocate shared receive queue
-  ibv_srq_init_attr sia;
-  memset(&sia, 0, sizeof(ibv_srq_init_attr));
+  ibv_srq_init_attr_ex sia;
+  memset(&sia, 0, sizeof(ibv_srq_init_attr_ex));
   sia.srq_context = this->ibvContext;
   sia.attr.max_wr = std::max(Configuration::sharedRecvQueueLength(this), 1u);
   sia.attr.max_sge = 1;
-  this->ibvSharedReceiveQueue = ibv_create_srq(this->ibvProtectionDomain, &sia);
+  sia.comp_mask = IBV_SRQ_INIT_ATTR_TYPE | IBV_SRQ_INIT_ATTR_PD;
+  sia.srq_type = IBV_SRQT_BASIC;
+  sia.pd = this->ibvProtectionDomain;
+  if (this->configuration.xrc) {
+    openXrcDomain();
+    sia.comp_mask |= IBV_SRQ_INIT_ATTR_XRCD | IBV_SRQ_INIT_ATTR_CQ;
+    sia.srq_type = IBV_SRQT_XRC;
+    sia.xrcd = this->ibvXrcDomain;
+    sia.cq = this->ibvReceiveCompletionQueue;
+  }
+  this->ibvSharedReceiveQueue = ibv_create_srq_ex(this->ibvContext, &sia);
   INFINITY_ASSERT(
       this->ibvSharedReceiveQueue != nullptr,
       "[INFINITY][CORE][CONTEXT] Could not allocate shared receive queue.\n");
+  if (this->configuration.xrc) {
+    returnValue = ibv_get_srq_num(this->ibvSharedReceiveQueue,
+                                  &this->sharedReceiveQueueNumber);
+    INFINITY_ASSERT(returnValue == 0, "[INFINITY][CORE][CONTEXT] Cannot get "
+                                      "number of shared receive queue.\n");
+  }
+
+  if (sia.attr.max_wr > static_cast<uint32_t>(
+                            this->ibvReceiveCompletionQueue->cqe)) {
+    INFINITY_DEBUG("[INFINITY][CORE][CONTEXT] Shared receive queue (%u) is "
+                   "larger than the receive completion queue (%d).\n",
+                   sia.attr.max_wr, this->ibvReceiveCompletionQueue->cqe);
+  }
 }
 
 Context::~Context() noexcept(false) {
 
+  // Release atomic result slots
+  this->atomicArray.reset();
+
   // Destroy shared receive queue
   int returnValue = ibv_destroy_srq(this->ibvSharedReceiveQueue);
   INFINITY_ASSERT(
       returnValue == 0,
       "[INFINITY][CORE][CONTEXT] Could not delete shared receive queue\n");
 
+  // Close XRC domain after its shared receive queue
+  if (this->ibvXrcDomain != nullptr) {
+    returnValue = ibv_close_xrcd(this->ibvXrcDomain);
+    INFINITY_ASSERT(returnValue == 0,
+                    "[INFINITY][CORE][CONTEXT] Could not close XRC domain\n");
+  }
+  if (this->xrcDomainFileDescriptor >= 0) {
+    close(this->xrcDomainFileDescriptor);
+  }
+
   // Destroy completion queues
   returnValue = ibv_destroy_cq(this->ibvSendCompletionQueue);
   INFINITY_ASSERT(
@@ -114,6 +200,33 @@ Context::~Context() noexcept(false) {
                   "[INFINITY][CORE][CONTEXT] Could not close device\n");
 }
 
+void Context::openXrcDomain() {
+
+  INFINITY_ASSERT(
+      (this->ibvDeviceAttributes.device_cap_flags & IBV_DEVICE_XRC) != 0,
+      "[INFINITY][CORE][CONTEXT] Device does not support XRC.\n");
+
+  // Processes opening the same file share the domain
+  ibv_xrcd_init_attr xrcdAttributes;
+  memset(&xrcdAttributes, 0, sizeof(ibv_xrcd_init_attr));
+  xrcdAttributes.comp_mask =
+      IBV_XRCD_INIT_ATTR_FD | IBV_XRCD_INIT_ATTR_OFLAGS;
+  xrcdAttributes.oflags = O_CREAT;
+  if (!this->configuration.xrcDomainFile.empty()) {
+    this->xrcDomainFileDescriptor = open(
+        this->configuration.xrcDomainFile.c_str(), O_RDONLY | O_CREAT, 0600);
+    INFINITY_ASSERT(this->xrcDomainFileDescriptor >= 0,
+                    "[INFINITY][CORE][CONTEXT] Cannot open XRC domain file "
+                    "%s.\n",
+                    this->configuration.xrcDomainFile.c_str());
+  }
+  xrcdAttributes.fd = this->xrcDomainFileDescriptor;
+
+  this->ibvXrcDomain = ibv_open_xrcd(this->ibvContext, &xrcdAttributes);
+  INFINITY_ASSERT(this->ibvXrcDomain != nullptr,
+                  "[INFINITY][CORE][CONTEXT] Could not open XRC domain.\n");
+}
+
 void
 Context::postReceiveBuffer(std::shared_ptr<infinity::memory::Buffer> buffer) {
 
@@ -145,52 +258,278 @@ Context::postReceiveBuffer(std::shared_ptr<infinity::memory::Buffer> buffer) {
   INFINITY_ASSERT(
       returnValue == 0,
       "[INFINITY][CORE][CONTEXT] Cannot post buffer to receive queue.\n");
+
+  this->grantReceiveCredits(1);
+}
+
+void Context::postReceiveBuffers(
+    const std::vector<std::shared_ptr<infinity::memory::Buffer> > &buffers) {
+
+  if (buffers.empty()) {
+    return;
+  }
+
+  // Create scatter-getters and chain the work requests
+  std::vector<ibv_sge> isges(buffers.size());
+  std::vector<ibv_recv_wr> wrs(buffers.size());
+  for (size_t i = 0; i < buffers.size(); ++i) {
+
+    INFINITY_ASSERT(buffers[i]->getSizeInBytes() <=
+                        std::numeric_limits<uint32_t>::max(),
+                    "[INFINITY][CORE][CONTEXT] Cannot post receive buffer "
+                    "which is larger than max(uint32_t).\n");
+
+    memset(&isges[i], 0, sizeof(ibv_sge));
+    isges[i].addr = buffers[i]->getAddress();
+    isges[i].length = static_cast<uint32_t>(buffers[i]->getSizeInBytes());
+    isges[i].lkey = buffers[i]->getLocalKey();
+
+    memset(&wrs[i], 0, sizeof(ibv_recv_wr));
+    wrs[i].wr_id = reinterpret_cast<uint64_t>(buffers[i].get());
+    wrs[i].next = (i + 1 < buffers.size()) ? &wrs[i + 1] : nullptr;
+    wrs[i].sg_list = &isges[i];
+    wrs[i].num_sge = 1;
+  }
+
+  // Post all buffers to shared receive queue
+  ibv_recv_wr *badwr;
+  uint32_t returnValue =
+      ibv_post_srq_recv(this->ibvSharedReceiveQueue, &wrs[0], &badwr);
+  INFINITY_ASSERT(
+      returnValue == 0,
+      "[INFINITY][CORE][CONTEXT] Cannot post buffers to receive queue.\n");
+
+  this->grantReceiveCredits(buffers.size());
 }
 
 void Context::getDeviceAttr(ibv_device_attr *device_attr) {
-  memset(device_attr, 0, sizeof(*device_attr));
-  int returnValue = ibv_query_device(getInfiniBandContext(), device_attr);
-  INFINITY_ASSERT(returnValue == 0,
-                  "[INFINITY][CORE][CONTEXT] Cannot get device attributes.\n");
+  *device_attr = this->ibvDeviceAttributes;
 }
 
-bool Context::receive(receive_element_t &receiveElement) {
+const ibv_device_attr &Context::getDeviceAttributes() {
+  return this->ibvDeviceAttributes;
+}
 
-  return receive(receiveElement.buffer, receiveElement.bytesWritten,
-                 receiveElement.immediateValue,
-                 receiveElement.immediateValueValid, receiveElement.queuePair);
+const ibv_port_attr &Context::getPortAttributes() {
+  return this->ibvPortAttributes;
 }
 
-bool Context::receive(std::shared_ptr<infinity::memory::Buffer> &buffer,
-                      uint32_t &bytesWritten, uint32_t &immediateValue,
-                      bool &immediateValueValid,
-                      std::shared_ptr<infinity::queues::QueuePair> &queuePair) {
+const Configuration &Context::getConfiguration() {
+  return this->configuration;
+}
+
+memory_usage_t Context::getMemoryUsage() {
+
+  std::lock_guard<std::mutex> lock(this->queuePairMutex);
+  memory_usage_t usage;
+  usage.numberOfQueuePairs = this->numberOfQueuePairs;
+  usage.sendQueueEntries = this->sendQueueEntries;
+  usage.sendQueueBytes = this->sendQueueBytes;
+  usage.sendCompletionQueueEntries = this->ibvSendCompletionQueue->cqe;
+  usage.recvCompletionQueueEntries = this->ibvReceiveCompletionQueue->cqe;
+  usage.completionQueueBytes =
+      (uint64_t)(usage.sendCompletionQueueEntries +
+                 usage.recvCompletionQueueEntries) *
+      COMPLETION_ENTRY_SIZE_IN_BYTES;
+  usage.sharedRecvQueueEntries = Configuration::sharedRecvQueueLength(this);
+  usage.sharedRecvQueueBytes =
+      (uint64_t)usage.sharedRecvQueueEntries * RECEIVE_ENTRY_SIZE_IN_BYTES;
+  usage.totalBytes = usage.sendQueueBytes + usage.completionQueueBytes +
+                     usage.sharedRecvQueueBytes;
+  return usage;
+}
+
+void Context::printMemoryUsage() {
+
+  memory_usage_t usage = getMemoryUsage();
+  printf("Queue pairs:              %u\n", usage.numberOfQueuePairs);
+  printf("Send queues:              %lu entries, %.1f MB\n",
+         usage.sendQueueEntries, usage.sendQueueBytes / (1024.0 * 1024.0));
+  printf("Completion queues:        %u + %u entries, %.1f MB\n",
+         usage.sendCompletionQueueEntries, usage.recvCompletionQueueEntries,
+         usage.completionQueueBytes / (1024.0 * 1024.0));
+  printf("Shared receive queue:     %u entries, %.1f MB\n",
+         usage.sharedRecvQueueEntries,
+         usage.sharedRecvQueueBytes / (1024.0 * 1024.0));
+  printf("Total (estimated):        %.1f MB\n",
+         usage.totalBytes / (1024.0 * 1024.0));
+}
+
+void Context::attachQueuePair(uint32_t sendQueueDepth,
+                              uint32_t numberOfSGEElements,
+                              uint32_t maxInlineData) {
+
+  std::lock_guard<std::mutex> lock(this->queuePairMutex);
+  ++this->numberOfQueuePairs;
+  this->sendQueueEntries += sendQueueDepth;
+  this->sendQueueBytes +=
+      sendQueueDepth *
+      estimateSendEntrySize(numberOfSGEElements, maxInlineData);
+
+  // Every send queue entry may produce a completion, grow the completion
+  // queue geometrically so that it keeps up
+  if (this->sendQueueEntries <=
+      static_cast<uint64_t>(this->ibvSendCompletionQueue->cqe)) {
+    return;
+  }
+  uint64_t size = std::max<uint64_t>(
+      this->sendQueueEntries, 2 * (uint64_t)this->ibvSendCompletionQueue->cqe);
+  size = std::min<uint64_t>(size, this->ibvDeviceAttributes.max_cqe);
+  if (size > static_cast<uint64_t>(this->ibvSendCompletionQueue->cqe)) {
+    // A device that cannot resize keeps the old queue, the warning below
+    // still applies
+    int returnValue = ibv_resize_cq(this->ibvSendCompletionQueue, size);
+    if (returnValue != 0) {
+      INFINITY_DEBUG("[INFINITY][CORE][CONTEXT] Cannot resize send "
+                     "completion queue to %lu entries. %s.\n",
+                     size, strerror(returnValue));
+    }
+  }
+  if (this->sendQueueEntries >
+          static_cast<uint64_t>(this->ibvSendCompletionQueue->cqe) &&
+      !this->sendCompletionQueueWarningPrinted) {
+    INFINITY_DEBUG("[INFINITY][CORE][CONTEXT] %lu send queue entries can "
+                   "overflow the send completion queue (%d). Use smaller "
+                   "queue pairs or signal fewer requests.\n",
+                   this->sendQueueEntries, this->ibvSendCompletionQueue->cqe);
+    this->sendCompletionQueueWarningPrinted = true;
+  }
+}
+
+void Context::detachQueuePair(uint32_t sendQueueDepth,
+                              uint32_t numberOfSGEElements,
+                              uint32_t maxInlineData) {
+
+  std::lock_guard<std::mutex> lock(this->queuePairMutex);
+  --this->numberOfQueuePairs;
+  this->sendQueueEntries -= sendQueueDepth;
+  this->sendQueueBytes -=
+      sendQueueDepth *
+      estimateSendEntrySize(numberOfSGEElements, maxInlineData);
+}
+
+bool Context::receive(receive_element_t &receiveElement) {
 
   ibv_wc wc;
-  if (ibv_poll_cq(this->ibvReceiveCompletionQueue, 1, &wc) > 0) {
+  while (ibv_poll_cq(this->ibvReceiveCompletionQueue, 1, &wc) > 0) {
+
+    // The completion is already consumed, keep it for the slab path
+    if (isSlabWorkRequest(wc.wr_id)) {
+      this->deferredSlabCompletions.push_back(wc);
+      continue;
+    }
+
+    // With a shared XRC domain, the target may belong to another process
+    std::shared_ptr<ReceiveHandler> receiveHandler;
+    lookupQueuePair(wc.qp_num, receiveElement.queuePair, &receiveHandler);
+    if (this->flowControlInUse.load()) {
+      this->consumeReceiveCredit(receiveElement.queuePair);
+    }
 
     if (wc.opcode == IBV_WC_RECV) {
       auto receiveBuffer =
           reinterpret_cast<infinity::memory::Buffer *>(wc.wr_id);
-      buffer = receiveBuffer->getptr();
-      bytesWritten = wc.byte_len;
+      receiveElement.buffer = receiveBuffer->getptr();
+      receiveElement.bytesWritten = wc.byte_len;
+      if (this->receivePool != nullptr) {
+        this->receivePool->consumeSlot(receiveBuffer);
+      }
     } else if (wc.opcode == IBV_WC_RECV_RDMA_WITH_IMM) {
-      buffer.reset();
-      bytesWritten = wc.byte_len;
+      receiveElement.buffer.reset();
+      receiveElement.bytesWritten = wc.byte_len;
       auto receiveBuffer =
           reinterpret_cast<infinity::memory::Buffer *>(wc.wr_id);
       this->postReceiveBuffer(receiveBuffer->getptr());
     }
 
     if (wc.wc_flags & IBV_WC_WITH_IMM) {
-      immediateValue = ntohl(wc.imm_data);
-      immediateValueValid = true;
+      receiveElement.immediateValue = ntohl(wc.imm_data);
+      receiveElement.immediateValueValid = true;
+    } else {
+      receiveElement.immediateValue = 0;
+      receiveElement.immediateValueValid = false;
+    }
+
+    // Dispatched receives are not returned, keep polling
+    if (receiveHandler != nullptr) {
+      (*receiveHandler)(receiveElement);
+      continue;
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+bool Context::receive(std::shared_ptr<infinity::memory::Buffer> &buffer,
+                      uint32_t &bytesWritten, uint32_t &immediateValue,
+                      bool &immediateValueValid,
+                      std::shared_ptr<infinity::queues::QueuePair> &queuePair) {
+
+  receive_element_t receiveElement;
+  if (!receive(receiveElement)) {
+    return false;
+  }
+
+  buffer = std::move(receiveElement.buffer);
+  bytesWritten = receiveElement.bytesWritten;
+  immediateValue = receiveElement.immediateValue;
+  immediateValueValid = receiveElement.immediateValueValid;
+  queuePair = std::move(receiveElement.queuePair);
+  return true;
+}
+
+bool Context::receive(receive_view_t &receiveView) {
+
+  ibv_wc wc;
+  bool deferred = !this->deferredSlabCompletions.empty();
+  if (deferred) {
+    wc = this->deferredSlabCompletions.front();
+    this->deferredSlabCompletions.pop_front();
+  }
+  if (deferred || ibv_poll_cq(this->ibvReceiveCompletionQueue, 1, &wc) > 0) {
+
+    if (this->flowControlInUse.load()) {
+      std::shared_ptr<infinity::queues::QueuePair> queuePair;
+      lookupQueuePair(wc.qp_num, queuePair);
+      this->consumeReceiveCredit(queuePair);
+    }
+
+    bool withData = (wc.opcode == IBV_WC_RECV);
+    if (isSlabWorkRequest(wc.wr_id)) {
+      receiveView.slot = ReceiveSlab::getSlotOfWorkRequest(wc.wr_id);
+      if (withData) {
+        receiveView.data = this->receiveSlab->getSlotData(receiveView.slot);
+      } else {
+        receiveView.data = nullptr;
+        this->receiveSlab->postSlot(receiveView.slot);
+      }
+    } else {
+      auto receiveBuffer =
+          reinterpret_cast<infinity::memory::Buffer *>(wc.wr_id);
+      receiveView.slot = ReceiveSlab::INVALID_SLOT;
+      if (withData) {
+        receiveView.data = receiveBuffer->getData();
+        if (this->receivePool != nullptr) {
+          this->receivePool->consumeSlot(receiveBuffer);
+        }
+      } else {
+        receiveView.data = nullptr;
+        this->postReceiveBuffer(receiveBuffer->getptr());
+      }
+    }
+    receiveView.bytesWritten = wc.byte_len;
+
+    if (wc.wc_flags & IBV_WC_WITH_IMM) {
+      receiveView.immediateValue = ntohl(wc.imm_data);
+      receiveView.immediateValueValid = true;
     } else {
-      immediateValue = 0;
-      immediateValueValid = false;
+      receiveView.immediateValue = 0;
+      receiveView.immediateValueValid = false;
     }
 
-    queuePair = queuePairMap.at(wc.qp_num).lock();
+    receiveView.queuePairNumber = wc.qp_num;
 
     return true;
   }
@@ -200,6 +539,10 @@ bool Context::receive(std::shared_ptr<infinity::memory::Buffer> &buffer,
 
 bool Context::pollSendCompletionQueue() {
 
+  if (this->numberOfBlockedQueuePairs.load() > 0) {
+    this->progressBlockedQueuePairs();
+  }
+
   ibv_wc wc;
   if (ibv_poll_cq(this->ibvSendCompletionQueue, 1, &wc) > 0) {
 
@@ -222,19 +565,291 @@ bool Context::pollSendCompletionQueue() {
   return false;
 }
 
+void Context::setReceiveHandler(
+    const std::shared_ptr<infinity::queues::QueuePair> &queuePair,
+    const std::shared_ptr<ReceiveHandler> &receiveHandler) {
+
+  std::lock_guard<std::shared_timed_mutex> lock(this->queuePairTableMutex);
+  INFINITY_ASSERT(queuePair->registrySlot != NOT_REGISTERED,
+                  "[INFINITY][CORE][CONTEXT] Queue pair %u is not "
+                  "connected.\n",
+                  queuePair->getQueuePairNumber());
+  this->queuePairTable[queuePair->registrySlot].receiveHandler =
+      receiveHandler;
+}
+
+void Context::setAsyncEventHandler(AsyncEventHandler asyncEventHandler) {
+  this->asyncEventHandler = asyncEventHandler;
+}
+
+void Context::handleAsyncEvent(const ibv_async_event &event) {
+
+  if (this->asyncEventHandler) {
+    this->asyncEventHandler(event);
+  } else {
+    INFINITY_DEBUG("[INFINITY][CORE][CONTEXT] Unhandled asynchronous event "
+                   "%s.\n",
+                   ibv_event_type_str(event.event_type));
+  }
+}
+
+uint32_t Context::getNumberOfRegisteredQueuePairs() {
+  std::lock_guard<std::shared_timed_mutex> lock(this->queuePairTableMutex);
+  return this->queuePairTable.size() - this->freeQueuePairSlots.size();
+}
+
 void Context::registerQueuePair(
     std::shared_ptr<infinity::queues::QueuePair> queuePair) {
-  this->queuePairMap.insert({ queuePair->getQueuePairNumber(), queuePair });
+
+  std::lock_guard<std::shared_timed_mutex> lock(this->queuePairTableMutex);
+
+  // Queue pairs recovered in place are registered again in their slot,
+  // their handler stays
+  uint32_t slot = queuePair->registrySlot;
+  if (slot == NOT_REGISTERED) {
+    if (this->freeQueuePairSlots.empty()) {
+      slot = this->queuePairTable.size();
+      this->queuePairTable.push_back({});
+    } else {
+      slot = this->freeQueuePairSlots.back();
+      this->freeQueuePairSlots.pop_back();
+    }
+    queuePair->registrySlot = slot;
+  } else {
+    removeFromQueuePairIndex(slot);
+  }
+
+  // Receives report the queue pair they arrived at, the target with XRC
+  registered_queue_pair_t &entry = this->queuePairTable[slot];
+  entry.queuePair = queuePair;
+  entry.queuePairNumber = queuePair->getQueuePairNumber();
+  entry.targetQueuePairNumber = queuePair->getTargetQueuePairNumber();
+  setQueuePairSlot(entry.queuePairNumber, slot);
+  if (entry.targetQueuePairNumber != 0) {
+    setQueuePairSlot(entry.targetQueuePairNumber, slot);
+  }
 }
 
+void Context::unregisterQueuePair(infinity::queues::QueuePair *queuePair) {
+
+  std::lock_guard<std::shared_timed_mutex> lock(this->queuePairTableMutex);
+
+  uint32_t slot = queuePair->registrySlot;
+  if (slot == NOT_REGISTERED) {
+    return;
+  }
+
+  removeFromQueuePairIndex(slot);
+  registered_queue_pair_t &entry = this->queuePairTable[slot];
+  entry.queuePair.reset();
+  entry.queuePairNumber = 0;
+  entry.targetQueuePairNumber = 0;
+  entry.receiveHandler = nullptr;
+  this->freeQueuePairSlots.push_back(slot);
+  queuePair->registrySlot = NOT_REGISTERED;
+}
+
+std::shared_ptr<infinity::queues::QueuePair>
+Context::findQueuePair(uint32_t queuePairNumber) {
+
+  // Only the queue pair's own number, not the number of its XRC target
+  std::shared_lock<std::shared_timed_mutex> lock(this->queuePairTableMutex);
+  uint32_t slot = findQueuePairSlot(queuePairNumber);
+  if (slot == NOT_REGISTERED ||
+      this->queuePairTable[slot].queuePairNumber != queuePairNumber) {
+    return nullptr;
+  }
+  return this->queuePairTable[slot].queuePair.lock();
+}
+
+void Context::lookupQueuePair(
+    uint32_t queuePairNumber,
+    std::shared_ptr<infinity::queues::QueuePair> &queuePair,
+    std::shared_ptr<ReceiveHandler> *receiveHandler) {
+
+  std::shared_lock<std::shared_timed_mutex> lock(this->queuePairTableMutex);
+  uint32_t slot = findQueuePairSlot(queuePairNumber);
+  if (slot == NOT_REGISTERED) {
+    queuePair.reset();
+    return;
+  }
+  const registered_queue_pair_t &entry = this->queuePairTable[slot];
+  queuePair = entry.queuePair.lock();
+  if (receiveHandler != nullptr && entry.receiveHandler != nullptr) {
+    *receiveHandler = entry.receiveHandler;
+  }
+}
+
+// Caller holds the queue pair table mutex
+uint32_t Context::findQueuePairSlot(uint32_t queuePairNumber) {
+  const std::unique_ptr<uint32_t[]> &page =
+      this->queuePairIndex[(queuePairNumber & 0xFFFFFF) >>
+                           QUEUE_PAIR_INDEX_PAGE_BITS];
+  if (page == nullptr) {
+    return NOT_REGISTERED;
+  }
+  return page[queuePairNumber & (QUEUE_PAIR_INDEX_PAGE_SIZE - 1)];
+}
+
+// Caller holds the queue pair table mutex exclusively
+void Context::setQueuePairSlot(uint32_t queuePairNumber, uint32_t slot) {
+  std::unique_ptr<uint32_t[]> &page =
+      this->queuePairIndex[(queuePairNumber & 0xFFFFFF) >>
+                           QUEUE_PAIR_INDEX_PAGE_BITS];
+  if (page == nullptr) {
+    page.reset(new uint32_t[QUEUE_PAIR_INDEX_PAGE_SIZE]);
+    std::fill(page.get(), page.get() + QUEUE_PAIR_INDEX_PAGE_SIZE,
+              NOT_REGISTERED);
+  }
+  page[queuePairNumber & (QUEUE_PAIR_INDEX_PAGE_SIZE - 1)] = slot;
+}
+
+// Caller holds the queue pair table mutex exclusively
+void Context::removeFromQueuePairIndex(uint32_t slot) {
+
+  const registered_queue_pair_t &entry = this->queuePairTable[slot];
+  uint32_t numbers[] = {entry.queuePairNumber, entry.targetQueuePairNumber};
+  for (uint32_t queuePairNumber : numbers) {
+    if (queuePairNumber != 0 && findQueuePairSlot(queuePairNumber) == slot) {
+      setQueuePairSlot(queuePairNumber, NOT_REGISTERED);
+    }
+  }
+}
+
+void Context::consumeReceiveCredit(
+    const std::shared_ptr<infinity::queues::QueuePair> &queuePair) {
+
+  if (queuePair != nullptr && queuePair->grantsReceiveCredits()) {
+    std::lock_guard<std::mutex> lock(this->receiveCreditMutex);
+    this->receiveCreditQueue.push_back(queuePair);
+  }
+}
+
+void Context::grantReceiveCredits(uint32_t numberOfBuffers) {
+
+  if (!this->flowControlInUse.load()) {
+    return;
+  }
+
+  std::vector<std::shared_ptr<infinity::queues::QueuePair> > queuePairs;
+  {
+    std::lock_guard<std::mutex> lock(this->receiveCreditMutex);
+    while (numberOfBuffers > 0 && !this->receiveCreditQueue.empty()) {
+      queuePairs.push_back(this->receiveCreditQueue.front().lock());
+      this->receiveCreditQueue.pop_front();
+      --numberOfBuffers;
+    }
+  }
+
+  // Granting may post a credit update, which is done without the lock
+  for (auto &queuePair : queuePairs) {
+    if (queuePair != nullptr) {
+      queuePair->grantReceiveCredit();
+    }
+  }
+}
+
+void Context::blockQueuePair(infinity::queues::QueuePair *queuePair) {
+
+  std::lock_guard<std::mutex> lock(this->blockedQueuePairMutex);
+  if (std::find(this->blockedQueuePairs.begin(), this->blockedQueuePairs.end(),
+                queuePair) == this->blockedQueuePairs.end()) {
+    this->blockedQueuePairs.push_back(queuePair);
+  }
+  this->numberOfBlockedQueuePairs = this->blockedQueuePairs.size();
+}
+
+void Context::unblockQueuePair(infinity::queues::QueuePair *queuePair) {
+
+  std::lock_guard<std::mutex> lock(this->blockedQueuePairMutex);
+  this->blockedQueuePairs.erase(std::remove(this->blockedQueuePairs.begin(),
+                                            this->blockedQueuePairs.end(),
+                                            queuePair),
+                                this->blockedQueuePairs.end());
+  this->numberOfBlockedQueuePairs = this->blockedQueuePairs.size();
+}
+
+void Context::progressBlockedQueuePairs() {
+
+  std::lock_guard<std::mutex> lock(this->blockedQueuePairMutex);
+  for (auto it = this->blockedQueuePairs.begin();
+       it != this->blockedQueuePairs.end();) {
+    if ((*it)->postPendingSends()) {
+      it = this->blockedQueuePairs.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  this->numberOfBlockedQueuePairs = this->blockedQueuePairs.size();
+}
+
+infinity::memory::AtomicArray *Context::getAtomicArray() {
+  std::call_once(this->atomicArrayCreated, [this]() {
+    this->atomicArray.reset(new infinity::memory::AtomicArray(
+        this, Configuration::ATOMIC_ARRAY_SLOTS));
+  });
+  return this->atomicArray.get();
+}
+
+int32_t Context::getNumaNode() { return this->numaNode; }
+
+const std::vector<uint32_t> &Context::getLocalCpus() {
+  return this->localCpus;
+}
+
+bool Context::supportsMemoryWindows() { return this->memoryWindowsSupported; }
+
 ibv_context *Context::getInfiniBandContext() { return this->ibvContext; }
 
 uint16_t Context::getLocalDeviceId() { return this->ibvLocalDeviceId; }
 
 uint16_t Context::getDevicePort() { return this->ibvDevicePort; }
 
+bool Context::isEthernet() {
+  return this->ibvPortAttributes.link_layer == IBV_LINK_LAYER_ETHERNET;
+}
+
+uint8_t Context::getMaxReadAtomic() {
+  return std::max(
+      std::min(this->ibvDeviceAttributes.max_qp_init_rd_atom, 255), 1);
+}
+
+uint8_t Context::getMaxDestReadAtomic() {
+  return std::max(std::min(this->ibvDeviceAttributes.max_qp_rd_atom, 255), 1);
+}
+
+uint8_t Context::getActiveMtu() { return this->ibvPortAttributes.active_mtu; }
+
+ibv_gid Context::getGid(uint8_t index) {
+  ibv_gid gid;
+  int32_t returnValue =
+      ibv_query_gid(this->ibvContext, this->ibvDevicePort, index, &gid);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][CORE][CONTEXT] Cannot query GID %u of port "
+                  "%u.\n",
+                  index, this->ibvDevicePort);
+  return gid;
+}
+
+bool Context::usesXrc() { return this->ibvXrcDomain != nullptr; }
+
+uint32_t Context::getSharedReceiveQueueNumber() {
+  return this->sharedReceiveQueueNumber;
+}
+
+ibv_xrcd *Context::getXrcDomain() { return this->ibvXrcDomain; }
+
 ibv_pd *Context::getProtectionDomain() { return this->ibvProtectionDomain; }
 
+int Context::getMemoryAccessFlags() {
+  int flags =
+      IBV_ACCESS_REMOTE_WRITE | IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_READ;
+  if (this->memoryWindowsSupported) {
+    flags |= IBV_ACCESS_MW_BIND;
+  }
+  return flags;
+}
+
 ibv_cq *Context::getSendCompletionQueue() {
   return this->ibvSendCompletionQueue;
 }
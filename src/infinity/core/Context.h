@@ -9,18 +9,29 @@
 #ifndef CORE_CONTEXT_H_
 #define CORE_CONTEXT_H_
 
+#include <atomic>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <stdlib.h>
 #include <stdint.h>
 #include <unordered_map>
+#include <vector>
 #include <infiniband/verbs.h>
 
+#include <infinity/core/Configuration.h>
+
 namespace infinity {
 namespace memory {
 class Region;
 class Buffer;
 class Atomic;
+class AtomicArray;
 class RegisteredMemory;
+class ParallelRegistration;
+class MemoryWindow;
 }
 }
 
@@ -28,6 +39,9 @@ namespace infinity {
 namespace queues {
 class QueuePair;
 class QueuePairFactory;
+class MeshBootstrap;
+class RdmaCmQueuePairFactory;
+class DatagramQueuePair;
 }
 }
 
@@ -40,6 +54,9 @@ class RequestToken;
 namespace infinity {
 namespace core {
 
+class ReceivePool;
+class ReceiveSlab;
+
 typedef struct {
   std::shared_ptr<infinity::memory::Buffer> buffer;
   uint32_t bytesWritten = 0;
@@ -48,21 +65,62 @@ typedef struct {
   std::shared_ptr<infinity::queues::QueuePair> queuePair;
 } receive_element_t;
 
+/**
+ * Lightweight result of a receive into a slab slot. data points into the
+ * slab and stays valid until the slot is reposted.
+ */
+typedef struct {
+  void *data = nullptr;
+  uint32_t bytesWritten = 0;
+  uint32_t immediateValue = 0;
+  bool immediateValueValid = false;
+  uint32_t queuePairNumber = 0;
+  uint32_t slot = 0;
+} receive_view_t;
+
+/**
+ * Estimated memory used by the queues of a context. Work queue entries
+ * are assumed to be rounded up to 64 byte multiples, completions to take
+ * 64 bytes.
+ */
+typedef struct {
+  uint32_t numberOfQueuePairs = 0;
+  uint64_t sendQueueEntries = 0;
+  uint64_t sendQueueBytes = 0;
+  uint32_t sendCompletionQueueEntries = 0;
+  uint32_t recvCompletionQueueEntries = 0;
+  uint64_t completionQueueBytes = 0;
+  uint32_t sharedRecvQueueEntries = 0;
+  uint64_t sharedRecvQueueBytes = 0;
+  uint64_t totalBytes = 0;
+} memory_usage_t;
+
 class Context {
 
   friend class infinity::memory::Region;
   friend class infinity::memory::Buffer;
   friend class infinity::memory::Atomic;
+  friend class infinity::memory::AtomicArray;
   friend class infinity::memory::RegisteredMemory;
+  friend class infinity::memory::ParallelRegistration;
+  friend class infinity::memory::MemoryWindow;
   friend class infinity::queues::QueuePair;
   friend class infinity::queues::QueuePairFactory;
+  friend class infinity::queues::MeshBootstrap;
+  friend class infinity::queues::RdmaCmQueuePairFactory;
+  friend class infinity::queues::DatagramQueuePair;
   friend class infinity::requests::RequestToken;
+  friend class infinity::core::ReceivePool;
+  friend class infinity::core::ReceiveSlab;
 
 public:
   /**
-   * Constructors
+   * Constructors. The configuration is read from the environment unless
+   * one is given.
    */
-  Context(uint16_t device = 0, uint16_t devicePort = 1);
+  Context(uint16_t device = 0, uint16_t devicePort = 1,
+          const Configuration &configuration =
+              Configuration::fromEnvironment());
 
   /**
    * Destructor
@@ -76,7 +134,9 @@ public:
 
 public:
   /**
-   * Check if receive operation completed
+   * Check if receive operation completed. Receives of queue pairs with a
+   * receive handler are dispatched and polling continues. Receives into
+   * the receive slab are kept for receive(receive_view_t &).
    */
   bool receive(receive_element_t &receiveElement);
   bool receive(std::shared_ptr<infinity::memory::Buffer> &buffer,
@@ -84,14 +144,116 @@ public:
                bool &immediateValueValid,
                std::shared_ptr<infinity::queues::QueuePair> &queuePair);
 
+  /**
+   * Check if a receive into the receive slab completed. Writes with
+   * immediate consume a slot as well, the slot is reposted automatically.
+   */
+  bool receive(receive_view_t &receiveView);
+
   /**
    * Post a new buffer for receiving messages
    */
   void postReceiveBuffer(std::shared_ptr<infinity::memory::Buffer> buffer);
 
+  /**
+   * Post several buffers with a single chained work request
+   */
+  void postReceiveBuffers(
+      const std::vector<std::shared_ptr<infinity::memory::Buffer> > &buffers);
+
+public:
+  typedef std::function<void(receive_element_t &receiveElement)>
+  ReceiveHandler;
+
+  /**
+   * Receives of a queue pair with a handler are passed to the handler by
+   * receive(receive_element_t &) instead of being returned. Queue pairs
+   * sharing a handler form a group. The handler owns the receive buffer
+   * and has to post it again. A null handler removes it, recycling the
+   * queue pair removes it as well.
+   */
+  void setReceiveHandler(
+      const std::shared_ptr<infinity::queues::QueuePair> &queuePair,
+      const std::shared_ptr<ReceiveHandler> &receiveHandler);
+
+  /**
+   * Number of queue pairs receives can be attributed to
+   */
+  uint32_t getNumberOfRegisteredQueuePairs();
+
+  /**
+   * Registered queue pair with this number, nullptr if there is none
+   */
+  std::shared_ptr<infinity::queues::QueuePair>
+  findQueuePair(uint32_t queuePairNumber);
+
 public:
   void getDeviceAttr(ibv_device_attr *device_attr);
 
+  /**
+   * Device and port attributes, queried once when the context is created
+   */
+  const ibv_device_attr &getDeviceAttributes();
+  const ibv_port_attr &getPortAttributes();
+
+  const Configuration &getConfiguration();
+
+  /**
+   * Memory used by queue pairs, completion queues and the shared receive
+   * queue
+   */
+  memory_usage_t getMemoryUsage();
+  void printMemoryUsage();
+
+  /**
+   * Result slots for atomic operations, shared by all queue pairs
+   */
+  infinity::memory::AtomicArray *getAtomicArray();
+
+  /**
+   * NUMA node of the device (-1 if unknown) and the CPUs local to it
+   */
+  int32_t getNumaNode();
+  const std::vector<uint32_t> &getLocalCpus();
+
+  /**
+   * True if memory windows are enabled in the configuration and the device
+   * can bind type 2 memory windows
+   */
+  bool supportsMemoryWindows();
+
+  /**
+   * GID at index of the port of the context
+   */
+  ibv_gid getGid(uint8_t index = 0);
+
+  /**
+   * True if queue pairs are connected with XRC. Remote processes address
+   * this context by the number of its shared receive queue.
+   */
+  bool usesXrc();
+  uint32_t getSharedReceiveQueueNumber();
+
+public:
+  typedef std::function<void(const ibv_async_event &event)>
+  AsyncEventHandler;
+
+  /**
+   * Asynchronous events read by the library, e.g. by a ReceivePool, which
+   * it does not handle itself are passed to the handler before they are
+   * acknowledged. Without a handler, they are reported as debug messages.
+   */
+  void setAsyncEventHandler(AsyncEventHandler asyncEventHandler);
+
+protected:
+  void handleAsyncEvent(const ibv_async_event &event);
+
+  // Receives into buffers of the pool are counted by it, also the ones
+  // dispatched to receive handlers
+  ReceivePool *receivePool = nullptr;
+
+  AsyncEventHandler asyncEventHandler;
+
 protected:
   /**
    * Returns ibVerbs context
@@ -108,11 +270,28 @@ protected:
    */
   uint16_t getDevicePort();
 
+  /**
+   * True if the port is Ethernet (RoCE) and needs global routing
+   */
+  bool isEthernet();
+
+  /**
+   * Read and atomic depth limits of the device and active MTU of the port
+   */
+  uint8_t getMaxReadAtomic();
+  uint8_t getMaxDestReadAtomic();
+  uint8_t getActiveMtu();
+
   /**
    * Returns ibVerbs protection domain
    */
   ibv_pd *getProtectionDomain();
 
+  /**
+   * Access flags used when registering buffers
+   */
+  int getMemoryAccessFlags();
+
 protected:
   /**
    * Check if send operation completed
@@ -134,6 +313,12 @@ protected:
    */
   ibv_srq *getSharedReceiveQueue();
 
+  /**
+   * Returns ibVerbs XRC domain, nullptr without XRC
+   */
+  ibv_xrcd *getXrcDomain();
+  void openXrcDomain();
+
 protected:
   /**
    * IB context and protection domain
@@ -148,6 +333,24 @@ protected:
   uint16_t ibvLocalDeviceId = 0;
   uint16_t ibvDevicePort = 1;
 
+  /**
+   * Cached attributes and sizing configuration
+   */
+  ibv_device_attr ibvDeviceAttributes;
+  ibv_port_attr ibvPortAttributes;
+  Configuration configuration;
+
+  /**
+   * NUMA placement of the device
+   */
+  int32_t numaNode = -1;
+  std::vector<uint32_t> localCpus;
+
+  /**
+   * Buffers are registered with bind rights if windows are supported
+   */
+  bool memoryWindowsSupported = false;
+
   /**
    * IB send and receive completion queues
    */
@@ -155,11 +358,114 @@ protected:
   ibv_cq *ibvReceiveCompletionQueue = nullptr;
   ibv_srq *ibvSharedReceiveQueue = nullptr;
 
+  /**
+   * With XRC, the shared receive queue belongs to the XRC domain and
+   * receives everything sent to this context
+   */
+  ibv_xrcd *ibvXrcDomain = nullptr;
+  int32_t xrcDomainFileDescriptor = -1;
+  uint32_t sharedReceiveQueueNumber = 0;
+
+protected:
+  /**
+   * Created on first use, queue pairs may issue their first atomics from
+   * several threads
+   */
+  std::unique_ptr<infinity::memory::AtomicArray> atomicArray;
+  std::once_flag atomicArrayCreated;
+
+protected:
+  /**
+   * Receive slab whose slots are identified by tagged work request ids
+   */
+  ReceiveSlab *receiveSlab = nullptr;
+
+  /**
+   * Slab completions polled by the buffer receive path
+   */
+  std::deque<ibv_wc> deferredSlabCompletions;
+
+  static bool isSlabWorkRequest(uint64_t workRequestId) {
+    return (workRequestId & 1) != 0;
+  }
+
+protected:
+  /**
+   * Book keeping of the send queues attached to the send completion queue.
+   * The completion queue is grown if the send queues could overflow it.
+   * Queue pairs may be created by background threads, e.g. by a
+   * QueuePairPool.
+   */
+  void attachQueuePair(uint32_t sendQueueDepth, uint32_t numberOfSGEElements,
+                       uint32_t maxInlineData);
+  void detachQueuePair(uint32_t sendQueueDepth, uint32_t numberOfSGEElements,
+                       uint32_t maxInlineData);
+
+  uint32_t numberOfQueuePairs = 0;
+  uint64_t sendQueueEntries = 0;
+  uint64_t sendQueueBytes = 0;
+  bool sendCompletionQueueWarningPrinted = false;
+  std::mutex queuePairMutex;
+
 protected:
+  /**
+   * Registry of connected queue pairs. Entries live in a flat table, are
+   * removed when the queue pair is destroyed or recycled, and their slots
+   * are reused. The index maps the number receives report and the queue
+   * pair's own number, which differ with XRC, to the slot. It is indexed
+   * directly by the 24 bit queue pair number, pages of it are allocated on
+   * first use. Queue pairs are registered from other threads, lookups
+   * share the lock and changes take it exclusively.
+   */
+  static const uint32_t NOT_REGISTERED = UINT32_MAX;
+  static const uint32_t QUEUE_PAIR_INDEX_PAGE_BITS = 12;
+  static const uint32_t QUEUE_PAIR_INDEX_PAGE_SIZE =
+      1 << QUEUE_PAIR_INDEX_PAGE_BITS;
+
+  typedef struct {
+    std::weak_ptr<infinity::queues::QueuePair> queuePair;
+    uint32_t queuePairNumber;
+    uint32_t targetQueuePairNumber;
+    std::shared_ptr<ReceiveHandler> receiveHandler;
+  } registered_queue_pair_t;
+
   void
   registerQueuePair(std::shared_ptr<infinity::queues::QueuePair> queuePair);
-  std::unordered_map<uint32_t, std::weak_ptr<infinity::queues::QueuePair> >
-  queuePairMap;
+  void unregisterQueuePair(infinity::queues::QueuePair *queuePair);
+  void lookupQueuePair(
+      uint32_t queuePairNumber,
+      std::shared_ptr<infinity::queues::QueuePair> &queuePair,
+      std::shared_ptr<ReceiveHandler> *receiveHandler = nullptr);
+  uint32_t findQueuePairSlot(uint32_t queuePairNumber);
+  void setQueuePairSlot(uint32_t queuePairNumber, uint32_t slot);
+  void removeFromQueuePairIndex(uint32_t slot);
+
+  std::vector<registered_queue_pair_t> queuePairTable;
+  std::vector<uint32_t> freeQueuePairSlots;
+  std::unique_ptr<uint32_t[]>
+      queuePairIndex[(1 << 24) / QUEUE_PAIR_INDEX_PAGE_SIZE];
+  std::shared_timed_mutex queuePairTableMutex;
+
+protected:
+  /**
+   * Credit based flow control. Receives of flow controlled queue pairs are
+   * remembered in order, every buffer posted afterwards grants a credit to
+   * the oldest of them. Queue pairs with operations waiting for credits are
+   * progressed whenever the send completion queue is polled.
+   */
+  void consumeReceiveCredit(
+      const std::shared_ptr<infinity::queues::QueuePair> &queuePair);
+  void grantReceiveCredits(uint32_t numberOfBuffers);
+  void blockQueuePair(infinity::queues::QueuePair *queuePair);
+  void unblockQueuePair(infinity::queues::QueuePair *queuePair);
+  void progressBlockedQueuePairs();
+
+  std::atomic<bool> flowControlInUse{false};
+  std::deque<std::weak_ptr<infinity::queues::QueuePair> > receiveCreditQueue;
+  std::mutex receiveCreditMutex;
+  std::vector<infinity::queues::QueuePair *> blockedQueuePairs;
+  std::atomic<uint32_t> numberOfBlockedQueuePairs{0};
+  std::mutex blockedQueuePairMutex;
 };
 
 } /* namespace core */
@@ -0,0 +1,121 @@
+/**
+ * Core - Multi-Rail Context
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "MultiRailContext.h"
+
+#include <infinity/utils/Debug.h>
+#include <infinity/utils/Numa.h>
+
+namespace infinity {
+namespace core {
+
+MultiRailContext::MultiRailContext(const std::vector<rail_t> &rails,
+                                   const Configuration &configuration)
+    : rails(rails) {
+
+  INFINITY_ASSERT(!rails.empty() && rails.size() <= MAX_RAILS,
+                  "[INFINITY][CORE][MULTIRAIL] Between 1 and %u rails are "
+                  "supported, %lu were requested.\n",
+                  MAX_RAILS, rails.size());
+
+  for (const rail_t &rail : rails) {
+    this->contexts.emplace_back(std::make_shared<Context>(
+        rail.device, rail.devicePort, configuration));
+    INFINITY_DEBUG("[INFINITY][CORE][MULTIRAIL] Opened rail %lu on device %u "
+                   "port %u, NUMA node %d.\n",
+                   this->contexts.size() - 1, rail.device, rail.devicePort,
+                   this->contexts.back()->getNumaNode());
+  }
+}
+
+std::vector<rail_t> MultiRailContext::findActiveRails() {
+
+  std::vector<rail_t> rails;
+  int32_t numberOfInstalledDevices = 0;
+  ibv_device **ibvDeviceList = ibv_get_device_list(&numberOfInstalledDevices);
+  if (ibvDeviceList == nullptr) {
+    return rails;
+  }
+
+  for (int32_t device = 0; device < numberOfInstalledDevices; ++device) {
+    ibv_context *ibvContext = ibv_open_device(ibvDeviceList[device]);
+    if (ibvContext == nullptr) {
+      continue;
+    }
+    ibv_device_attr deviceAttributes;
+    if (ibv_query_device(ibvContext, &deviceAttributes) == 0) {
+      for (uint16_t port = 1; port <= deviceAttributes.phys_port_cnt; ++port) {
+        ibv_port_attr portAttributes;
+        if (ibv_query_port(ibvContext, port, &portAttributes) == 0 &&
+            portAttributes.state == IBV_PORT_ACTIVE) {
+          rails.push_back({(uint16_t)device, port});
+        }
+      }
+    }
+    ibv_close_device(ibvContext);
+  }
+
+  ibv_free_device_list(ibvDeviceList);
+  return rails;
+}
+
+uint32_t MultiRailContext::getNumberOfRails() { return this->rails.size(); }
+
+const rail_t &MultiRailContext::getRail(uint32_t rail) {
+  return this->rails.at(rail);
+}
+
+std::shared_ptr<Context> MultiRailContext::getContext(uint32_t rail) {
+  return this->contexts.at(rail);
+}
+
+int32_t MultiRailContext::getNumaNode(uint32_t rail) {
+  return this->contexts.at(rail)->getNumaNode();
+}
+
+std::vector<uint32_t> MultiRailContext::getRailsByLocality(int32_t numaNode) {
+
+  if (numaNode < 0) {
+    numaNode = infinity::utils::Numa::getNumaNodeOfCurrentThread();
+  }
+
+  std::vector<uint32_t> order;
+  for (uint32_t rail = 0; rail < this->contexts.size(); ++rail) {
+    if (this->contexts[rail]->getNumaNode() == numaNode) {
+      order.push_back(rail);
+    }
+  }
+  for (uint32_t rail = 0; rail < this->contexts.size(); ++rail) {
+    if (this->contexts[rail]->getNumaNode() != numaNode) {
+      order.push_back(rail);
+    }
+  }
+  return order;
+}
+
+bool MultiRailContext::bindCurrentThreadToRail(uint32_t rail) {
+  return infinity::utils::Numa::bindCurrentThreadToCpus(
+      this->contexts.at(rail)->getLocalCpus());
+}
+
+bool MultiRailContext::receive(receive_element_t &receiveElement,
+                               uint32_t &rail) {
+
+  for (uint32_t i = 0; i < this->contexts.size(); ++i) {
+    uint32_t candidate = this->nextReceiveRail;
+    this->nextReceiveRail = (this->nextReceiveRail + 1) % this->contexts.size();
+    if (this->contexts[candidate]->receive(receiveElement)) {
+      rail = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+} /* namespace core */
+} /* namespace infinity */
@@ -0,0 +1,156 @@
+/**
+ * Core - Receive Pool
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "ReceivePool.h"
+
+#include <poll.h>
+#include <string.h>
+#include <algorithm>
+
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace core {
+
+ReceivePool::ReceivePool(std::shared_ptr<Context> context,
+                         uint32_t numberOfSlots, uint64_t slotSizeInBytes,
+                         uint32_t batchSize, uint32_t lowWatermark)
+    : context(context) {
+
+  INFINITY_ASSERT(numberOfSlots > 0 && slotSizeInBytes > 0,
+                  "[INFINITY][CORE][POOL] Pool needs at least one slot.\n");
+
+  this->batchSize = std::max(1u, std::min(batchSize, numberOfSlots));
+  this->lowWatermark =
+      (lowWatermark != 0) ? std::min(lowWatermark, numberOfSlots)
+                          : std::max(1u, numberOfSlots / 4);
+
+  INFINITY_ASSERT(context->receivePool == nullptr,
+                  "[INFINITY][CORE][POOL] Context already has a receive "
+                  "pool.\n");
+
+  // One registration for all slots
+  this->memory.reset(new infinity::memory::RegisteredMemory(
+      context.get(), numberOfSlots * slotSizeInBytes));
+  this->slots.reserve(numberOfSlots);
+  for (uint32_t i = 0; i < numberOfSlots; ++i) {
+    this->slots.emplace_back(infinity::memory::Buffer::createBuffer(
+        context, this->memory.get(), i * slotSizeInBytes, slotSizeInBytes));
+  }
+  this->pendingSlots.reserve(numberOfSlots);
+
+  this->context->postReceiveBuffers(this->slots);
+  this->postedSlots = numberOfSlots;
+  this->context->receivePool = this;
+
+  armLimit();
+}
+
+ReceivePool::~ReceivePool() { this->context->receivePool = nullptr; }
+
+bool ReceivePool::receive(receive_element_t &receiveElement) {
+  return this->context->receive(receiveElement);
+}
+
+void ReceivePool::release(std::shared_ptr<infinity::memory::Buffer> buffer) {
+
+  this->pendingSlots.emplace_back(std::move(buffer));
+  if (this->pendingSlots.size() >= this->batchSize ||
+      this->postedSlots < this->lowWatermark) {
+    flush();
+  }
+}
+
+void ReceivePool::flush() {
+
+  if (this->pendingSlots.empty()) {
+    return;
+  }
+
+  this->context->postReceiveBuffers(this->pendingSlots);
+  this->postedSlots += this->pendingSlots.size();
+  this->pendingSlots.clear();
+
+  INFINITY_DEBUG("[INFINITY][CORE][POOL] Refilled shared receive queue, %u "
+                 "slots posted.\n",
+                 this->postedSlots);
+}
+
+bool ReceivePool::pollEvents() {
+
+  bool limitReached = false;
+  pollfd descriptor;
+  descriptor.fd = this->context->getInfiniBandContext()->async_fd;
+  descriptor.events = POLLIN;
+  descriptor.revents = 0;
+
+  while (poll(&descriptor, 1, 0) > 0) {
+    ibv_async_event event;
+    if (ibv_get_async_event(this->context->getInfiniBandContext(), &event) !=
+        0) {
+      break;
+    }
+    // Reading the event consumes it, all others go to the context
+    if (event.event_type == IBV_EVENT_SRQ_LIMIT_REACHED &&
+        event.element.srq == this->context->getSharedReceiveQueue()) {
+      limitReached = true;
+    } else {
+      this->context->handleAsyncEvent(event);
+    }
+    ibv_ack_async_event(&event);
+  }
+
+  if (limitReached) {
+    flush();
+    armLimit();
+  }
+
+  return limitReached;
+}
+
+uint32_t ReceivePool::getNumberOfSlots() { return this->slots.size(); }
+
+uint32_t ReceivePool::getNumberOfPostedSlots() { return this->postedSlots; }
+
+uint32_t ReceivePool::getNumberOfPendingSlots() {
+  return this->pendingSlots.size();
+}
+
+void ReceivePool::consumeSlot(infinity::memory::Buffer *buffer) {
+
+  // Slots are carved out of the pool's memory, other buffers may share the
+  // receive queue
+  uint64_t start = reinterpret_cast<uint64_t>(this->memory->getData());
+  if (buffer->getAddress() < start ||
+      buffer->getAddress() >= start + this->memory->getSizeInBytes()) {
+    return;
+  }
+
+  --this->postedSlots;
+  if (this->postedSlots < this->lowWatermark) {
+    flush();
+  }
+}
+
+void ReceivePool::armLimit() {
+
+  // The limit event is one-shot and has to be re-armed after every trigger
+  ibv_srq_attr attributes;
+  memset(&attributes, 0, sizeof(ibv_srq_attr));
+  attributes.srq_limit = this->lowWatermark;
+  this->limitSupported =
+      (ibv_modify_srq(this->context->getSharedReceiveQueue(), &attributes,
+                      IBV_SRQ_LIMIT) == 0);
+  if (!this->limitSupported) {
+    INFINITY_DEBUG("[INFINITY][CORE][POOL] Shared receive queue limit not "
+                   "supported, relying on watermark only.\n");
+  }
+}
+
+} /* namespace core */
+} /* namespace infinity */
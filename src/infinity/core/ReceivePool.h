@@ -0,0 +1,101 @@
+/**
+ * Core - Receive Pool
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef CORE_RECEIVEPOOL_H_
+#define CORE_RECEIVEPOOL_H_
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/memory/RegisteredMemory.h>
+
+namespace infinity {
+namespace core {
+
+/**
+ * Owns a fixed number of equally sized receive slots carved out of a single
+ * registered memory area and keeps the shared receive queue of a context
+ * filled. Consumed slots are handed back with release() and reposted in
+ * batches with one chained post. Whenever fewer than lowWatermark slots are
+ * posted, pending slots are reposted immediately. If the device supports it,
+ * the shared receive queue limit event triggers the same refill.
+ *
+ * Posted slots cannot be withdrawn, so the pool must outlive all queue pairs
+ * which may still deliver messages into it. A context has at most one pool.
+ */
+class ReceivePool {
+
+public:
+  ReceivePool(std::shared_ptr<Context> context, uint32_t numberOfSlots,
+              uint64_t slotSizeInBytes, uint32_t batchSize = 32,
+              uint32_t lowWatermark = 0);
+  ~ReceivePool();
+
+  ReceivePool(const ReceivePool &) = delete;
+  ReceivePool(const ReceivePool &&) = delete;
+  ReceivePool &operator=(const ReceivePool &) = delete;
+  ReceivePool &operator=(ReceivePool &&) = delete;
+
+public:
+  /**
+   * Check if receive operation completed, release the buffer afterwards
+   */
+  bool receive(receive_element_t &receiveElement);
+
+  /**
+   * Return a consumed slot to the pool
+   */
+  void release(std::shared_ptr<infinity::memory::Buffer> buffer);
+
+  /**
+   * Repost all released slots
+   */
+  void flush();
+
+  /**
+   * Handle pending asynchronous events, returns true if the shared receive
+   * queue limit was reached. Other events are passed to the asynchronous
+   * event handler of the context.
+   */
+  bool pollEvents();
+
+public:
+  uint32_t getNumberOfSlots();
+  uint32_t getNumberOfPostedSlots();
+  uint32_t getNumberOfPendingSlots();
+
+protected:
+  friend class Context;
+
+  /**
+   * Called by the context for every receive into a buffer, counts the
+   * ones belonging to the pool
+   */
+  void consumeSlot(infinity::memory::Buffer *buffer);
+  void armLimit();
+
+protected:
+  std::shared_ptr<Context> context;
+
+  std::unique_ptr<infinity::memory::RegisteredMemory> memory;
+  std::vector<std::shared_ptr<infinity::memory::Buffer> > slots;
+  std::vector<std::shared_ptr<infinity::memory::Buffer> > pendingSlots;
+
+  uint32_t batchSize = 0;
+  uint32_t lowWatermark = 0;
+  uint32_t postedSlots = 0;
+  bool limitSupported = false;
+};
+
+} /* namespace core */
+} /* namespace infinity */
+
+#endif /* CORE_RECEIVEPOOL_H_ */
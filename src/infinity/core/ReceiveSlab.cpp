@@ -0,0 +1,99 @@
+/**
+ * Core - Receive Slab
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "ReceiveSlab.h"
+
+#include <string.h>
+
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace core {
+
+ReceiveSlab::ReceiveSlab(std::shared_ptr<Context> context,
+                         uint32_t numberOfSlots, uint32_t slotSizeInBytes,
+                         bool postAllSlots)
+    : context(context), numberOfSlots(numberOfSlots),
+      slotSizeInBytes(slotSizeInBytes) {
+
+  INFINITY_ASSERT(this->context->receiveSlab == nullptr,
+                  "[INFINITY][CORE][SLAB] Context already has a receive "
+                  "slab.\n");
+  INFINITY_ASSERT(numberOfSlots > 0 && slotSizeInBytes > 0,
+                  "[INFINITY][CORE][SLAB] Slab needs at least one slot.\n");
+
+  this->memory.reset(new infinity::memory::RegisteredMemory(
+      context.get(), static_cast<uint64_t>(numberOfSlots) * slotSizeInBytes));
+  this->data = reinterpret_cast<char *>(this->memory->getData());
+  this->lkey = this->memory->getRegion()->lkey;
+
+  this->context->receiveSlab = this;
+
+  if (postAllSlots) {
+    std::vector<uint32_t> slots(numberOfSlots);
+    for (uint32_t i = 0; i < numberOfSlots; ++i) {
+      slots[i] = i;
+    }
+    postSlots(&slots[0], numberOfSlots);
+  }
+}
+
+ReceiveSlab::~ReceiveSlab() { this->context->receiveSlab = nullptr; }
+
+void ReceiveSlab::postSlot(uint32_t slot) { postSlots(&slot, 1); }
+
+void ReceiveSlab::postSlots(const uint32_t *slots, uint32_t count) {
+
+  if (count == 0) {
+    return;
+  }
+
+  // Work requests are reused between calls to keep reposting allocation free
+  if (this->workRequests.size() < count) {
+    this->scatterGatherElements.resize(count);
+    this->workRequests.resize(count);
+  }
+
+  for (uint32_t i = 0; i < count; ++i) {
+
+    INFINITY_ASSERT(slots[i] < this->numberOfSlots,
+                    "[INFINITY][CORE][SLAB] Slot %u does not exist.\n",
+                    slots[i]);
+
+    ibv_sge &isge = this->scatterGatherElements[i];
+    isge.addr = reinterpret_cast<uint64_t>(getSlotData(slots[i]));
+    isge.length = this->slotSizeInBytes;
+    isge.lkey = this->lkey;
+
+    ibv_recv_wr &wr = this->workRequests[i];
+    wr.wr_id = getWorkRequestOfSlot(slots[i]);
+    wr.next = (i + 1 < count) ? &this->workRequests[i + 1] : nullptr;
+    wr.sg_list = &isge;
+    wr.num_sge = 1;
+  }
+
+  ibv_recv_wr *badwr;
+  int returnValue = ibv_post_srq_recv(this->context->getSharedReceiveQueue(),
+                                      &this->workRequests[0], &badwr);
+  INFINITY_ASSERT(
+      returnValue == 0,
+      "[INFINITY][CORE][SLAB] Cannot post slots to receive queue.\n");
+
+  this->context->grantReceiveCredits(count);
+}
+
+void *ReceiveSlab::getSlotData(uint32_t slot) {
+  return this->data + static_cast<uint64_t>(slot) * this->slotSizeInBytes;
+}
+
+uint32_t ReceiveSlab::getSlotSizeInBytes() { return this->slotSizeInBytes; }
+
+uint32_t ReceiveSlab::getNumberOfSlots() { return this->numberOfSlots; }
+
+} /* namespace core */
+} /* namespace infinity */
@@ -0,0 +1,82 @@
+/**
+ * Core - Receive Slab
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef CORE_RECEIVESLAB_H_
+#define CORE_RECEIVESLAB_H_
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+#include <infiniband/verbs.h>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/RegisteredMemory.h>
+
+namespace infinity {
+namespace core {
+
+/**
+ * Fixed-size receive slots laid out back to back in a single registered
+ * memory area. The work request id of a posted slot encodes its index, so
+ * receiving needs neither a Buffer object nor a memory region per slot. Use
+ * Context::receive(receive_view_t &) to receive into the slab. A context
+ * supports one slab at a time, which must outlive all queue pairs that may
+ * still deliver into it.
+ */
+class ReceiveSlab {
+
+public:
+  static const uint32_t INVALID_SLOT = UINT32_MAX;
+
+public:
+  ReceiveSlab(std::shared_ptr<Context> context, uint32_t numberOfSlots,
+              uint32_t slotSizeInBytes, bool postAllSlots = true);
+  ~ReceiveSlab();
+
+  ReceiveSlab(const ReceiveSlab &) = delete;
+  ReceiveSlab(const ReceiveSlab &&) = delete;
+  ReceiveSlab &operator=(const ReceiveSlab &) = delete;
+  ReceiveSlab &operator=(ReceiveSlab &&) = delete;
+
+public:
+  /**
+   * Post slots to the shared receive queue, several slots are posted with a
+   * single chained work request
+   */
+  void postSlot(uint32_t slot);
+  void postSlots(const uint32_t *slots, uint32_t numberOfSlots);
+
+public:
+  void *getSlotData(uint32_t slot);
+  uint32_t getSlotSizeInBytes();
+  uint32_t getNumberOfSlots();
+
+  static uint64_t getWorkRequestOfSlot(uint32_t slot) {
+    return (static_cast<uint64_t>(slot) << 1) | 1;
+  }
+  static uint32_t getSlotOfWorkRequest(uint64_t workRequestId) {
+    return static_cast<uint32_t>(workRequestId >> 1);
+  }
+
+protected:
+  std::shared_ptr<Context> context;
+  std::unique_ptr<infinity::memory::RegisteredMemory> memory;
+
+  char *data = nullptr;
+  uint32_t lkey = 0;
+  uint32_t numberOfSlots = 0;
+  uint32_t slotSizeInBytes = 0;
+
+  std::vector<ibv_sge> scatterGatherElements;
+  std::vector<ibv_recv_wr> workRequests;
+};
+
+} /* namespace core */
+} /* namespace infinity */
+
+#endif /* CORE_RECEIVESLAB_H_ */
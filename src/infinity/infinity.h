@@ -11,16 +11,38 @@
 
 #include <infinity/core/Context.h>
 #include <infinity/core/Configuration.h>
+#include <infinity/core/ReceivePool.h>
+#include <infinity/core/ReceiveSlab.h>
+#include <infinity/core/MultiRailContext.h>
 #include <infinity/memory/Atomic.h>
+#include <infinity/memory/AtomicArray.h>
 #include <infinity/memory/Buffer.h>
+#include <infinity/memory/FileMapping.h>
+#include <infinity/memory/ParallelRegistration.h>
+#include <infinity/memory/MemoryWindow.h>
+#include <infinity/memory/MultiRailBuffer.h>
 #include <infinity/memory/Region.h>
 #include <infinity/memory/RegionToken.h>
+#include <infinity/memory/RegionTokenTable.h>
+#include <infinity/memory/RegionDirectory.h>
 #include <infinity/memory/RegionType.h>
 #include <infinity/memory/RegisteredMemory.h>
 #include <infinity/queues/QueuePair.h>
 #include <infinity/queues/QueuePairFactory.h>
+#include <infinity/queues/QueuePairPool.h>
+#include <infinity/queues/ConnectionEngine.h>
+#include <infinity/queues/MeshBootstrap.h>
+#include <infinity/queues/RdmaCmQueuePairFactory.h>
+#include <infinity/queues/DatagramQueuePair.h>
+#include <infinity/queues/MultiRailQueuePair.h>
+#include <infinity/queues/MultiRailQueuePairFactory.h>
+#include <infinity/queues/AggregatingSender.h>
+#include <infinity/queues/Messenger.h>
 #include <infinity/requests/RequestToken.h>
+#include <infinity/requests/MultiRailRequestToken.h>
 #include <infinity/utils/Address.h>
 #include <infinity/utils/Debug.h>
+#include <infinity/utils/Numa.h>
+#include <infinity/utils/RendezvousStore.h>
 
 #endif /* INFINITY_H_ */
@@ -0,0 +1,104 @@
+/*
+ * Memory - Atomic Array
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "AtomicArray.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace memory {
+
+AtomicArray::AtomicArray(infinity::core::Context *context,
+                         uint32_t numberOfSlots)
+    : context(context), numberOfSlots(numberOfSlots) {
+
+  INFINITY_ASSERT(numberOfSlots > 1,
+                  "[INFINITY][MEMORY][ATOMICARRAY] Array needs at least one "
+                  "slot besides the scratch slot.\n");
+
+  uint64_t sizeInBytes =
+      static_cast<uint64_t>(numberOfSlots) * SLOT_SIZE_IN_BYTES;
+  int res = posix_memalign(&(this->data), SLOT_SIZE_IN_BYTES, sizeInBytes);
+  INFINITY_ASSERT(
+      res == 0,
+      "[INFINITY][MEMORY][ATOMICARRAY] Cannot allocate and align slots.\n");
+  memset(this->data, 0, sizeInBytes);
+
+  this->ibvMemoryRegion = ibv_reg_mr(
+      this->context->getProtectionDomain(), this->data, sizeInBytes,
+      IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_ATOMIC |
+          IBV_ACCESS_REMOTE_READ | IBV_ACCESS_REMOTE_WRITE);
+  INFINITY_ASSERT(this->ibvMemoryRegion != nullptr,
+                  "[INFINITY][MEMORY][ATOMICARRAY] Registration failed.\n");
+
+  // Hand out low slots first
+  this->freeSlots.reserve(numberOfSlots);
+  for (uint32_t slot = numberOfSlots - 1; slot > SCRATCH_SLOT; --slot) {
+    this->freeSlots.push_back(slot);
+  }
+}
+
+AtomicArray::~AtomicArray() {
+  ibv_dereg_mr(this->ibvMemoryRegion);
+  free(this->data);
+}
+
+uint32_t AtomicArray::acquireSlot() {
+
+  uint32_t slot = tryAcquireSlot();
+  while (slot == INVALID_SLOT) {
+    // Slots are released when their operation completes
+    this->context->pollSendCompletionQueue();
+    slot = tryAcquireSlot();
+  }
+  return slot;
+}
+
+uint32_t AtomicArray::tryAcquireSlot() {
+
+  std::lock_guard<std::mutex> lock(this->freeSlotsMutex);
+  if (this->freeSlots.empty()) {
+    return INVALID_SLOT;
+  }
+  uint32_t slot = this->freeSlots.back();
+  this->freeSlots.pop_back();
+  return slot;
+}
+
+void AtomicArray::releaseSlot(uint32_t slot) {
+
+  INFINITY_ASSERT(slot != SCRATCH_SLOT && slot < this->numberOfSlots,
+                  "[INFINITY][MEMORY][ATOMICARRAY] Cannot release slot %u.\n",
+                  slot);
+  std::lock_guard<std::mutex> lock(this->freeSlotsMutex);
+  this->freeSlots.push_back(slot);
+}
+
+uint64_t AtomicArray::getValue(uint32_t slot) {
+  return *reinterpret_cast<volatile uint64_t *>(getAddress(slot));
+}
+
+uint64_t AtomicArray::getAddress(uint32_t slot) {
+  return reinterpret_cast<uint64_t>(this->data) +
+         static_cast<uint64_t>(slot) * SLOT_SIZE_IN_BYTES;
+}
+
+uint32_t AtomicArray::getLocalKey() { return this->ibvMemoryRegion->lkey; }
+
+uint32_t AtomicArray::getNumberOfSlots() { return this->numberOfSlots; }
+
+uint32_t AtomicArray::getNumberOfFreeSlots() {
+  std::lock_guard<std::mutex> lock(this->freeSlotsMutex);
+  return this->freeSlots.size();
+}
+
+} /* namespace memory */
+} /* namespace infinity */
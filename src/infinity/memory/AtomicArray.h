@@ -0,0 +1,78 @@
+/*
+ * Memory - Atomic Array
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef MEMORY_ATOMICARRAY_H_
+#define MEMORY_ATOMICARRAY_H_
+
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+#include <infiniband/verbs.h>
+
+#include <infinity/core/Context.h>
+
+namespace infinity {
+namespace memory {
+
+/**
+ * A single registered slab of result slots for remote atomic operations.
+ * Every slot lives on its own cache line, so threads waiting for different
+ * results do not share lines with each other or with the device. Slot 0 is
+ * a scratch slot for results nobody reads and is never handed out.
+ */
+class AtomicArray {
+
+public:
+  static const uint32_t SLOT_SIZE_IN_BYTES = 64;
+  static const uint32_t INVALID_SLOT = UINT32_MAX;
+  static const uint32_t SCRATCH_SLOT = 0;
+
+public:
+  AtomicArray(infinity::core::Context *context, uint32_t numberOfSlots);
+  ~AtomicArray();
+
+  AtomicArray(const AtomicArray &) = delete;
+  AtomicArray(const AtomicArray &&) = delete;
+  AtomicArray &operator=(const AtomicArray &) = delete;
+  AtomicArray &operator=(AtomicArray &&) = delete;
+
+public:
+  /**
+   * Returns a free slot, polls for completions while all slots are in use
+   */
+  uint32_t acquireSlot();
+
+  /**
+   * Returns a free slot or INVALID_SLOT if all slots are in use
+   */
+  uint32_t tryAcquireSlot();
+
+  void releaseSlot(uint32_t slot);
+
+public:
+  uint64_t getValue(uint32_t slot);
+  uint64_t getAddress(uint32_t slot);
+  uint32_t getLocalKey();
+  uint32_t getNumberOfSlots();
+  uint32_t getNumberOfFreeSlots();
+
+protected:
+  infinity::core::Context *context = nullptr;
+
+  void *data = nullptr;
+  uint32_t numberOfSlots = 0;
+  ibv_mr *ibvMemoryRegion = nullptr;
+
+  std::mutex freeSlotsMutex;
+  std::vector<uint32_t> freeSlots;
+};
+
+} /* namespace memory */
+} /* namespace infinity */
+
+#endif /* MEMORY_ATOMICARRAY_H_ */
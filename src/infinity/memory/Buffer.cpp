@@ -10,8 +10,11 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 
 #include <infinity/core/Configuration.h>
+#include <infinity/memory/FileMapping.h>
+#include <infinity/memory/ParallelRegistration.h>
 #include <infinity/utils/Debug.h>
 
 namespace infinity {
@@ -37,6 +40,30 @@ Buffer::createBuffer(std::shared_ptr<infinity::core::Context> context,
   return std::make_shared<Buffer>(context, memory, sizeInBytes, Token());
 }
 
+std::shared_ptr<Buffer>
+Buffer::createChunkedBuffer(std::shared_ptr<infinity::core::Context> context,
+                            uint64_t sizeInBytes, uint64_t chunkSizeInBytes,
+                            uint32_t numberOfThreads) {
+  return std::make_shared<Buffer>(context, sizeInBytes, chunkSizeInBytes,
+                                  numberOfThreads, Token());
+}
+
+std::shared_ptr<Buffer>
+Buffer::createGrowableBuffer(std::shared_ptr<infinity::core::Context> context,
+                             uint64_t sizeInBytes, uint64_t maximumSizeInBytes,
+                             uint64_t extentSizeInBytes) {
+  return std::make_shared<Buffer>(context, sizeInBytes, maximumSizeInBytes,
+                                  extentSizeInBytes, GrowableToken());
+}
+
+std::shared_ptr<Buffer>
+Buffer::createBufferFromFile(std::shared_ptr<infinity::core::Context> context,
+                             const char *path, bool writable, bool populate,
+                             bool prefault) {
+  return std::make_shared<Buffer>(context, path, writable, populate, prefault,
+                                  Token());
+}
+
 Buffer::Buffer(std::shared_ptr<infinity::core::Context> context,
                uint64_t sizeInBytes, bool zero_memory, Token) {
 
@@ -56,8 +83,7 @@ Buffer::Buffer(std::shared_ptr<infinity::core::Context> context,
 
   this->ibvMemoryRegion = ibv_reg_mr(
       this->context->getProtectionDomain(), this->data, this->sizeInBytes,
-      IBV_ACCESS_REMOTE_WRITE | IBV_ACCESS_LOCAL_WRITE |
-          IBV_ACCESS_REMOTE_READ);
+      this->context->getMemoryAccessFlags());
   INFINITY_ASSERT(this->ibvMemoryRegion != nullptr,
                   "[INFINITY][MEMORY][BUFFER] Registration failed.\n");
 
@@ -73,8 +99,15 @@ Buffer::Buffer(std::shared_ptr<infinity::core::Context> context,
   this->sizeInBytes = sizeInBytes;
   this->memoryRegionType = RegionType::BUFFER;
 
+  INFINITY_ASSERT(memory->getChunkSizeInBytes() == 0 || sizeInBytes == 0 ||
+                      offset / memory->getChunkSizeInBytes() ==
+                          (offset + sizeInBytes - 1) /
+                              memory->getChunkSizeInBytes(),
+                  "[INFINITY][MEMORY][BUFFER] Buffer must not cross a chunk "
+                  "boundary of the registered memory.\n");
+
   this->data = reinterpret_cast<char *>(memory->getData()) + offset;
-  this->ibvMemoryRegion = memory->getRegion();
+  this->ibvMemoryRegion = memory->getRegion(offset);
 
   this->memoryAllocated = false;
   this->memoryRegistered = false;
@@ -90,29 +123,135 @@ Buffer::Buffer(std::shared_ptr<infinity::core::Context> context, void *memory,
   this->data = memory;
   this->ibvMemoryRegion = ibv_reg_mr(
       this->context->getProtectionDomain(), this->data, this->sizeInBytes,
-      IBV_ACCESS_REMOTE_WRITE | IBV_ACCESS_LOCAL_WRITE |
-          IBV_ACCESS_REMOTE_READ);
+      this->context->getMemoryAccessFlags());
+  INFINITY_ASSERT(this->ibvMemoryRegion != nullptr,
+                  "[INFINITY][MEMORY][BUFFER] Registration failed.\n");
+
+  this->memoryAllocated = false;
+  this->memoryRegistered = true;
+}
+
+Buffer::Buffer(std::shared_ptr<infinity::core::Context> context,
+               uint64_t sizeInBytes, uint64_t chunkSizeInBytes,
+               uint32_t numberOfThreads, Token) {
+
+  this->context = context;
+  this->sizeInBytes = sizeInBytes;
+  this->memoryRegionType = RegionType::BUFFER;
+
+  int res = posix_memalign(
+      &(this->data), infinity::core::Configuration::PAGE_SIZE, sizeInBytes);
+  INFINITY_ASSERT(
+      res == 0,
+      "[INFINITY][MEMORY][BUFFER] Cannot allocate and align buffer.\n");
+
+  this->chunkMemoryRegions = ParallelRegistration::registerChunks(
+      this->context.get(), this->data, this->sizeInBytes, chunkSizeInBytes,
+      numberOfThreads, true,
+      this->context->getMemoryAccessFlags());
+  this->chunkSizeInBytes = chunkSizeInBytes;
+  this->ibvMemoryRegion = this->chunkMemoryRegions[0];
+
+  this->memoryAllocated = true;
+  this->memoryRegistered = true;
+}
+
+Buffer::Buffer(std::shared_ptr<infinity::core::Context> context,
+               uint64_t sizeInBytes, uint64_t maximumSizeInBytes,
+               uint64_t extentSizeInBytes, GrowableToken) {
+
+  INFINITY_ASSERT(sizeInBytes > 0 && sizeInBytes <= maximumSizeInBytes,
+                  "[INFINITY][MEMORY][BUFFER] Initial size must be between 1 "
+                  "and the maximum size.\n");
+  INFINITY_ASSERT(extentSizeInBytes > 0 &&
+                      extentSizeInBytes %
+                              infinity::core::Configuration::PAGE_SIZE ==
+                          0,
+                  "[INFINITY][MEMORY][BUFFER] Extent size must be a multiple "
+                  "of the page size.\n");
+
+  this->context = context;
+  this->sizeInBytes = 0;
+  this->memoryRegionType = RegionType::BUFFER;
+
+  // Reserve address space only, extents are made accessible when registered
+  this->mappedSizeInBytes =
+      ParallelRegistration::getNumberOfChunks(maximumSizeInBytes,
+                                              extentSizeInBytes) *
+      extentSizeInBytes;
+  this->data = mmap(nullptr, this->mappedSizeInBytes, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  INFINITY_ASSERT(this->data != MAP_FAILED,
+                  "[INFINITY][MEMORY][BUFFER] Cannot reserve address space.\n");
+
+  this->chunkSizeInBytes = extentSizeInBytes;
+  this->memoryMapped = true;
+  this->growable = true;
+  this->memoryAllocated = false;
+  this->memoryRegistered = true;
+
+  resizeInPlace(sizeInBytes);
+}
+
+Buffer::Buffer(std::shared_ptr<infinity::core::Context> context,
+               const char *path, bool writable, bool populate, bool prefault,
+               Token) {
+
+  this->context = context;
+  this->memoryRegionType = RegionType::BUFFER;
+
+  this->data = FileMapping::map(path, writable, populate, prefault,
+                                this->sizeInBytes);
+  this->mappedSizeInBytes = this->sizeInBytes;
+
+  this->ibvMemoryRegion =
+      ibv_reg_mr(this->context->getProtectionDomain(), this->data,
+                 this->sizeInBytes, FileMapping::getAccessFlags(writable));
+  if (this->ibvMemoryRegion == nullptr) {
+    FileMapping::unmap(this->data, this->mappedSizeInBytes);
+  }
   INFINITY_ASSERT(this->ibvMemoryRegion != nullptr,
                   "[INFINITY][MEMORY][BUFFER] Registration failed.\n");
 
+  this->memoryMapped = true;
   this->memoryAllocated = false;
   this->memoryRegistered = true;
 }
 
 Buffer::~Buffer() {
 
-  if (this->memoryRegistered) {
+  if (this->chunkSizeInBytes != 0) {
+    ParallelRegistration::deregisterChunks(this->chunkMemoryRegions);
+  } else if (this->memoryRegistered) {
     ibv_dereg_mr(this->ibvMemoryRegion);
   }
   if (this->memoryAllocated) {
     free(this->data);
   }
+  if (this->memoryMapped) {
+    FileMapping::unmap(this->data, this->mappedSizeInBytes);
+  }
 }
 
 void *Buffer::getData() { return reinterpret_cast<void *>(this->getAddress()); }
 
+bool Buffer::isGrowable() { return this->growable; }
+
 void Buffer::resize(uint64_t newSize) {
 
+  if (this->growable) {
+    resizeInPlace(newSize);
+    return;
+  }
+
+  INFINITY_ASSERT(!this->memoryMapped,
+                  "[INFINITY][MEMORY][BUFFER] Mapped files cannot be "
+                  "resized.\n");
+
+  INFINITY_ASSERT(this->chunkSizeInBytes == 0,
+                  "[INFINITY][MEMORY][BUFFER] Chunked buffers cannot be "
+                  "resized.\n");
+
   void *oldData = this->data;
   uint64_t oldSize = this->sizeInBytes;
 
@@ -130,8 +269,7 @@ void Buffer::resize(uint64_t newSize) {
     ibv_dereg_mr(this->ibvMemoryRegion);
     this->ibvMemoryRegion =
         ibv_reg_mr(this->context->getProtectionDomain(), newData, newSize,
-                   IBV_ACCESS_REMOTE_WRITE | IBV_ACCESS_LOCAL_WRITE |
-                       IBV_ACCESS_REMOTE_READ);
+                   this->context->getMemoryAccessFlags());
     INFINITY_ASSERT(this->ibvMemoryRegion != nullptr,
                     "[INFINITY][MEMORY][BUFFER] Registration failed.\n");
     this->data = newData;
@@ -146,5 +284,52 @@ void Buffer::resize(uint64_t newSize) {
   }
 }
 
+void Buffer::resizeInPlace(uint64_t newSize) {
+
+  INFINITY_ASSERT(newSize > 0 && newSize <= this->mappedSizeInBytes,
+                  "[INFINITY][MEMORY][BUFFER] Cannot grow buffer beyond its "
+                  "reserved size of %lu bytes.\n",
+                  this->mappedSizeInBytes);
+
+  uint32_t currentExtents = this->chunkMemoryRegions.size();
+  uint32_t requiredExtents =
+      ParallelRegistration::getNumberOfChunks(newSize, this->chunkSizeInBytes);
+  char *base = reinterpret_cast<char *>(this->data);
+
+  if (requiredExtents > currentExtents) {
+
+    // Register the new extents only, existing keys remain untouched
+    uint64_t offset = currentExtents * this->chunkSizeInBytes;
+    uint64_t length = (requiredExtents - currentExtents) * this->chunkSizeInBytes;
+    int returnValue = mprotect(base + offset, length, PROT_READ | PROT_WRITE);
+    INFINITY_ASSERT(returnValue == 0,
+                    "[INFINITY][MEMORY][BUFFER] Cannot commit extent.\n");
+
+    std::vector<ibv_mr *> extents = ParallelRegistration::registerChunks(
+        this->context.get(), base + offset, length, this->chunkSizeInBytes, 0,
+        false,
+        this->context->getMemoryAccessFlags());
+    this->chunkMemoryRegions.insert(this->chunkMemoryRegions.end(),
+                                    extents.begin(), extents.end());
+
+  } else if (requiredExtents < currentExtents) {
+
+    // Release extents which are no longer covered by the buffer
+    std::vector<ibv_mr *> extents(this->chunkMemoryRegions.begin() +
+                                      requiredExtents,
+                                  this->chunkMemoryRegions.end());
+    ParallelRegistration::deregisterChunks(extents);
+    this->chunkMemoryRegions.resize(requiredExtents);
+
+    uint64_t offset = requiredExtents * this->chunkSizeInBytes;
+    uint64_t length = (currentExtents - requiredExtents) * this->chunkSizeInBytes;
+    madvise(base + offset, length, MADV_DONTNEED);
+    mprotect(base + offset, length, PROT_NONE);
+  }
+
+  this->ibvMemoryRegion = this->chunkMemoryRegions[0];
+  this->sizeInBytes = newSize;
+}
+
 } /* namespace memory */
 } /* namespace infinity */
@@ -0,0 +1,79 @@
+/*
+ * Memory - File Mapping
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "FileMapping.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <infiniband/verbs.h>
+
+#include <infinity/core/Configuration.h>
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace memory {
+
+void *FileMapping::map(const char *path, bool writable, bool populate,
+                       bool prefault, uint64_t &sizeInBytes) {
+
+  int fileDescriptor = open(path, writable ? O_RDWR : O_RDONLY);
+  INFINITY_ASSERT(fileDescriptor >= 0,
+                  "[INFINITY][MEMORY][FILE] Cannot open file %s: %s.\n", path,
+                  strerror(errno));
+
+  struct stat fileStatus;
+  int returnValue = fstat(fileDescriptor, &fileStatus);
+  if (returnValue != 0 || fileStatus.st_size == 0) {
+    close(fileDescriptor);
+  }
+  INFINITY_ASSERT(returnValue == 0 && fileStatus.st_size > 0,
+                  "[INFINITY][MEMORY][FILE] Cannot map empty file %s.\n",
+                  path);
+  sizeInBytes = fileStatus.st_size;
+
+  int protection = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+  int flags = MAP_SHARED | (populate ? MAP_POPULATE : 0);
+  void *data = mmap(nullptr, sizeInBytes, protection, flags, fileDescriptor, 0);
+
+  // The mapping keeps its own reference to the file
+  close(fileDescriptor);
+  INFINITY_ASSERT(data != MAP_FAILED,
+                  "[INFINITY][MEMORY][FILE] Cannot map file %s: %s.\n", path,
+                  strerror(errno));
+
+  if (prefault) {
+    volatile const char *pages = reinterpret_cast<const char *>(data);
+    char sum = 0;
+    for (uint64_t offset = 0; offset < sizeInBytes;
+         offset += infinity::core::Configuration::PAGE_SIZE) {
+      sum += pages[offset];
+    }
+    (void)sum;
+  }
+
+  return data;
+}
+
+void FileMapping::unmap(void *data, uint64_t sizeInBytes) {
+  munmap(data, sizeInBytes);
+}
+
+int FileMapping::getAccessFlags(bool writable) {
+  if (writable) {
+    return IBV_ACCESS_REMOTE_WRITE | IBV_ACCESS_LOCAL_WRITE |
+           IBV_ACCESS_REMOTE_READ;
+  }
+  return IBV_ACCESS_REMOTE_READ;
+}
+
+} /* namespace memory */
+} /* namespace infinity */
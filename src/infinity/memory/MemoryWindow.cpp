@@ -0,0 +1,79 @@
+/*
+ * Memory - Memory Window
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "MemoryWindow.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace memory {
+
+MemoryWindow::MemoryWindow(std::shared_ptr<infinity::core::Context> context)
+    : context(context) {
+
+  INFINITY_ASSERT(this->context->supportsMemoryWindows(),
+                  "[INFINITY][MEMORY][WINDOW] Memory windows are not enabled "
+                  "(memory_windows) or not supported by the device.\n");
+
+  this->ibvMemoryWindow =
+      ibv_alloc_mw(this->context->getProtectionDomain(), IBV_MW_TYPE_2);
+  INFINITY_ASSERT(this->ibvMemoryWindow != nullptr,
+                  "[INFINITY][MEMORY][WINDOW] Cannot allocate window. %s.\n",
+                  strerror(errno));
+  this->remoteKey = this->ibvMemoryWindow->rkey;
+}
+
+MemoryWindow::~MemoryWindow() {
+  // Deallocating a bound window invalidates it as well
+  ibv_dealloc_mw(this->ibvMemoryWindow);
+}
+
+RegionToken MemoryWindow::createRegionToken() {
+  INFINITY_ASSERT(this->bound,
+                  "[INFINITY][MEMORY][WINDOW] Window is not bound.\n");
+  uint64_t offset = this->address - this->buffer->getAddress();
+  return RegionToken(this->buffer.get(), WINDOW, this->sizeInBytes,
+                     this->address, this->buffer->getLocalKey(offset),
+                     this->remoteKey);
+}
+
+bool MemoryWindow::isBound() { return this->bound; }
+
+std::shared_ptr<Buffer> MemoryWindow::getBuffer() { return this->buffer; }
+
+uint64_t MemoryWindow::getAddress() { return this->address; }
+
+uint64_t MemoryWindow::getSizeInBytes() { return this->sizeInBytes; }
+
+uint32_t MemoryWindow::getRemoteKey() { return this->remoteKey; }
+
+uint32_t MemoryWindow::nextRemoteKey() {
+  return ibv_inc_rkey(this->remoteKey);
+}
+
+void MemoryWindow::setBound(std::shared_ptr<Buffer> buffer, uint64_t address,
+                            uint64_t sizeInBytes, uint32_t remoteKey) {
+  this->buffer = buffer;
+  this->address = address;
+  this->sizeInBytes = sizeInBytes;
+  this->remoteKey = remoteKey;
+  this->bound = true;
+}
+
+void MemoryWindow::setUnbound() {
+  this->buffer.reset();
+  this->address = 0;
+  this->sizeInBytes = 0;
+  this->bound = false;
+}
+
+} /* namespace memory */
+} /* namespace infinity */
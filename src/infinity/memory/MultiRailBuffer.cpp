@@ -0,0 +1,100 @@
+/**
+ * Memory - Multi-Rail Buffer
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "MultiRailBuffer.h"
+
+#include <thread>
+
+#include <infinity/utils/Debug.h>
+#include <infinity/utils/Numa.h>
+
+namespace infinity {
+namespace memory {
+
+MultiRailBuffer::MultiRailBuffer(
+    std::shared_ptr<infinity::core::MultiRailContext> context,
+    uint64_t sizeInBytes, uint32_t homeRail)
+    : context(context), homeRail(homeRail) {
+
+  INFINITY_ASSERT(homeRail < context->getNumberOfRails(),
+                  "[INFINITY][MEMORY][MULTIRAIL] Home rail %u does not "
+                  "exist.\n",
+                  homeRail);
+
+  this->buffers.resize(context->getNumberOfRails());
+  std::shared_ptr<infinity::core::Context> homeContext =
+      context->getContext(homeRail);
+
+  // The buffer is zeroed on allocation, so the first touch happens on the
+  // CPUs local to the home rail if we are not there already
+  int32_t numaNode = homeContext->getNumaNode();
+  if (numaNode < 0 ||
+      numaNode == infinity::utils::Numa::getNumaNodeOfCurrentThread()) {
+    this->buffers[homeRail] = Buffer::createBuffer(homeContext, sizeInBytes);
+  } else {
+    std::thread allocator([this, &homeContext, sizeInBytes]() {
+      infinity::utils::Numa::bindCurrentThreadToCpus(
+          homeContext->getLocalCpus());
+      this->buffers[this->homeRail] =
+          Buffer::createBuffer(homeContext, sizeInBytes);
+    });
+    allocator.join();
+  }
+
+  void *data = this->buffers[homeRail]->getData();
+  for (uint32_t rail = 0; rail < this->buffers.size(); ++rail) {
+    if (rail != homeRail) {
+      this->buffers[rail] =
+          Buffer::createBuffer(context->getContext(rail), data, sizeInBytes);
+    }
+  }
+}
+
+void *MultiRailBuffer::getData() {
+  return this->buffers[this->homeRail]->getData();
+}
+
+uint64_t MultiRailBuffer::getSizeInBytes() {
+  return this->buffers[this->homeRail]->getSizeInBytes();
+}
+
+uint32_t MultiRailBuffer::getHomeRail() { return this->homeRail; }
+
+int32_t MultiRailBuffer::getNumaNode() {
+  return this->context->getNumaNode(this->homeRail);
+}
+
+std::shared_ptr<Buffer> MultiRailBuffer::getBuffer(uint32_t rail) {
+  return this->buffers.at(rail);
+}
+
+multi_rail_token_t MultiRailBuffer::createToken() {
+
+  multi_rail_token_t token;
+  token.address = (uint64_t)this->getData();
+  token.sizeInBytes = this->getSizeInBytes();
+  token.numberOfRails = this->buffers.size();
+  for (uint32_t rail = 0; rail < this->buffers.size(); ++rail) {
+    token.remoteKeys[rail] = this->buffers[rail]->getRemoteKey();
+  }
+  return token;
+}
+
+RegionToken MultiRailBuffer::getRegionToken(const multi_rail_token_t &token,
+                                            uint32_t rail) {
+
+  INFINITY_ASSERT(rail < token.numberOfRails,
+                  "[INFINITY][MEMORY][MULTIRAIL] Token has no key for rail "
+                  "%u.\n",
+                  rail);
+  return RegionToken(nullptr, BUFFER, token.sizeInBytes, token.address, 0,
+                     token.remoteKeys[rail]);
+}
+
+} /* namespace memory */
+} /* namespace infinity */
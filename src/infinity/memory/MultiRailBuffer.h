@@ -0,0 +1,79 @@
+/**
+ * Memory - Multi-Rail Buffer
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef MEMORY_MULTIRAILBUFFER_H_
+#define MEMORY_MULTIRAILBUFFER_H_
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include <infinity/core/MultiRailContext.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/memory/RegionToken.h>
+
+namespace infinity {
+namespace memory {
+
+/**
+ * Combined region token of a multi-rail buffer, one remote key per rail.
+ * Plain data, can be sent to peers as is.
+ */
+typedef struct __attribute__((packed)) {
+  uint64_t address = 0;
+  uint64_t sizeInBytes = 0;
+  uint32_t numberOfRails = 0;
+  uint32_t remoteKeys[infinity::core::MultiRailContext::MAX_RAILS] = {};
+} multi_rail_token_t;
+
+/**
+ * One block of memory registered with the protection domain of every rail.
+ * The memory is placed on the NUMA node of its home rail.
+ */
+class MultiRailBuffer {
+
+public:
+  MultiRailBuffer(std::shared_ptr<infinity::core::MultiRailContext> context,
+                  uint64_t sizeInBytes, uint32_t homeRail = 0);
+
+  MultiRailBuffer(const MultiRailBuffer &) = delete;
+  MultiRailBuffer(const MultiRailBuffer &&) = delete;
+  MultiRailBuffer &operator=(const MultiRailBuffer &) = delete;
+  MultiRailBuffer &operator=(MultiRailBuffer &&) = delete;
+
+public:
+  void *getData();
+  uint64_t getSizeInBytes();
+  uint32_t getHomeRail();
+  int32_t getNumaNode();
+
+  /**
+   * Registration of the memory on one rail
+   */
+  std::shared_ptr<Buffer> getBuffer(uint32_t rail);
+
+public:
+  multi_rail_token_t createToken();
+
+  /**
+   * Token of a single rail, usable as remote destination or source of
+   * queue pairs on that rail
+   */
+  static RegionToken getRegionToken(const multi_rail_token_t &token,
+                                    uint32_t rail);
+
+protected:
+  std::shared_ptr<infinity::core::MultiRailContext> context;
+  std::vector<std::shared_ptr<Buffer> > buffers;
+  uint32_t homeRail = 0;
+};
+
+} /* namespace memory */
+} /* namespace infinity */
+
+#endif /* MEMORY_MULTIRAILBUFFER_H_ */
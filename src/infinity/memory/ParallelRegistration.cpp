@@ -0,0 +1,104 @@
+/*
+ * Memory - Parallel Registration
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "ParallelRegistration.h"
+
+#include <string.h>
+#include <algorithm>
+#include <thread>
+
+#include <infinity/core/Configuration.h>
+#include <infinity/utils/Debug.h>
+#include <infinity/utils/Numa.h>
+
+namespace infinity {
+namespace memory {
+
+uint32_t ParallelRegistration::getNumberOfChunks(uint64_t sizeInBytes,
+                                                 uint64_t chunkSizeInBytes) {
+  return static_cast<uint32_t>((sizeInBytes + chunkSizeInBytes - 1) /
+                               chunkSizeInBytes);
+}
+
+std::vector<ibv_mr *> ParallelRegistration::registerChunks(
+    infinity::core::Context *context, void *data, uint64_t sizeInBytes,
+    uint64_t chunkSizeInBytes, uint32_t numberOfThreads, bool prefault,
+    int accessFlags) {
+
+  INFINITY_ASSERT(chunkSizeInBytes > 0 &&
+                      chunkSizeInBytes %
+                              infinity::core::Configuration::PAGE_SIZE ==
+                          0,
+                  "[INFINITY][MEMORY][PARALLEL] Chunk size must be a multiple "
+                  "of the page size.\n");
+
+  uint32_t numberOfChunks = getNumberOfChunks(sizeInBytes, chunkSizeInBytes);
+  std::vector<ibv_mr *> chunks(numberOfChunks, nullptr);
+
+  const std::vector<uint32_t> &localCpus = context->getLocalCpus();
+  if (numberOfThreads == 0) {
+    numberOfThreads = localCpus.empty() ? std::thread::hardware_concurrency()
+                                        : localCpus.size();
+  }
+  numberOfThreads = std::max(1u, std::min(numberOfThreads, numberOfChunks));
+
+  ibv_pd *protectionDomain = context->getProtectionDomain();
+  char *base = reinterpret_cast<char *>(data);
+
+  // Thread t handles chunks t, t + numberOfThreads, ...
+  auto worker = [&](uint32_t threadId) {
+    infinity::utils::Numa::bindCurrentThreadToCpus(localCpus);
+    for (uint32_t chunk = threadId; chunk < numberOfChunks;
+         chunk += numberOfThreads) {
+      uint64_t offset = chunk * chunkSizeInBytes;
+      uint64_t length = std::min(chunkSizeInBytes, sizeInBytes - offset);
+      if (prefault) {
+        memset(base + offset, 0, length);
+      }
+      chunks[chunk] =
+          ibv_reg_mr(protectionDomain, base + offset, length, accessFlags);
+    }
+  };
+
+  // Workers change their CPU affinity, so the caller never runs one itself
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < numberOfThreads; ++t) {
+    threads.emplace_back(worker, t);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  // Registration happens on worker threads, report failures from here
+  bool success = std::find(chunks.begin(), chunks.end(), nullptr) ==
+                 chunks.end();
+  if (!success) {
+    deregisterChunks(chunks);
+  }
+  INFINITY_ASSERT(success,
+                  "[INFINITY][MEMORY][PARALLEL] Registration failed.\n");
+
+  INFINITY_DEBUG("[INFINITY][MEMORY][PARALLEL] Registered %lu bytes as %u "
+                 "chunks using %u threads.\n",
+                 sizeInBytes, numberOfChunks, numberOfThreads);
+
+  return chunks;
+}
+
+void ParallelRegistration::deregisterChunks(std::vector<ibv_mr *> &chunks) {
+
+  for (ibv_mr *chunk : chunks) {
+    if (chunk != nullptr) {
+      ibv_dereg_mr(chunk);
+    }
+  }
+  chunks.clear();
+}
+
+} /* namespace memory */
+} /* namespace infinity */
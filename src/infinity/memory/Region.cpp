@@ -8,6 +8,8 @@
 
 #include "Buffer.h"
 
+#include <algorithm>
+
 #include <infinity/utils/Debug.h>
 #include <infinity/memory/RegionToken.h>
 
@@ -21,20 +23,34 @@ Region::~Region() {
 }
 
 RegionToken Region::createRegionToken() {
+  INFINITY_ASSERT(getNumberOfChunks() == 1,
+                  "[INFINITY][MEMORY][REGION] Region is registered in %u "
+                  "chunks with one key each, use createRegionToken(offset).\n",
+                  getNumberOfChunks());
   return RegionToken(this, getMemoryRegionType(), getSizeInBytes(),
                      getAddress(), getLocalKey(), getRemoteKey());
 }
 
 RegionToken Region::createRegionToken(uint64_t offset) {
-  return RegionToken(
-      this, getMemoryRegionType(), getRemainingSizeInBytes(offset),
-      getAddressWithOffset(offset), getLocalKey(), getRemoteKey());
+  uint64_t size = getRemainingSizeInBytes(offset);
+  if (this->chunkSizeInBytes != 0) {
+    size = std::min(size, this->chunkSizeInBytes -
+                              (offset % this->chunkSizeInBytes));
+  }
+  return RegionToken(this, getMemoryRegionType(), size,
+                     getAddressWithOffset(offset), getLocalKey(offset),
+                     getRemoteKey(offset));
 }
 
 RegionToken Region::createRegionToken(uint64_t offset, uint64_t size) {
+  INFINITY_ASSERT(this->chunkSizeInBytes == 0 || size == 0 ||
+                      offset / this->chunkSizeInBytes ==
+                          (offset + size - 1) / this->chunkSizeInBytes,
+                  "[INFINITY][MEMORY][REGION] Region token must not cross a "
+                  "chunk boundary.\n");
   return RegionToken(this, getMemoryRegionType(), size,
-                     getAddressWithOffset(offset), getLocalKey(),
-                     getRemoteKey());
+                     getAddressWithOffset(offset), getLocalKey(offset),
+                     getRemoteKey(offset));
 }
 
 RegionType Region::getMemoryRegionType() { return this->memoryRegionType; }
@@ -55,5 +71,29 @@ uint32_t Region::getLocalKey() { return this->ibvMemoryRegion->lkey; }
 
 uint32_t Region::getRemoteKey() { return this->ibvMemoryRegion->rkey; }
 
+uint32_t Region::getLocalKey(uint64_t offset) {
+  return getMemoryRegionWithOffset(offset)->lkey;
+}
+
+uint32_t Region::getRemoteKey(uint64_t offset) {
+  return getMemoryRegionWithOffset(offset)->rkey;
+}
+
+uint64_t Region::getChunkSizeInBytes() {
+  return (this->chunkSizeInBytes != 0) ? this->chunkSizeInBytes
+                                       : this->sizeInBytes;
+}
+
+uint32_t Region::getNumberOfChunks() {
+  return (this->chunkSizeInBytes != 0) ? this->chunkMemoryRegions.size() : 1;
+}
+
+ibv_mr *Region::getMemoryRegionWithOffset(uint64_t offset) {
+  if (this->chunkSizeInBytes == 0) {
+    return this->ibvMemoryRegion;
+  }
+  return this->chunkMemoryRegions[offset / this->chunkSizeInBytes];
+}
+
 } /* namespace memory */
 } /* namespace infinity */
@@ -10,6 +10,7 @@
 #define MEMORY_REGION_H_
 
 #include <stdint.h>
+#include <vector>
 #include <infiniband/verbs.h>
 
 #include <infinity/core/Context.h>
@@ -22,10 +23,16 @@ class RegionToken;
 
 class Region {
 
+  friend class infinity::queues::QueuePair;
+
 public:
   Region();
   virtual ~Region();
 
+  /**
+   * A token for the whole region needs a single key, regions registered
+   * in several chunks hand out a token per chunk through the offset.
+   */
   RegionToken createRegionToken();
   RegionToken createRegionToken(uint64_t offset);
   RegionToken createRegionToken(uint64_t offset, uint64_t size);
@@ -39,6 +46,16 @@ public:
   uint32_t getLocalKey();
   uint32_t getRemoteKey();
 
+public:
+  /**
+   * Regions registered in chunks use one key per chunk. An operation must
+   * not cross a chunk boundary.
+   */
+  uint32_t getLocalKey(uint64_t offset);
+  uint32_t getRemoteKey(uint64_t offset);
+  uint64_t getChunkSizeInBytes();
+  uint32_t getNumberOfChunks();
+
   Region(const Region &) = delete;
   Region(const Region &&) = delete;
   Region &operator=(const Region &) = delete;
@@ -49,6 +66,11 @@ protected:
   RegionType memoryRegionType;
   ibv_mr *ibvMemoryRegion = nullptr;
 
+  std::vector<ibv_mr *> chunkMemoryRegions;
+  uint64_t chunkSizeInBytes = 0;
+
+  ibv_mr *getMemoryRegionWithOffset(uint64_t offset);
+
 protected:
   void *data = nullptr;
   uint64_t sizeInBytes = 0;
@@ -0,0 +1,289 @@
+/*
+ * Memory - Region Directory
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "RegionDirectory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <string.h>
+#include <thread>
+
+#include <infinity/queues/QueuePair.h>
+#include <infinity/requests/RequestToken.h>
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace memory {
+
+/*******************************
+ * Region Directory
+ ******************************/
+
+RegionDirectory::RegionDirectory(
+    std::shared_ptr<infinity::core::Context> context,
+    uint32_t maxNumberOfEntries)
+    : maxNumberOfEntries(maxNumberOfEntries) {
+
+  INFINITY_ASSERT(getSizeInBytes(maxNumberOfEntries) <=
+                      std::numeric_limits<uint32_t>::max(),
+                  "[INFINITY][MEMORY][DIRECTORY] Directory needs to be "
+                  "readable in a single operation.\n");
+
+  this->buffer =
+      Buffer::createBuffer(context, getSizeInBytes(maxNumberOfEntries));
+  memset(this->buffer->getData(), 0, this->buffer->getSizeInBytes());
+
+  uint32_t entrySize = ENTRY_SIZE_IN_BYTES;
+  memcpy(reinterpret_cast<char *>(this->buffer->getData()) + 12, &entrySize,
+         sizeof(uint32_t));
+}
+
+void RegionDirectory::publish(const std::string &name,
+                              const RegionToken &token) {
+
+  INFINITY_ASSERT(name.size() < NAME_SIZE_IN_BYTES,
+                  "[INFINITY][MEMORY][DIRECTORY] Name %s is too long.\n",
+                  name.c_str());
+
+  uint32_t index;
+  auto it = this->entryIndex.find(name);
+  if (it != this->entryIndex.end()) {
+    index = it->second;
+  } else {
+    INFINITY_ASSERT(this->entryIndex.size() < this->maxNumberOfEntries,
+                    "[INFINITY][MEMORY][DIRECTORY] Directory is full.\n");
+    index = static_cast<uint32_t>(this->entryIndex.size());
+  }
+
+  beginUpdate();
+  char *entry = getEntry(index);
+  memset(entry, 0, NAME_SIZE_IN_BYTES);
+  memcpy(entry, name.data(), name.size());
+  token.serialize(entry + NAME_SIZE_IN_BYTES);
+  this->entryIndex[name] = index;
+  endUpdate();
+}
+
+bool RegionDirectory::remove(const std::string &name) {
+
+  auto it = this->entryIndex.find(name);
+  if (it == this->entryIndex.end()) {
+    return false;
+  }
+
+  // Keep entries dense by moving the last entry into the gap
+  uint32_t index = it->second;
+  uint32_t lastIndex = static_cast<uint32_t>(this->entryIndex.size()) - 1;
+  this->entryIndex.erase(it);
+
+  beginUpdate();
+  if (index != lastIndex) {
+    memcpy(getEntry(index), getEntry(lastIndex), ENTRY_SIZE_IN_BYTES);
+    std::string movedName(getEntry(index));
+    this->entryIndex[movedName] = index;
+  }
+  memset(getEntry(lastIndex), 0, ENTRY_SIZE_IN_BYTES);
+  endUpdate();
+
+  return true;
+}
+
+RegionToken RegionDirectory::createRegionToken() {
+  return this->buffer->createRegionToken();
+}
+
+uint64_t RegionDirectory::getVersion() {
+  return __atomic_load_n(reinterpret_cast<uint64_t *>(this->buffer->getData()),
+                         __ATOMIC_ACQUIRE);
+}
+
+uint32_t RegionDirectory::getNumberOfEntries() {
+  return static_cast<uint32_t>(this->entryIndex.size());
+}
+
+uint32_t RegionDirectory::getMaxNumberOfEntries() {
+  return this->maxNumberOfEntries;
+}
+
+uint64_t RegionDirectory::getSizeInBytes(uint32_t maxNumberOfEntries) {
+  return HEADER_SIZE_IN_BYTES +
+         static_cast<uint64_t>(maxNumberOfEntries) * ENTRY_SIZE_IN_BYTES;
+}
+
+void RegionDirectory::beginUpdate() {
+  uint64_t *version = reinterpret_cast<uint64_t *>(this->buffer->getData());
+  __atomic_store_n(version, *version + 1, __ATOMIC_RELAXED);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+void RegionDirectory::endUpdate() {
+  char *header = reinterpret_cast<char *>(this->buffer->getData());
+  uint32_t numberOfEntries = static_cast<uint32_t>(this->entryIndex.size());
+  memcpy(header + 8, &numberOfEntries, sizeof(uint32_t));
+
+  uint64_t *version = reinterpret_cast<uint64_t *>(header);
+  __atomic_store_n(version, *version + 1, __ATOMIC_RELEASE);
+}
+
+char *RegionDirectory::getEntry(uint32_t index) {
+  return reinterpret_cast<char *>(this->buffer->getData()) +
+         HEADER_SIZE_IN_BYTES +
+         static_cast<uint64_t>(index) * ENTRY_SIZE_IN_BYTES;
+}
+
+/*******************************
+ * Remote Region Directory
+ ******************************/
+
+RemoteRegionDirectory::RemoteRegionDirectory(
+    std::shared_ptr<infinity::core::Context> context,
+    std::shared_ptr<infinity::queues::QueuePair> queuePair,
+    const RegionToken &directoryToken)
+    : context(context), queuePair(queuePair), directoryToken(directoryToken) {
+
+  INFINITY_ASSERT(directoryToken.getSizeInBytes() >=
+                      RegionDirectory::HEADER_SIZE_IN_BYTES,
+                  "[INFINITY][MEMORY][DIRECTORY] Token does not describe a "
+                  "directory.\n");
+
+  this->buffer =
+      Buffer::createBuffer(context, directoryToken.getSizeInBytes());
+  this->versionBuffer = Buffer::createBuffer(context, sizeof(uint64_t));
+
+  refresh();
+}
+
+bool RemoteRegionDirectory::lookup(const std::string &name,
+                                   RegionToken &token) {
+  auto it = this->entries.find(name);
+  if (it == this->entries.end()) {
+    return false;
+  }
+  token = it->second;
+  return true;
+}
+
+void RemoteRegionDirectory::refresh() {
+
+  infinity::requests::RequestToken requestToken(this->context);
+  const char *data = reinterpret_cast<const char *>(this->buffer->getData());
+
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(REFRESH_TIMEOUT_IN_MILLISECONDS);
+  std::chrono::microseconds backoff(1);
+
+  for (bool retry = false; true; retry = true) {
+
+    if (retry) {
+      INFINITY_ASSERT(std::chrono::steady_clock::now() < deadline,
+                      "[INFINITY][MEMORY][DIRECTORY] Timed out waiting for a "
+                      "consistent directory.\n");
+      std::this_thread::sleep_for(backoff);
+      backoff = std::min(backoff * 2, std::chrono::microseconds(1000));
+    }
+
+    this->queuePair->read(this->buffer, 0, this->directoryToken, 0,
+                          RegionDirectory::HEADER_SIZE_IN_BYTES,
+                          infinity::queues::OperationFlags(), &requestToken);
+    waitForRead(requestToken);
+
+    uint64_t remoteVersion;
+    uint32_t numberOfEntries;
+    uint32_t entrySize;
+    memcpy(&remoteVersion, data, sizeof(uint64_t));
+    memcpy(&numberOfEntries, data + 8, sizeof(uint32_t));
+    memcpy(&entrySize, data + 12, sizeof(uint32_t));
+
+    // Server is in the middle of an update
+    if ((remoteVersion & 1) != 0) {
+      continue;
+    }
+
+    INFINITY_ASSERT(entrySize == RegionDirectory::ENTRY_SIZE_IN_BYTES,
+                    "[INFINITY][MEMORY][DIRECTORY] Unknown entry size %u.\n",
+                    entrySize);
+    uint64_t entriesSize =
+        static_cast<uint64_t>(numberOfEntries) * entrySize;
+    INFINITY_ASSERT(RegionDirectory::HEADER_SIZE_IN_BYTES + entriesSize <=
+                        this->buffer->getSizeInBytes(),
+                    "[INFINITY][MEMORY][DIRECTORY] Directory with %u entries "
+                    "is truncated.\n",
+                    numberOfEntries);
+
+    if (entriesSize > 0) {
+      this->queuePair->read(
+          this->buffer, RegionDirectory::HEADER_SIZE_IN_BYTES,
+          this->directoryToken, RegionDirectory::HEADER_SIZE_IN_BYTES,
+          static_cast<uint32_t>(entriesSize),
+          infinity::queues::OperationFlags(), &requestToken);
+      waitForRead(requestToken);
+    }
+
+    // Entries may have changed while they were read
+    if (readRemoteVersion() != remoteVersion) {
+      continue;
+    }
+
+    this->entries.clear();
+    const char *entry = data + RegionDirectory::HEADER_SIZE_IN_BYTES;
+    for (uint32_t i = 0; i < numberOfEntries; ++i) {
+      std::string name(entry, strnlen(entry,
+                                      RegionDirectory::NAME_SIZE_IN_BYTES));
+      this->entries[name] = RegionToken::deserialize(
+          entry + RegionDirectory::NAME_SIZE_IN_BYTES);
+      entry += entrySize;
+    }
+    this->version = remoteVersion;
+
+    INFINITY_DEBUG("[INFINITY][MEMORY][DIRECTORY] Fetched %u entries at "
+                   "version %lu.\n",
+                   numberOfEntries, remoteVersion);
+    return;
+  }
+}
+
+bool RemoteRegionDirectory::revalidate() {
+  if (readRemoteVersion() == this->version) {
+    return false;
+  }
+  refresh();
+  return true;
+}
+
+uint64_t RemoteRegionDirectory::getVersion() { return this->version; }
+
+uint32_t RemoteRegionDirectory::getNumberOfEntries() {
+  return static_cast<uint32_t>(this->entries.size());
+}
+
+uint64_t RemoteRegionDirectory::readRemoteVersion() {
+  infinity::requests::RequestToken requestToken(this->context);
+  this->queuePair->read(this->versionBuffer, 0, this->directoryToken, 0,
+                        sizeof(uint64_t), infinity::queues::OperationFlags(),
+                        &requestToken);
+  waitForRead(requestToken);
+
+  uint64_t remoteVersion;
+  memcpy(&remoteVersion, this->versionBuffer->getData(), sizeof(uint64_t));
+  return remoteVersion;
+}
+
+void RemoteRegionDirectory::waitForRead(
+    infinity::requests::RequestToken &requestToken) {
+  requestToken.waitUntilCompleted();
+  INFINITY_ASSERT(requestToken.wasSuccessful(),
+                  "[INFINITY][MEMORY][DIRECTORY] Reading directory failed. "
+                  "%s.\n",
+                  requestToken.getStatusString());
+}
+
+} /* namespace memory */
+} /* namespace infinity */
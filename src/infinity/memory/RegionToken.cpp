@@ -8,6 +8,8 @@
 
 #include <infinity/memory/RegionToken.h>
 
+#include <string.h>
+
 namespace infinity {
 namespace memory {
 
@@ -45,6 +47,24 @@ uint32_t RegionToken::getLocalKey() const { return this->localKey; }
 
 uint32_t RegionToken::getRemoteKey() const { return this->remoteKey; }
 
+void RegionToken::serialize(void *destination) const {
+  serializedRegionToken serialized;
+  serialized.address = this->address;
+  serialized.sizeInBytes = this->sizeInBytes;
+  serialized.remoteKey = this->remoteKey;
+  serialized.memoryRegionType = static_cast<uint32_t>(this->memoryRegionType);
+  memcpy(destination, &serialized, sizeof(serializedRegionToken));
+}
+
+RegionToken RegionToken::deserialize(const void *source) {
+  serializedRegionToken serialized;
+  memcpy(&serialized, source, sizeof(serializedRegionToken));
+  return RegionToken(nullptr,
+                     static_cast<RegionType>(serialized.memoryRegionType),
+                     serialized.sizeInBytes, serialized.address, 0,
+                     serialized.remoteKey);
+}
+
 std::ostream &operator<<(std::ostream &os, const RegionToken &regionToken) {
   os << "size: " << regionToken.getSizeInBytes() << " address "
      << regionToken.getAddress() << " localKey " << regionToken.getLocalKey()
@@ -17,8 +17,25 @@
 namespace infinity {
 namespace memory {
 
+/**
+ * Wire encoding of a region token. Only what a peer can use is encoded,
+ * the local region pointer and local key are left out.
+ */
+typedef struct __attribute__((packed)) {
+
+  uint64_t address;
+  uint64_t sizeInBytes;
+  uint32_t remoteKey;
+  uint32_t memoryRegionType;
+
+} serializedRegionToken;
+
 class RegionToken {
 
+public:
+  static const uint32_t SERIALIZED_SIZE_IN_BYTES =
+      sizeof(serializedRegionToken);
+
 public:
   RegionToken();
   RegionToken(Region *memoryRegion, RegionType memoryRegionType,
@@ -35,6 +52,19 @@ public:
   uint32_t getLocalKey() const;
   uint32_t getRemoteKey() const;
 
+public:
+  /**
+   * Write the wire encoding to destination, which needs to hold
+   * SERIALIZED_SIZE_IN_BYTES bytes. No alignment is required.
+   */
+  void serialize(void *destination) const;
+
+  /**
+   * Decode a token from its wire encoding. The result has no local region
+   * and can only be used as a remote destination or source.
+   */
+  static RegionToken deserialize(const void *source);
+
 private:
   Region *memoryRegion = nullptr;
   RegionType memoryRegionType = UNKNOWN;
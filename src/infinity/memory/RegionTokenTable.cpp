@@ -0,0 +1,131 @@
+/*
+ * Memory - Region Token Table
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "RegionTokenTable.h"
+
+#include <algorithm>
+#include <string.h>
+
+#include <infinity/queues/QueuePair.h>
+#include <infinity/requests/RequestToken.h>
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace memory {
+
+RegionTokenTable::RegionTokenTable(
+    std::shared_ptr<infinity::core::Context> context, uint32_t numberOfTokens)
+    : buffer(Buffer::createBuffer(context, getSizeInBytes(numberOfTokens))),
+      numberOfTokens(numberOfTokens) {
+
+  // The header makes the table self-describing for the reading side
+  uint32_t header[2] = {numberOfTokens, RegionToken::SERIALIZED_SIZE_IN_BYTES};
+  memcpy(this->buffer->getData(), header, HEADER_SIZE_IN_BYTES);
+  memset(getEntry(0), 0,
+         static_cast<uint64_t>(numberOfTokens) *
+             RegionToken::SERIALIZED_SIZE_IN_BYTES);
+}
+
+RegionTokenTable::RegionTokenTable(
+    std::shared_ptr<infinity::core::Context> context,
+    const std::vector<RegionToken> &tokens)
+    : RegionTokenTable(context, static_cast<uint32_t>(tokens.size())) {
+
+  for (uint32_t i = 0; i < this->numberOfTokens; ++i) {
+    setToken(i, tokens[i]);
+  }
+}
+
+RegionTokenTable::RegionTokenTable(std::shared_ptr<Buffer> buffer)
+    : buffer(buffer) {
+
+  INFINITY_ASSERT(buffer->getSizeInBytes() >= HEADER_SIZE_IN_BYTES,
+                  "[INFINITY][MEMORY][TOKENTABLE] Table is too small.\n");
+
+  uint32_t header[2];
+  memcpy(header, buffer->getData(), HEADER_SIZE_IN_BYTES);
+  INFINITY_ASSERT(header[1] == RegionToken::SERIALIZED_SIZE_IN_BYTES,
+                  "[INFINITY][MEMORY][TOKENTABLE] Unknown token size %u.\n",
+                  header[1]);
+  INFINITY_ASSERT(getSizeInBytes(header[0]) <= buffer->getSizeInBytes(),
+                  "[INFINITY][MEMORY][TOKENTABLE] Table with %u tokens is "
+                  "truncated.\n",
+                  header[0]);
+  this->numberOfTokens = header[0];
+}
+
+std::unique_ptr<RegionTokenTable> RegionTokenTable::fetch(
+    std::shared_ptr<infinity::core::Context> context,
+    const std::shared_ptr<infinity::queues::QueuePair> &queuePair,
+    const RegionToken &tableToken) {
+
+  uint64_t sizeInBytes = tableToken.getSizeInBytes();
+  std::shared_ptr<Buffer> buffer = Buffer::createBuffer(context, sizeInBytes);
+
+  // Read in chunks, a single read is limited to 32 bit lengths. Unsignaled
+  // reads only leave the send queue when a later signaled one completes, so
+  // every half queue and the last chunk are waited for.
+  uint32_t batchSize = std::max(queuePair->getSendQueueDepth() / 2, 1u);
+  infinity::requests::RequestToken requestToken(context);
+  uint32_t chunk = 0;
+  for (uint64_t offset = 0; offset < sizeInBytes;
+       offset += READ_CHUNK_SIZE_IN_BYTES, ++chunk) {
+    uint32_t length = static_cast<uint32_t>(std::min<uint64_t>(
+        READ_CHUNK_SIZE_IN_BYTES, sizeInBytes - offset));
+    bool signaled = offset + length == sizeInBytes ||
+                    (chunk + 1) % batchSize == 0;
+    queuePair->read(buffer, offset, tableToken, offset, length,
+                    infinity::queues::OperationFlags(),
+                    signaled ? &requestToken : nullptr);
+    if (signaled) {
+      requestToken.waitUntilCompleted();
+      INFINITY_ASSERT(requestToken.wasSuccessful(),
+                      "[INFINITY][MEMORY][TOKENTABLE] Reading table failed. "
+                      "%s.\n",
+                      requestToken.getStatusString());
+    }
+  }
+
+  return std::unique_ptr<RegionTokenTable>(new RegionTokenTable(buffer));
+}
+
+void RegionTokenTable::setToken(uint32_t index, const RegionToken &token) {
+  INFINITY_ASSERT(index < this->numberOfTokens,
+                  "[INFINITY][MEMORY][TOKENTABLE] Token %u does not exist.\n",
+                  index);
+  token.serialize(getEntry(index));
+}
+
+RegionToken RegionTokenTable::getToken(uint32_t index) {
+  INFINITY_ASSERT(index < this->numberOfTokens,
+                  "[INFINITY][MEMORY][TOKENTABLE] Token %u does not exist.\n",
+                  index);
+  return RegionToken::deserialize(getEntry(index));
+}
+
+uint32_t RegionTokenTable::getNumberOfTokens() { return this->numberOfTokens; }
+
+RegionToken RegionTokenTable::createRegionToken() {
+  return this->buffer->createRegionToken();
+}
+
+std::shared_ptr<Buffer> RegionTokenTable::getBuffer() { return this->buffer; }
+
+uint64_t RegionTokenTable::getSizeInBytes(uint32_t numberOfTokens) {
+  return HEADER_SIZE_IN_BYTES + static_cast<uint64_t>(numberOfTokens) *
+                                    RegionToken::SERIALIZED_SIZE_IN_BYTES;
+}
+
+char *RegionTokenTable::getEntry(uint32_t index) {
+  return reinterpret_cast<char *>(this->buffer->getData()) +
+         HEADER_SIZE_IN_BYTES +
+         static_cast<uint64_t>(index) * RegionToken::SERIALIZED_SIZE_IN_BYTES;
+}
+
+} /* namespace memory */
+} /* namespace infinity */
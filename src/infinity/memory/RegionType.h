@@ -15,6 +15,7 @@ namespace memory {
 enum RegionType {
   BUFFER,
   ATOMIC,
+  WINDOW,
   UNKNOWN
 };
 
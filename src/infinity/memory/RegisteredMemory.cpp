@@ -12,6 +12,8 @@
 #include <string.h>
 
 #include <infinity/core/Configuration.h>
+#include <infinity/memory/FileMapping.h>
+#include <infinity/memory/ParallelRegistration.h>
 #include <infinity/utils/Debug.h>
 
 namespace infinity {
@@ -34,8 +36,7 @@ RegisteredMemory::RegisteredMemory(infinity::core::Context *context,
 
   this->ibvMemoryRegion = ibv_reg_mr(
       this->context->getProtectionDomain(), this->data, this->sizeInBytes,
-      IBV_ACCESS_REMOTE_WRITE | IBV_ACCESS_LOCAL_WRITE |
-          IBV_ACCESS_REMOTE_READ);
+      this->context->getMemoryAccessFlags());
   INFINITY_ASSERT(this->ibvMemoryRegion != nullptr,
                   "[INFINITY][MEMORY][REGISTERED] Registration failed.\n");
 }
@@ -51,19 +52,78 @@ RegisteredMemory::RegisteredMemory(infinity::core::Context *context, void *data,
 
   this->ibvMemoryRegion = ibv_reg_mr(
       this->context->getProtectionDomain(), this->data, this->sizeInBytes,
-      IBV_ACCESS_REMOTE_WRITE | IBV_ACCESS_LOCAL_WRITE |
-          IBV_ACCESS_REMOTE_READ);
+      this->context->getMemoryAccessFlags());
   INFINITY_ASSERT(this->ibvMemoryRegion != nullptr,
                   "[INFINITY][MEMORY][REGISTERED] Registration failed.\n");
 }
 
+RegisteredMemory::RegisteredMemory(infinity::core::Context *context,
+                                   uint64_t sizeInBytes,
+                                   uint64_t chunkSizeInBytes,
+                                   uint32_t numberOfThreads) {
+
+  this->context = context;
+  this->sizeInBytes = sizeInBytes;
+  this->memoryAllocated = true;
+
+  int res = posix_memalign(
+      &(this->data), infinity::core::Configuration::PAGE_SIZE, sizeInBytes);
+  INFINITY_ASSERT(
+      res == 0,
+      "[INFINITY][MEMORY][REGISTERED] Cannot allocate and align buffer.\n");
+
+  this->chunkMemoryRegions = ParallelRegistration::registerChunks(
+      this->context, this->data, this->sizeInBytes, chunkSizeInBytes,
+      numberOfThreads, true,
+      this->context->getMemoryAccessFlags());
+  this->chunkSizeInBytes = chunkSizeInBytes;
+  this->ibvMemoryRegion = this->chunkMemoryRegions[0];
+}
+
+std::unique_ptr<RegisteredMemory>
+RegisteredMemory::createFromFile(infinity::core::Context *context,
+                                 const char *path, bool writable,
+                                 bool populate, bool prefault) {
+  return std::unique_ptr<RegisteredMemory>(new RegisteredMemory(
+      context, path, writable, populate, prefault, FileToken()));
+}
+
+RegisteredMemory::RegisteredMemory(infinity::core::Context *context,
+                                   const char *path, bool writable,
+                                   bool populate, bool prefault, FileToken) {
+
+  this->context = context;
+  this->memoryAllocated = false;
+
+  this->data = FileMapping::map(path, writable, populate, prefault,
+                                this->sizeInBytes);
+
+  this->ibvMemoryRegion =
+      ibv_reg_mr(this->context->getProtectionDomain(), this->data,
+                 this->sizeInBytes, FileMapping::getAccessFlags(writable));
+  if (this->ibvMemoryRegion == nullptr) {
+    FileMapping::unmap(this->data, this->sizeInBytes);
+  }
+  INFINITY_ASSERT(this->ibvMemoryRegion != nullptr,
+                  "[INFINITY][MEMORY][REGISTERED] Registration failed.\n");
+
+  this->memoryMapped = true;
+}
+
 RegisteredMemory::~RegisteredMemory() {
 
-  ibv_dereg_mr(this->ibvMemoryRegion);
+  if (this->chunkSizeInBytes != 0) {
+    ParallelRegistration::deregisterChunks(this->chunkMemoryRegions);
+  } else {
+    ibv_dereg_mr(this->ibvMemoryRegion);
+  }
 
   if (this->memoryAllocated) {
     free(this->data);
   }
+  if (this->memoryMapped) {
+    FileMapping::unmap(this->data, this->sizeInBytes);
+  }
 }
 
 void *RegisteredMemory::getData() { return this->data; }
@@ -72,5 +132,16 @@ uint64_t RegisteredMemory::getSizeInBytes() { return this->sizeInBytes; }
 
 ibv_mr *RegisteredMemory::getRegion() { return this->ibvMemoryRegion; }
 
+ibv_mr *RegisteredMemory::getRegion(uint64_t offset) {
+  if (this->chunkSizeInBytes == 0) {
+    return this->ibvMemoryRegion;
+  }
+  return this->chunkMemoryRegions[offset / this->chunkSizeInBytes];
+}
+
+uint64_t RegisteredMemory::getChunkSizeInBytes() {
+  return this->chunkSizeInBytes;
+}
+
 } /* namespace pool */
 } /* namespace ivory */
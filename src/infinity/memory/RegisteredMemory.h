@@ -9,6 +9,9 @@
 #ifndef INFINITY_MEMORY_REGISTEREDMEMORY_H_
 #define INFINITY_MEMORY_REGISTEREDMEMORY_H_
 
+#include <memory>
+#include <vector>
+
 #include <infinity/core/Context.h>
 
 namespace infinity {
@@ -20,6 +23,22 @@ public:
   RegisteredMemory(infinity::core::Context *context, uint64_t sizeInBytes);
   RegisteredMemory(infinity::core::Context *context, void *data,
                    uint64_t sizeInBytes);
+
+  /**
+   * Registers the memory as one memory region per chunk, see
+   * ParallelRegistration
+   */
+  RegisteredMemory(infinity::core::Context *context, uint64_t sizeInBytes,
+                   uint64_t chunkSizeInBytes, uint32_t numberOfThreads = 0);
+
+  /**
+   * Maps and registers a file, see FileMapping
+   */
+  static std::unique_ptr<RegisteredMemory>
+  createFromFile(infinity::core::Context *context, const char *path,
+                 bool writable = false, bool populate = false,
+                 bool prefault = false);
+
   ~RegisteredMemory();
 
   void *getData();
@@ -27,12 +46,21 @@ public:
   uint64_t getSizeInBytes();
 
   ibv_mr *getRegion();
+  ibv_mr *getRegion(uint64_t offset);
+
+  uint64_t getChunkSizeInBytes();
 
   RegisteredMemory(const RegisteredMemory &) = delete;
   RegisteredMemory(const RegisteredMemory &&) = delete;
   RegisteredMemory &operator=(const RegisteredMemory &) = delete;
   RegisteredMemory &operator=(RegisteredMemory &&other) = delete;
 
+protected:
+  class FileToken {};
+
+  RegisteredMemory(infinity::core::Context *context, const char *path,
+                   bool writable, bool populate, bool prefault, FileToken);
+
 protected:
   infinity::core::Context *context = nullptr;
 
@@ -41,8 +69,12 @@ protected:
 
   ibv_mr *ibvMemoryRegion = nullptr;
 
+  std::vector<ibv_mr *> chunkMemoryRegions;
+  uint64_t chunkSizeInBytes = 0;
+
 protected:
   bool memoryAllocated = false;
+  bool memoryMapped = false;
 };
 
 } /* namespace infinity */
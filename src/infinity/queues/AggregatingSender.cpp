@@ -0,0 +1,190 @@
+/**
+ * Queues - Aggregating Sender
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "AggregatingSender.h"
+
+#include <string.h>
+
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace queues {
+
+namespace {
+
+const uint32_t HEADER_SIZE_IN_BYTES = sizeof(uint32_t);
+
+uint32_t padded(uint32_t sizeInBytes) { return (sizeInBytes + 3) & ~3u; }
+
+} /* namespace */
+
+AggregatingSender::AggregatingSender(
+    std::shared_ptr<infinity::core::Context> context,
+    std::shared_ptr<QueuePair> queuePair, uint32_t batchSizeInBytes,
+    uint32_t deadlineInMicroseconds, uint32_t numberOfStagingBuffers)
+    : context(context), queuePair(queuePair),
+      batchSizeInBytes(padded(batchSizeInBytes)),
+      deadline(deadlineInMicroseconds) {
+
+  INFINITY_ASSERT(this->batchSizeInBytes > 2 * HEADER_SIZE_IN_BYTES &&
+                      numberOfStagingBuffers > 0,
+                  "[INFINITY][QUEUES][AGGREGATOR] Batches of %u bytes in %u "
+                  "staging buffers cannot hold a message.\n",
+                  batchSizeInBytes, numberOfStagingBuffers);
+
+  for (uint32_t i = 0; i < numberOfStagingBuffers; ++i) {
+    this->stagingBuffers.push_back(infinity::memory::Buffer::createBuffer(
+        context, this->batchSizeInBytes));
+    this->tokens.emplace_back(new infinity::requests::RequestToken(context));
+  }
+  this->inFlight.resize(numberOfStagingBuffers, false);
+
+  startBatch();
+}
+
+AggregatingSender::~AggregatingSender() {
+  flush();
+  waitUntilCompleted();
+}
+
+void AggregatingSender::send(const void *data, uint32_t sizeInBytes) {
+
+  INFINITY_ASSERT(sizeInBytes <= getMaxMessageSize(),
+                  "[INFINITY][QUEUES][AGGREGATOR] Message of %u bytes does "
+                  "not fit into a batch of %u bytes.\n",
+                  sizeInBytes, this->batchSizeInBytes);
+
+  uint32_t recordSize = HEADER_SIZE_IN_BYTES + padded(sizeInBytes);
+  if (this->currentOffset + recordSize > this->batchSizeInBytes) {
+    flush();
+  }
+  if (this->currentNumberOfMessages == 0) {
+    this->batchStart = std::chrono::steady_clock::now();
+  }
+
+  char *batch = reinterpret_cast<char *>(
+      this->stagingBuffers[this->currentBuffer]->getData());
+  memcpy(batch + this->currentOffset, &sizeInBytes, HEADER_SIZE_IN_BYTES);
+  memcpy(batch + this->currentOffset + HEADER_SIZE_IN_BYTES, data,
+         sizeInBytes);
+  this->currentOffset += recordSize;
+  ++this->currentNumberOfMessages;
+  ++this->numberOfMessages;
+
+  if (this->currentOffset + HEADER_SIZE_IN_BYTES >= this->batchSizeInBytes) {
+    flush();
+  } else {
+    poll();
+  }
+}
+
+bool AggregatingSender::poll() {
+
+  if (this->currentNumberOfMessages == 0 ||
+      std::chrono::steady_clock::now() - this->batchStart < this->deadline) {
+    return false;
+  }
+  flush();
+  return true;
+}
+
+void AggregatingSender::flush() {
+
+  if (this->currentNumberOfMessages == 0) {
+    return;
+  }
+
+  std::shared_ptr<infinity::memory::Buffer> &buffer =
+      this->stagingBuffers[this->currentBuffer];
+  memcpy(buffer->getData(), &this->currentNumberOfMessages,
+         HEADER_SIZE_IN_BYTES);
+  this->queuePair->send(buffer, 0, this->currentOffset, OperationFlags(),
+                        this->tokens[this->currentBuffer].get());
+  this->inFlight[this->currentBuffer] = true;
+  ++this->numberOfBatches;
+
+  this->currentBuffer = (this->currentBuffer + 1) % this->stagingBuffers.size();
+  startBatch();
+}
+
+void AggregatingSender::waitUntilCompleted() {
+
+  for (uint32_t i = 0; i < this->stagingBuffers.size(); ++i) {
+    if (this->inFlight[i]) {
+      this->tokens[i]->waitUntilCompleted();
+      this->inFlight[i] = false;
+    }
+  }
+}
+
+void AggregatingSender::setDeadline(uint32_t deadlineInMicroseconds) {
+  this->deadline = std::chrono::microseconds(deadlineInMicroseconds);
+}
+
+uint32_t AggregatingSender::getDeadline() { return this->deadline.count(); }
+
+uint32_t AggregatingSender::getMaxMessageSize() {
+  return this->batchSizeInBytes - 2 * HEADER_SIZE_IN_BYTES;
+}
+
+uint64_t AggregatingSender::getNumberOfMessages() {
+  return this->numberOfMessages;
+}
+
+uint64_t AggregatingSender::getNumberOfBatches() {
+  return this->numberOfBatches;
+}
+
+void AggregatingSender::startBatch() {
+
+  // The staging buffer may still be read by an earlier send
+  if (this->inFlight[this->currentBuffer]) {
+    this->tokens[this->currentBuffer]->waitUntilCompleted();
+    this->inFlight[this->currentBuffer] = false;
+    INFINITY_ASSERT(this->tokens[this->currentBuffer]->wasSuccessful(),
+                    "[INFINITY][QUEUES][AGGREGATOR] Sending batch failed. "
+                    "%s.\n",
+                    this->tokens[this->currentBuffer]->getStatusString());
+  }
+  this->currentOffset = HEADER_SIZE_IN_BYTES;
+  this->currentNumberOfMessages = 0;
+}
+
+BatchIterator::BatchIterator(const void *data, uint32_t bytesWritten)
+    : data(reinterpret_cast<const char *>(data)), bytesWritten(bytesWritten) {
+
+  INFINITY_ASSERT(bytesWritten >= HEADER_SIZE_IN_BYTES,
+                  "[INFINITY][QUEUES][AGGREGATOR] Batch of %u bytes is too "
+                  "short.\n",
+                  bytesWritten);
+  memcpy(&this->numberOfMessages, this->data, HEADER_SIZE_IN_BYTES);
+  this->offset = HEADER_SIZE_IN_BYTES;
+}
+
+bool BatchIterator::next(const void *&message, uint32_t &sizeInBytes) {
+
+  if (this->message == this->numberOfMessages) {
+    return false;
+  }
+
+  memcpy(&sizeInBytes, this->data + this->offset, HEADER_SIZE_IN_BYTES);
+  INFINITY_ASSERT(this->offset + HEADER_SIZE_IN_BYTES + sizeInBytes <=
+                      this->bytesWritten,
+                  "[INFINITY][QUEUES][AGGREGATOR] Message %u of the batch "
+                  "exceeds the %u bytes received.\n",
+                  this->message, this->bytesWritten);
+  message = this->data + this->offset + HEADER_SIZE_IN_BYTES;
+  this->offset += HEADER_SIZE_IN_BYTES + padded(sizeInBytes);
+  ++this->message;
+  return true;
+}
+
+uint32_t BatchIterator::getNumberOfMessages() { return this->numberOfMessages; }
+
+} /* namespace queues */
+} /* namespace infinity */
@@ -0,0 +1,581 @@
+/**
+ * Queues - Connection Engine
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "ConnectionEngine.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <infinity/core/Configuration.h>
+#include <infinity/utils/Debug.h>
+
+#define MAX_EVENTS_PER_POLL 64
+
+namespace infinity {
+namespace queues {
+
+ConnectionEngine::ConnectionEngine(std::shared_ptr<QueuePairFactory> factory,
+                                   uint32_t timeoutInMilliseconds)
+    : factory(factory), timeout(timeoutInMilliseconds) {
+
+  this->epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+  INFINITY_ASSERT(this->epollDescriptor >= 0,
+                  "[INFINITY][QUEUES][ENGINE] Cannot create epoll instance. "
+                  "%s.\n",
+                  strerror(errno));
+
+  this->resolverEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  INFINITY_ASSERT(this->resolverEvent >= 0,
+                  "[INFINITY][QUEUES][ENGINE] Cannot create event. %s.\n",
+                  strerror(errno));
+
+  epoll_event event;
+  memset(&event, 0, sizeof(epoll_event));
+  event.events = EPOLLIN;
+  event.data.u64 = RESOLVER_EVENT_ID;
+  int32_t returnValue = epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD,
+                                  this->resolverEvent, &event);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][ENGINE] Cannot watch resolver event.\n");
+}
+
+ConnectionEngine::~ConnectionEngine() {
+
+  for (auto &entry : this->resolverThreads) {
+    entry.second.join();
+  }
+
+  for (auto &entry : this->handshakes) {
+    closeSocket(entry.second);
+  }
+
+  // The server socket belongs to the factory, hand it back unchanged
+  if (this->accepting) {
+    fcntl(this->factory->serverSocket, F_SETFL, this->serverSocketFlags);
+  }
+
+  close(this->resolverEvent);
+  close(this->epollDescriptor);
+}
+
+void ConnectionEngine::acceptConnections(void *userData,
+                                         uint32_t userDataSizeInBytes) {
+
+  INFINITY_ASSERT(
+      userDataSizeInBytes <
+          infinity::core::Configuration::MAX_CONNECTION_USER_DATA_SIZE,
+      "[INFINITY][QUEUES][ENGINE] User data size is too large.\n");
+  INFINITY_ASSERT(this->factory->serverSocket >= 0,
+                  "[INFINITY][QUEUES][ENGINE] Factory is not bound to a "
+                  "port.\n");
+  INFINITY_ASSERT(!this->accepting,
+                  "[INFINITY][QUEUES][ENGINE] Already accepting "
+                  "connections.\n");
+
+  this->acceptUserData.assign(reinterpret_cast<char *>(userData),
+                              reinterpret_cast<char *>(userData) +
+                                  userDataSizeInBytes);
+
+  int32_t serverSocket = this->factory->serverSocket;
+  this->serverSocketFlags = fcntl(serverSocket, F_GETFL);
+  fcntl(serverSocket, F_SETFL, this->serverSocketFlags | O_NONBLOCK);
+
+  epoll_event event;
+  memset(&event, 0, sizeof(epoll_event));
+  event.events = EPOLLIN;
+  event.data.u64 = SERVER_SOCKET_ID;
+  int32_t returnValue =
+      epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, serverSocket, &event);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][ENGINE] Cannot watch server socket.\n");
+
+  this->accepting = true;
+}
+
+uint64_t ConnectionEngine::connect(const char *hostAddress, uint16_t port,
+                                   void *userData,
+                                   uint32_t userDataSizeInBytes,
+                                   const QueuePairOptions *options) {
+
+  INFINITY_ASSERT(
+      userDataSizeInBytes <
+          infinity::core::Configuration::MAX_CONNECTION_USER_DATA_SIZE,
+      "[INFINITY][QUEUES][ENGINE] User data size is too large.\n");
+
+  uint64_t id = this->nextHandshakeId++;
+  handshake_t &handshake = this->handshakes[id];
+  handshake.id = id;
+  handshake.passive = false;
+  handshake.hostAddress = hostAddress;
+  handshake.port = port;
+  handshake.deadline = std::chrono::steady_clock::now() + this->timeout;
+  this->deadlines.emplace_back(handshake.deadline, id);
+
+  handshake.queuePair = this->factory->createQueuePair(options);
+  prepareSendBuffer(handshake, userData, userDataSizeInBytes);
+
+  // Numeric addresses and known hosts do not need the resolver
+  in_addr address;
+  if (inet_pton(AF_INET, hostAddress, &address) == 1) {
+    startConnect(handshake, address);
+    return id;
+  }
+  auto cached = this->resolvedHosts.find(handshake.hostAddress);
+  if (cached != this->resolvedHosts.end()) {
+    if (cached->second.expires > std::chrono::steady_clock::now()) {
+      startConnect(handshake, cached->second.address);
+      return id;
+    }
+    this->resolvedHosts.erase(cached);
+  }
+
+  std::vector<uint64_t> &waiting = this->waitingForHost[handshake.hostAddress];
+  waiting.push_back(id);
+  if (waiting.size() == 1) {
+    this->resolverThreads.emplace(
+        handshake.hostAddress,
+        std::thread(&ConnectionEngine::resolve, this, handshake.hostAddress));
+  }
+  return id;
+}
+
+uint32_t ConnectionEngine::poll(int32_t timeoutInMilliseconds) {
+
+  this->readyInLastPoll = 0;
+
+  epoll_event events[MAX_EVENTS_PER_POLL];
+  int32_t numberOfEvents = epoll_wait(this->epollDescriptor, events,
+                                      MAX_EVENTS_PER_POLL,
+                                      timeoutInMilliseconds);
+  INFINITY_ASSERT(numberOfEvents >= 0 || errno == EINTR,
+                  "[INFINITY][QUEUES][ENGINE] Waiting for events failed. "
+                  "%s.\n",
+                  strerror(errno));
+
+  for (int32_t i = 0; i < numberOfEvents; ++i) {
+    uint64_t id = events[i].data.u64;
+    if (id == SERVER_SOCKET_ID) {
+      acceptPending();
+      continue;
+    }
+    if (id == RESOLVER_EVENT_ID) {
+      resolved();
+      continue;
+    }
+    auto it = this->handshakes.find(id);
+    if (it == this->handshakes.end()) {
+      continue;
+    }
+    int32_t result = progress(it->second);
+    if (result != 0) {
+      finish(id, result < 0);
+    }
+  }
+
+  expireHandshakes();
+
+  return this->readyInLastPoll;
+}
+
+void ConnectionEngine::setReadyCallback(ReadyCallback callback) {
+  this->readyCallback = callback;
+}
+
+bool ConnectionEngine::getReadyQueuePair(
+    std::shared_ptr<QueuePair> &queuePair) {
+  if (this->readyQueuePairs.empty()) {
+    return false;
+  }
+  queuePair = this->readyQueuePairs.front();
+  this->readyQueuePairs.pop_front();
+  return true;
+}
+
+uint32_t ConnectionEngine::getNumberOfPendingHandshakes() {
+  return static_cast<uint32_t>(this->handshakes.size());
+}
+
+uint64_t ConnectionEngine::getNumberOfFailedHandshakes() {
+  return this->failedHandshakes;
+}
+
+void ConnectionEngine::acceptPending() {
+
+  while (true) {
+    int32_t connectionSocket =
+        accept4(this->factory->serverSocket, nullptr, nullptr,
+                SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (connectionSocket < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        INFINITY_DEBUG("[INFINITY][QUEUES][ENGINE] Cannot accept "
+                       "connection. %s.\n",
+                       strerror(errno));
+      }
+      return;
+    }
+
+    uint64_t id = this->nextHandshakeId++;
+    handshake_t &handshake = this->handshakes[id];
+    handshake.id = id;
+    handshake.passive = true;
+    handshake.state = RECEIVING;
+    handshake.socket = connectionSocket;
+    handshake.deadline = std::chrono::steady_clock::now() + this->timeout;
+    this->deadlines.emplace_back(handshake.deadline, id);
+    watch(handshake, EPOLLIN);
+  }
+}
+
+void ConnectionEngine::resolve(std::string hostAddress) {
+
+  resolution_t resolution;
+  resolution.hostAddress = hostAddress;
+
+  addrinfo hints;
+  memset(&hints, 0, sizeof(addrinfo));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo *result = nullptr;
+  if (getaddrinfo(hostAddress.c_str(), nullptr, &hints, &result) == 0 &&
+      result != nullptr) {
+    resolution.resolved = true;
+    resolution.address =
+        reinterpret_cast<sockaddr_in *>(result->ai_addr)->sin_addr;
+  }
+  if (result != nullptr) {
+    freeaddrinfo(result);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->resolverMutex);
+    this->resolverResults.push_back(resolution);
+  }
+  uint64_t value = 1;
+  ssize_t returnValue = write(this->resolverEvent, &value, sizeof(uint64_t));
+  (void)returnValue;
+}
+
+void ConnectionEngine::resolved() {
+
+  uint64_t value;
+  ssize_t returnValue = read(this->resolverEvent, &value, sizeof(uint64_t));
+  (void)returnValue;
+
+  std::vector<resolution_t> results;
+  {
+    std::lock_guard<std::mutex> lock(this->resolverMutex);
+    results.swap(this->resolverResults);
+  }
+
+  for (const resolution_t &resolution : results) {
+
+    // The thread has reported its result and is about to exit
+    auto thread = this->resolverThreads.find(resolution.hostAddress);
+    if (thread != this->resolverThreads.end()) {
+      thread->second.join();
+      this->resolverThreads.erase(thread);
+    }
+
+    if (resolution.resolved) {
+      cached_host_t &cached = this->resolvedHosts[resolution.hostAddress];
+      cached.address = resolution.address;
+      cached.expires =
+          std::chrono::steady_clock::now() +
+          std::chrono::milliseconds(RESOLVED_HOST_TTL_IN_MILLISECONDS);
+    } else {
+      INFINITY_DEBUG("[INFINITY][QUEUES][ENGINE] Unable to get IP address "
+                     "for %s.\n",
+                     resolution.hostAddress.c_str());
+    }
+
+    std::vector<uint64_t> waiting;
+    waiting.swap(this->waitingForHost[resolution.hostAddress]);
+    this->waitingForHost.erase(resolution.hostAddress);
+
+    // Handshakes may have timed out while waiting
+    for (uint64_t id : waiting) {
+      auto it = this->handshakes.find(id);
+      if (it == this->handshakes.end()) {
+        continue;
+      }
+      if (resolution.resolved) {
+        startConnect(it->second, resolution.address);
+      } else {
+        finish(id, true);
+      }
+    }
+  }
+}
+
+void ConnectionEngine::startConnect(handshake_t &handshake,
+                                    const in_addr &address) {
+
+  sockaddr_in remoteAddress;
+  memset(&(remoteAddress), 0, sizeof(sockaddr_in));
+  remoteAddress.sin_family = AF_INET;
+  remoteAddress.sin_addr = address;
+  remoteAddress.sin_port = htons(handshake.port);
+
+  handshake.socket =
+      socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  INFINITY_ASSERT(
+      handshake.socket >= 0,
+      "[INFINITY][QUEUES][ENGINE] Cannot open connection socket.\n");
+
+  int32_t returnValue =
+      ::connect(handshake.socket, reinterpret_cast<sockaddr *>(&remoteAddress),
+                sizeof(sockaddr_in));
+  if (returnValue == 0) {
+    handshake.state = SENDING;
+  } else if (errno == EINPROGRESS) {
+    handshake.state = CONNECTING;
+  } else {
+    INFINITY_DEBUG("[INFINITY][QUEUES][ENGINE] Could not connect to %s. "
+                   "%s.\n",
+                   handshake.hostAddress.c_str(), strerror(errno));
+    // Fail from the next poll, the caller may still hold a reference
+    handshake.state = CONNECTING;
+  }
+  watch(handshake, EPOLLOUT);
+}
+
+int32_t ConnectionEngine::progress(handshake_t &handshake) {
+
+  switch (handshake.state) {
+
+  case RESOLVING:
+    return 0;
+
+  case CONNECTING: {
+    int32_t socketError = 0;
+    socklen_t length = sizeof(socketError);
+    if (getsockopt(handshake.socket, SOL_SOCKET, SO_ERROR, &socketError,
+                   &length) != 0 ||
+        socketError != 0) {
+      return -1;
+    }
+    handshake.state = SENDING;
+  }
+  /* fall through */
+
+  case SENDING: {
+    int32_t result = sendPending(handshake);
+    if (result <= 0 || handshake.passive) {
+      return result;
+    }
+    handshake.state = RECEIVING;
+    watch(handshake, EPOLLIN);
+    return 0;
+  }
+
+  case RECEIVING: {
+    int32_t result = receivePending(handshake);
+    if (result <= 0) {
+      return result;
+    }
+
+    if (!handshake.passive) {
+      this->factory->pairQueuePair(
+          handshake.queuePair,
+          handshake.sendBuffer.size() - sizeof(serializedQueuePair),
+          handshake.remoteQueuePair, handshake.remoteUserData);
+      return 1;
+    }
+
+    // The passive side is ready to receive before it replies
+    uint32_t userDataSize = this->acceptUserData.size();
+    if (handshake.remoteQueuePair.reconnect) {
+      handshake.queuePair =
+          this->factory->findReconnectingQueuePair(handshake.remoteQueuePair);
+    }
+    if (handshake.queuePair != nullptr) {
+      handshake.queuePair->recover();
+    } else {
+      handshake.queuePair = this->factory->createQueuePair(nullptr);
+    }
+    this->factory->pairQueuePair(handshake.queuePair, userDataSize,
+                                 handshake.remoteQueuePair,
+                                 handshake.remoteUserData);
+    prepareSendBuffer(handshake, this->acceptUserData.data(), userDataSize);
+    handshake.state = SENDING;
+    watch(handshake, EPOLLOUT);
+    return progress(handshake);
+  }
+  }
+
+  return -1;
+}
+
+int32_t ConnectionEngine::sendPending(handshake_t &handshake) {
+
+  while (handshake.bytesSent < handshake.sendBuffer.size()) {
+    ssize_t returnValue =
+        send(handshake.socket, &handshake.sendBuffer[handshake.bytesSent],
+             handshake.sendBuffer.size() - handshake.bytesSent, MSG_NOSIGNAL);
+    if (returnValue > 0) {
+      handshake.bytesSent += returnValue;
+    } else if (returnValue < 0 && errno == EINTR) {
+      continue;
+    } else if (returnValue < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return 0;
+    } else {
+      return -1;
+    }
+  }
+  return 1;
+}
+
+int32_t ConnectionEngine::receivePending(handshake_t &handshake) {
+
+  const uint32_t headerSize = sizeof(serializedQueuePair);
+
+  while (true) {
+
+    char *target;
+    uint32_t remaining;
+    if (handshake.bytesReceived < headerSize) {
+      target = reinterpret_cast<char *>(&handshake.remoteQueuePair) +
+               handshake.bytesReceived;
+      remaining = headerSize - handshake.bytesReceived;
+    } else {
+      uint32_t userDataSize = handshake.remoteQueuePair.userDataSize;
+      if (userDataSize >=
+          infinity::core::Configuration::MAX_CONNECTION_USER_DATA_SIZE) {
+        return -1;
+      }
+      handshake.remoteUserData.resize(userDataSize);
+      uint32_t offset = handshake.bytesReceived - headerSize;
+      if (offset == userDataSize) {
+        return 1;
+      }
+      target = &handshake.remoteUserData[offset];
+      remaining = userDataSize - offset;
+    }
+
+    ssize_t returnValue = recv(handshake.socket, target, remaining, 0);
+    if (returnValue > 0) {
+      handshake.bytesReceived += returnValue;
+    } else if (returnValue < 0 && errno == EINTR) {
+      continue;
+    } else if (returnValue < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return 0;
+    } else {
+      return -1;
+    }
+  }
+}
+
+void ConnectionEngine::prepareSendBuffer(handshake_t &handshake,
+                                         void *userData,
+                                         uint32_t userDataSizeInBytes) {
+
+  serializedQueuePair header;
+  QueuePairFactory::describeQueuePair(handshake.queuePair, userDataSizeInBytes,
+                                      header);
+
+  handshake.sendBuffer.resize(sizeof(serializedQueuePair) +
+                              userDataSizeInBytes);
+  memcpy(&handshake.sendBuffer[0], &header, sizeof(serializedQueuePair));
+  if (userDataSizeInBytes > 0) {
+    memcpy(&handshake.sendBuffer[sizeof(serializedQueuePair)], userData,
+           userDataSizeInBytes);
+  }
+  handshake.bytesSent = 0;
+}
+
+void ConnectionEngine::watch(handshake_t &handshake, uint32_t events) {
+
+  if (handshake.events == events) {
+    return;
+  }
+
+  epoll_event event;
+  memset(&event, 0, sizeof(epoll_event));
+  event.events = events;
+  event.data.u64 = handshake.id;
+  int32_t returnValue =
+      epoll_ctl(this->epollDescriptor,
+                handshake.events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD,
+                handshake.socket, &event);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][ENGINE] Cannot watch socket. %s.\n",
+                  strerror(errno));
+  handshake.events = events;
+}
+
+void ConnectionEngine::closeSocket(handshake_t &handshake) {
+  if (handshake.socket >= 0) {
+    close(handshake.socket);
+    handshake.socket = -1;
+  }
+}
+
+void ConnectionEngine::finish(uint64_t handshakeId, bool failed) {
+
+  auto it = this->handshakes.find(handshakeId);
+  if (it == this->handshakes.end()) {
+    return;
+  }
+
+  closeSocket(it->second);
+  uint64_t id = it->second.passive ? 0 : handshakeId;
+
+  // The host may have moved, resolve it again on the next connect
+  if (failed && !it->second.passive) {
+    this->resolvedHosts.erase(it->second.hostAddress);
+  }
+  std::shared_ptr<QueuePair> queuePair;
+  if (!failed) {
+    queuePair = it->second.queuePair;
+  }
+
+  // The callback may start new handshakes
+  this->handshakes.erase(it);
+
+  if (failed) {
+    ++this->failedHandshakes;
+    INFINITY_DEBUG("[INFINITY][QUEUES][ENGINE] Handshake %lu failed.\n",
+                   handshakeId);
+  } else {
+    ++this->readyInLastPoll;
+  }
+
+  if (this->readyCallback) {
+    this->readyCallback(id, queuePair);
+  } else if (queuePair != nullptr) {
+    this->readyQueuePairs.push_back(queuePair);
+  }
+}
+
+void ConnectionEngine::expireHandshakes() {
+
+  // All handshakes have the same timeout, deadlines are in order
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  while (!this->deadlines.empty() && this->deadlines.front().first <= now) {
+    uint64_t id = this->deadlines.front().second;
+    this->deadlines.pop_front();
+    if (this->handshakes.find(id) != this->handshakes.end()) {
+      INFINITY_DEBUG("[INFINITY][QUEUES][ENGINE] Handshake %lu timed out.\n",
+                     id);
+      finish(id, true);
+    }
+  }
+}
+
+} /* namespace queues */
+} /* namespace infinity */
@@ -0,0 +1,186 @@
+/**
+ * Queues - Connection Engine
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef QUEUES_CONNECTIONENGINE_H_
+#define QUEUES_CONNECTIONENGINE_H_
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <netinet/in.h>
+
+#include <infinity/core/Context.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/queues/QueuePairFactory.h>
+
+namespace infinity {
+namespace queues {
+
+/**
+ * Non-blocking connection setup. Runs many handshakes concurrently from a
+ * single epoll loop driven by poll(). The wire format is the one of
+ * QueuePairFactory, so the engine can talk to blocking peers. Host names
+ * are resolved on helper threads and cached.
+ */
+class ConnectionEngine {
+
+public:
+  /**
+   * Called with the id returned by connect() (0 for accepted connections)
+   * and the ready queue pair, or nullptr if the handshake failed
+   */
+  typedef std::function<void(uint64_t handshakeId,
+                             std::shared_ptr<QueuePair> queuePair)>
+  ReadyCallback;
+
+public:
+  ConnectionEngine(std::shared_ptr<QueuePairFactory> factory,
+                   uint32_t timeoutInMilliseconds = 5000);
+  ~ConnectionEngine();
+
+  ConnectionEngine(const ConnectionEngine &) = delete;
+  ConnectionEngine(const ConnectionEngine &&) = delete;
+  ConnectionEngine &operator=(const ConnectionEngine &) = delete;
+  ConnectionEngine &operator=(ConnectionEngine &&) = delete;
+
+public:
+  /**
+   * Accept connections on the socket of the factory, which needs to be
+   * bound already. userData is sent to every client.
+   */
+  void acceptConnections(void *userData = nullptr,
+                         uint32_t userDataSizeInBytes = 0);
+
+  /**
+   * Start connecting to a remote host, returns the id of the handshake.
+   * Without options, the queue pair uses the options of the factory.
+   */
+  uint64_t connect(const char *hostAddress, uint16_t port,
+                   void *userData = nullptr, uint32_t userDataSizeInBytes = 0,
+                   const QueuePairOptions *options = nullptr);
+
+  /**
+   * Make progress on all handshakes, waits at most timeoutInMilliseconds
+   * for events. Returns the number of queue pairs that became ready.
+   */
+  uint32_t poll(int32_t timeoutInMilliseconds = 0);
+
+public:
+  /**
+   * Without a callback, ready queue pairs are queued
+   */
+  void setReadyCallback(ReadyCallback callback);
+  bool getReadyQueuePair(std::shared_ptr<QueuePair> &queuePair);
+
+  uint32_t getNumberOfPendingHandshakes();
+  uint64_t getNumberOfFailedHandshakes();
+
+protected:
+  static const uint64_t SERVER_SOCKET_ID = UINT64_MAX;
+  static const uint64_t RESOLVER_EVENT_ID = UINT64_MAX - 1;
+  static const uint32_t RESOLVED_HOST_TTL_IN_MILLISECONDS = 60000;
+
+  enum HandshakeState { RESOLVING, CONNECTING, SENDING, RECEIVING };
+
+  typedef struct {
+    uint64_t id = 0;
+    bool passive = false;
+    HandshakeState state = RESOLVING;
+    int32_t socket = -1;
+    uint32_t events = 0;
+    std::chrono::steady_clock::time_point deadline;
+
+    std::string hostAddress;
+    uint16_t port = 0;
+
+    std::shared_ptr<QueuePair> queuePair;
+
+    std::vector<char> sendBuffer;
+    uint32_t bytesSent = 0;
+
+    serializedQueuePair remoteQueuePair;
+    std::vector<char> remoteUserData;
+    uint32_t bytesReceived = 0;
+  } handshake_t;
+
+protected:
+  void acceptPending();
+  void resolved();
+  void resolve(std::string hostAddress);
+  void startConnect(handshake_t &handshake, const in_addr &address);
+
+  /**
+   * Returns 1 if the handshake completed, -1 if it failed and 0 otherwise
+   */
+  int32_t progress(handshake_t &handshake);
+  int32_t sendPending(handshake_t &handshake);
+  int32_t receivePending(handshake_t &handshake);
+
+  void prepareSendBuffer(handshake_t &handshake, void *userData,
+                         uint32_t userDataSizeInBytes);
+  void watch(handshake_t &handshake, uint32_t events);
+  void closeSocket(handshake_t &handshake);
+  void finish(uint64_t handshakeId, bool failed);
+  void expireHandshakes();
+
+protected:
+  std::shared_ptr<QueuePairFactory> factory;
+  std::chrono::milliseconds timeout;
+
+  int32_t epollDescriptor = -1;
+  int32_t resolverEvent = -1;
+  bool accepting = false;
+  int32_t serverSocketFlags = 0;
+  std::vector<char> acceptUserData;
+
+  uint64_t nextHandshakeId = 1;
+  std::unordered_map<uint64_t, handshake_t> handshakes;
+  std::deque<std::pair<std::chrono::steady_clock::time_point, uint64_t> >
+  deadlines;
+  uint64_t failedHandshakes = 0;
+
+  ReadyCallback readyCallback;
+  std::deque<std::shared_ptr<QueuePair> > readyQueuePairs;
+  uint32_t readyInLastPoll = 0;
+
+protected:
+  /**
+   * Host name cache, lookups run on helper threads and report back through
+   * resolverEvent. Entries expire after RESOLVED_HOST_TTL_IN_MILLISECONDS
+   * and are dropped when a connection to the host fails.
+   */
+  typedef struct {
+    std::string hostAddress;
+    bool resolved = false;
+    in_addr address;
+  } resolution_t;
+
+  typedef struct {
+    in_addr address;
+    std::chrono::steady_clock::time_point expires;
+  } cached_host_t;
+
+  std::unordered_map<std::string, cached_host_t> resolvedHosts;
+  std::unordered_map<std::string, std::vector<uint64_t> > waitingForHost;
+
+  std::mutex resolverMutex;
+  std::vector<resolution_t> resolverResults;
+  std::unordered_map<std::string, std::thread> resolverThreads;
+};
+
+} /* namespace queues */
+} /* namespace infinity */
+
+#endif /* QUEUES_CONNECTIONENGINE_H_ */
@@ -0,0 +1,402 @@
+/**
+ * Queues - Datagram Queue Pair
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "DatagramQueuePair.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <string.h>
+
+#include <infinity/core/Configuration.h>
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace queues {
+
+DatagramQueuePair::DatagramQueuePair(
+    std::shared_ptr<infinity::core::Context> context,
+    const QueuePairOptions &options, uint32_t receiveQueueDepth,
+    uint32_t queueKey)
+    : context(context), options(options), queueKey(queueKey) {
+
+  const ibv_device_attr &deviceAttributes = context->getDeviceAttributes();
+  uint32_t sendQueueLength =
+      this->options.sendQueueDepth != 0
+          ? std::min<uint32_t>(this->options.sendQueueDepth,
+                               deviceAttributes.max_qp_wr)
+          : infinity::core::Configuration::sendQueueLength(context);
+  receiveQueueDepth = std::max(
+      std::min<uint32_t>(receiveQueueDepth, deviceAttributes.max_qp_wr), 1u);
+
+  // Datagrams are limited to the MTU of the port
+  uint8_t mtu = context->getActiveMtu();
+  if (this->options.pathMtu != 0) {
+    mtu = std::min(mtu, this->options.pathMtu);
+  }
+  this->maxMessageSize = 128u << mtu;
+
+  this->ibvReceiveCompletionQueue =
+      ibv_create_cq(context->getInfiniBandContext(), receiveQueueDepth,
+                    nullptr, nullptr, 0);
+  INFINITY_ASSERT(this->ibvReceiveCompletionQueue != nullptr,
+                  "[INFINITY][QUEUES][DATAGRAM] Cannot create receive "
+                  "completion queue.\n");
+
+  ibv_qp_init_attr qpInitAttributes;
+  memset(&qpInitAttributes, 0, sizeof(qpInitAttributes));
+  qpInitAttributes.send_cq = context->getSendCompletionQueue();
+  qpInitAttributes.recv_cq = this->ibvReceiveCompletionQueue;
+  qpInitAttributes.cap.max_send_wr = std::max(sendQueueLength, 1u);
+  qpInitAttributes.cap.max_send_sge = 1;
+  qpInitAttributes.cap.max_recv_wr = receiveQueueDepth;
+  qpInitAttributes.cap.max_recv_sge = 1;
+  qpInitAttributes.cap.max_inline_data = this->options.maxInlineData;
+  qpInitAttributes.qp_type = IBV_QPT_UD;
+  qpInitAttributes.sq_sig_all = 0;
+
+  this->ibvQueuePair =
+      ibv_create_qp(context->getProtectionDomain(), &qpInitAttributes);
+  INFINITY_ASSERT(this->ibvQueuePair != nullptr,
+                  "[INFINITY][QUEUES][DATAGRAM] Cannot create queue pair.\n");
+
+  this->sendQueueDepth = qpInitAttributes.cap.max_send_wr;
+  this->maxInlineData = qpInitAttributes.cap.max_inline_data;
+  context->attachQueuePair(this->sendQueueDepth, 1, this->maxInlineData);
+
+  // Datagram queue pairs need no remote side and go to RTS right away
+  ibv_qp_attr qpAttributes;
+  memset(&qpAttributes, 0, sizeof(qpAttributes));
+  qpAttributes.qp_state = IBV_QPS_INIT;
+  qpAttributes.pkey_index = 0;
+  qpAttributes.port_num = context->getDevicePort();
+  qpAttributes.qkey = this->queueKey;
+  int32_t returnValue =
+      ibv_modify_qp(this->ibvQueuePair, &qpAttributes,
+                    IBV_QP_STATE | IBV_QP_PKEY_INDEX | IBV_QP_PORT |
+                        IBV_QP_QKEY);
+  INFINITY_ASSERT(
+      returnValue == 0,
+      "[INFINITY][QUEUES][DATAGRAM] Cannot transition to INIT state.\n");
+
+  memset(&qpAttributes, 0, sizeof(qpAttributes));
+  qpAttributes.qp_state = IBV_QPS_RTR;
+  returnValue = ibv_modify_qp(this->ibvQueuePair, &qpAttributes, IBV_QP_STATE);
+  INFINITY_ASSERT(
+      returnValue == 0,
+      "[INFINITY][QUEUES][DATAGRAM] Cannot transition to RTR state.\n");
+
+  qpAttributes.qp_state = IBV_QPS_RTS;
+  qpAttributes.sq_psn = QueuePair::randomSequenceNumber();
+  returnValue = ibv_modify_qp(this->ibvQueuePair, &qpAttributes,
+                              IBV_QP_STATE | IBV_QP_SQ_PSN);
+  INFINITY_ASSERT(
+      returnValue == 0,
+      "[INFINITY][QUEUES][DATAGRAM] Cannot transition to RTS state.\n");
+}
+
+DatagramQueuePair::~DatagramQueuePair() noexcept(false) {
+
+  for (auto &entry : this->addressHandles) {
+    ibv_destroy_ah(entry.second);
+  }
+
+  int32_t returnValue = ibv_destroy_qp(this->ibvQueuePair);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][DATAGRAM] Cannot delete queue pair.\n");
+  this->context->detachQueuePair(this->sendQueueDepth, 1,
+                                 this->maxInlineData);
+
+  returnValue = ibv_destroy_cq(this->ibvReceiveCompletionQueue);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][DATAGRAM] Cannot delete receive "
+                  "completion queue.\n");
+}
+
+datagram_address_t DatagramQueuePair::getAddress() {
+
+  datagram_address_t address;
+  address.localDeviceId = this->context->getLocalDeviceId();
+  address.queuePairNumber = this->ibvQueuePair->qp_num;
+  address.queueKey = this->queueKey;
+  if (this->options.globalRouting || this->context->isEthernet()) {
+    ibv_gid gid = this->context->getGid(this->options.gidIndex);
+    address.global = 1;
+    memcpy(address.gid, gid.raw, sizeof(address.gid));
+  }
+  return address;
+}
+
+uint32_t DatagramQueuePair::getQueuePairNumber() {
+  return this->ibvQueuePair->qp_num;
+}
+
+uint32_t DatagramQueuePair::getMaxMessageSize() {
+  return this->maxMessageSize;
+}
+
+void DatagramQueuePair::postReceiveBuffer(
+    const std::shared_ptr<infinity::memory::Buffer> &buffer) {
+
+  INFINITY_ASSERT(buffer->getSizeInBytes() > ROUTING_HEADER_SIZE_IN_BYTES &&
+                      buffer->getSizeInBytes() <= UINT32_MAX,
+                  "[INFINITY][QUEUES][DATAGRAM] Receive buffer needs room "
+                  "for the routing header.\n");
+
+  ibv_sge sgElement;
+  memset(&sgElement, 0, sizeof(ibv_sge));
+  sgElement.addr = buffer->getAddress();
+  sgElement.length = static_cast<uint32_t>(buffer->getSizeInBytes());
+  sgElement.lkey = buffer->getLocalKey();
+
+  ibv_recv_wr workRequest;
+  memset(&workRequest, 0, sizeof(ibv_recv_wr));
+  workRequest.wr_id = reinterpret_cast<uint64_t>(buffer.get());
+  workRequest.sg_list = &sgElement;
+  workRequest.num_sge = 1;
+
+  ibv_recv_wr *badWorkRequest;
+  int32_t returnValue =
+      ibv_post_recv(this->ibvQueuePair, &workRequest, &badWorkRequest);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][DATAGRAM] Cannot post receive buffer. "
+                  "%s.\n",
+                  strerror(returnValue));
+}
+
+bool DatagramQueuePair::receive(datagram_element_t &element) {
+
+  ibv_wc wc;
+  if (ibv_poll_cq(this->ibvReceiveCompletionQueue, 1, &wc) <= 0) {
+    return false;
+  }
+
+  auto receiveBuffer = reinterpret_cast<infinity::memory::Buffer *>(wc.wr_id);
+  INFINITY_ASSERT(wc.status == IBV_WC_SUCCESS,
+                  "[INFINITY][QUEUES][DATAGRAM] Receive failed. %s.\n",
+                  ibv_wc_status_str(wc.status));
+
+  element.buffer = receiveBuffer->getptr();
+  element.data = reinterpret_cast<char *>(receiveBuffer->getData()) +
+                 ROUTING_HEADER_SIZE_IN_BYTES;
+  element.bytesWritten = wc.byte_len - ROUTING_HEADER_SIZE_IN_BYTES;
+
+  if (wc.wc_flags & IBV_WC_WITH_IMM) {
+    element.immediateValue = ntohl(wc.imm_data);
+    element.immediateValueValid = true;
+  } else {
+    element.immediateValue = 0;
+    element.immediateValueValid = false;
+  }
+
+  element.source = datagram_address_t();
+  element.source.localDeviceId = wc.slid;
+  element.source.queuePairNumber = wc.src_qp;
+  element.source.queueKey = this->queueKey;
+
+  // The verbs library knows where the source GID is for each transport
+  if (wc.wc_flags & IBV_WC_GRH) {
+    ibv_ah_attr attributes;
+    memset(&attributes, 0, sizeof(ibv_ah_attr));
+    int32_t returnValue = ibv_init_ah_from_wc(
+        this->context->getInfiniBandContext(), this->context->getDevicePort(),
+        &wc, reinterpret_cast<ibv_grh *>(receiveBuffer->getData()),
+        &attributes);
+    if (returnValue == 0 && attributes.is_global) {
+      element.source.global = 1;
+      memcpy(element.source.gid, attributes.grh.dgid.raw,
+             sizeof(element.source.gid));
+    }
+  }
+
+  return true;
+}
+
+void DatagramQueuePair::send(
+    const datagram_address_t &destination,
+    const std::shared_ptr<infinity::memory::Buffer> &buffer,
+    infinity::requests::RequestToken *requestToken) {
+  postSend(destination, buffer, 0, buffer->getSizeInBytes(), false, 0,
+           requestToken);
+}
+
+void DatagramQueuePair::send(
+    const datagram_address_t &destination,
+    const std::shared_ptr<infinity::memory::Buffer> &buffer,
+    uint64_t localOffset, uint32_t sizeInBytes,
+    infinity::requests::RequestToken *requestToken) {
+  postSend(destination, buffer, localOffset, sizeInBytes, false, 0,
+           requestToken);
+}
+
+void DatagramQueuePair::sendWithImmediate(
+    const datagram_address_t &destination,
+    const std::shared_ptr<infinity::memory::Buffer> &buffer,
+    uint64_t localOffset, uint32_t sizeInBytes, uint32_t immediateValue,
+    infinity::requests::RequestToken *requestToken) {
+  postSend(destination, buffer, localOffset, sizeInBytes, true,
+           immediateValue, requestToken);
+}
+
+uint32_t DatagramQueuePair::sendSegmented(
+    const datagram_address_t &destination,
+    const std::shared_ptr<infinity::memory::Buffer> &buffer,
+    uint64_t localOffset, uint32_t sizeInBytes,
+    infinity::requests::RequestToken *requestToken) {
+
+  uint32_t numberOfSegments = std::max(
+      (sizeInBytes + this->maxMessageSize - 1) / this->maxMessageSize, 1u);
+  INFINITY_ASSERT(numberOfSegments <= 0xFFFF,
+                  "[INFINITY][QUEUES][DATAGRAM] Message of %u bytes has too "
+                  "many segments.\n",
+                  sizeInBytes);
+
+  // Unsignaled sends only leave the send queue when a later signaled one
+  // completes, so every half queue one segment is waited for. Without a
+  // request token, the last segment is waited for as well, nothing stays
+  // unsignaled after the call.
+  uint32_t batchSize = std::max(this->sendQueueDepth / 2, 1u);
+  infinity::requests::RequestToken batchToken(this->context);
+
+  for (uint32_t segment = 0; segment < numberOfSegments; ++segment) {
+    uint32_t offset = segment * this->maxMessageSize;
+    uint32_t size = std::min(this->maxMessageSize, sizeInBytes - offset);
+    uint32_t immediateValue = (numberOfSegments << 16) | segment;
+    if (segment + 1 == numberOfSegments && requestToken != nullptr) {
+      postSend(destination, buffer, localOffset + offset, size, true,
+               immediateValue, requestToken);
+    } else if (segment + 1 == numberOfSegments ||
+               (segment + 1) % batchSize == 0) {
+      postSend(destination, buffer, localOffset + offset, size, true,
+               immediateValue, &batchToken);
+      batchToken.waitUntilCompleted();
+    } else {
+      postSend(destination, buffer, localOffset + offset, size, true,
+               immediateValue, nullptr);
+    }
+  }
+
+  return numberOfSegments;
+}
+
+uint32_t DatagramQueuePair::getSegmentIndex(uint32_t immediateValue) {
+  return immediateValue & 0xFFFF;
+}
+
+uint32_t DatagramQueuePair::getNumberOfSegments(uint32_t immediateValue) {
+  return immediateValue >> 16;
+}
+
+uint32_t DatagramQueuePair::getNumberOfAddressHandles() {
+  return this->addressHandles.size();
+}
+
+ibv_ah *
+DatagramQueuePair::getAddressHandle(const datagram_address_t &destination) {
+
+  address_key_t key;
+  memcpy(&key.gidHigh, destination.gid, sizeof(uint64_t));
+  memcpy(&key.gidLow, destination.gid + sizeof(uint64_t), sizeof(uint64_t));
+  key.localDeviceId = destination.localDeviceId;
+
+  auto cached = this->addressHandles.find(key);
+  if (cached != this->addressHandles.end()) {
+    return cached->second;
+  }
+
+  ibv_ah_attr attributes;
+  memset(&attributes, 0, sizeof(ibv_ah_attr));
+  attributes.dlid = destination.localDeviceId;
+  attributes.sl = this->options.serviceLevel;
+  attributes.src_path_bits = 0;
+  attributes.port_num = this->context->getDevicePort();
+  if (destination.global || this->options.globalRouting ||
+      this->context->isEthernet()) {
+    attributes.is_global = 1;
+    memcpy(attributes.grh.dgid.raw, destination.gid,
+           sizeof(attributes.grh.dgid.raw));
+    attributes.grh.sgid_index = this->options.gidIndex;
+    attributes.grh.flow_label = this->options.flowLabel & 0xFFFFF;
+    attributes.grh.hop_limit = this->options.hopLimit;
+    attributes.grh.traffic_class = this->options.trafficClass;
+  }
+
+  ibv_ah *addressHandle =
+      ibv_create_ah(this->context->getProtectionDomain(), &attributes);
+  INFINITY_ASSERT(addressHandle != nullptr,
+                  "[INFINITY][QUEUES][DATAGRAM] Cannot create address handle "
+                  "for %u.\n",
+                  destination.localDeviceId);
+
+  this->addressHandles.insert({key, addressHandle});
+  return addressHandle;
+}
+
+void DatagramQueuePair::postSend(
+    const datagram_address_t &destination,
+    const std::shared_ptr<infinity::memory::Buffer> &buffer,
+    uint64_t localOffset, uint32_t sizeInBytes, bool withImmediate,
+    uint32_t immediateValue, infinity::requests::RequestToken *requestToken) {
+
+  INFINITY_ASSERT(sizeInBytes <= this->maxMessageSize,
+                  "[INFINITY][QUEUES][DATAGRAM] Message of %u bytes is larger "
+                  "than the MTU (%u bytes).\n",
+                  sizeInBytes, this->maxMessageSize);
+  INFINITY_ASSERT(sizeInBytes <= buffer->getRemainingSizeInBytes(localOffset),
+                  "[INFINITY][QUEUES][DATAGRAM] Segmentation fault while "
+                  "creating scatter-getter element.\n");
+
+  if (requestToken != nullptr) {
+    requestToken->reset();
+    requestToken->setRegion(buffer);
+    if (withImmediate) {
+      requestToken->setImmediateValue(immediateValue);
+    }
+  }
+
+  ibv_sge sgElement;
+  memset(&sgElement, 0, sizeof(ibv_sge));
+  sgElement.addr = buffer->getAddress() + localOffset;
+  sgElement.length = sizeInBytes;
+  sgElement.lkey = buffer->getLocalKey(localOffset);
+
+  ibv_send_wr workRequest;
+  memset(&workRequest, 0, sizeof(ibv_send_wr));
+  workRequest.wr_id = reinterpret_cast<uint64_t>(requestToken);
+  workRequest.sg_list = &sgElement;
+  workRequest.num_sge = 1;
+  if (withImmediate) {
+    workRequest.opcode = IBV_WR_SEND_WITH_IMM;
+    workRequest.imm_data = htonl(immediateValue);
+  } else {
+    workRequest.opcode = IBV_WR_SEND;
+  }
+  if (requestToken != nullptr) {
+    workRequest.send_flags |= IBV_SEND_SIGNALED;
+  }
+  if (sizeInBytes <= this->maxInlineData) {
+    workRequest.send_flags |= IBV_SEND_INLINE;
+  }
+  workRequest.wr.ud.ah = getAddressHandle(destination);
+  workRequest.wr.ud.remote_qpn = destination.queuePairNumber;
+  workRequest.wr.ud.remote_qkey = destination.queueKey;
+
+  ibv_send_wr *badWorkRequest;
+  int32_t returnValue =
+      ibv_post_send(this->ibvQueuePair, &workRequest, &badWorkRequest);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][DATAGRAM] Posting send request failed. "
+                  "%s.\n",
+                  strerror(returnValue));
+
+  INFINITY_DEBUG("[INFINITY][QUEUES][DATAGRAM] Send request created (id "
+                 "%lu).\n",
+                 workRequest.wr_id);
+}
+
+} /* namespace queues */
+} /* namespace infinity */
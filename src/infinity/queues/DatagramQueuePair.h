@@ -0,0 +1,176 @@
+/**
+ * Queues - Datagram Queue Pair
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef QUEUES_DATAGRAMQUEUEPAIR_H_
+#define QUEUES_DATAGRAMQUEUEPAIR_H_
+
+#include <memory>
+#include <stdint.h>
+#include <unordered_map>
+#include <infiniband/verbs.h>
+
+#include <infinity/core/Context.h>
+#include <infinity/memory/Buffer.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/requests/RequestToken.h>
+
+namespace infinity {
+namespace queues {
+
+/**
+ * Address of a datagram queue pair. Plain data, can be sent to peers as
+ * is.
+ */
+typedef struct {
+  uint16_t localDeviceId = 0;
+  uint8_t global = 0;
+  uint32_t queuePairNumber = 0;
+  uint32_t queueKey = 0;
+  uint8_t gid[16] = {};
+} datagram_address_t;
+
+/**
+ * A received datagram. data points behind the routing header into buffer,
+ * source can be used to reply.
+ */
+typedef struct {
+  std::shared_ptr<infinity::memory::Buffer> buffer;
+  void *data = nullptr;
+  uint32_t bytesWritten = 0;
+  uint32_t immediateValue = 0;
+  bool immediateValueValid = false;
+  datagram_address_t source;
+} datagram_element_t;
+
+/**
+ * Unreliable datagram queue pair. A single queue pair talks to any number
+ * of peers, address handles are created on first use and cached. Messages
+ * are limited to the MTU of the port and may be lost or reordered.
+ *
+ * Sends complete on the send completion queue of the context, so request
+ * tokens work as for connected queue pairs. Receives use a completion and
+ * receive queue of their own, every datagram is preceded by a 40 byte
+ * routing header which must not end up in the shared receive queue.
+ */
+class DatagramQueuePair {
+
+public:
+  static const uint32_t ROUTING_HEADER_SIZE_IN_BYTES = 40;
+  static const uint32_t DEFAULT_QUEUE_KEY = 0x11111111;
+
+public:
+  DatagramQueuePair(std::shared_ptr<infinity::core::Context> context,
+                    const QueuePairOptions &options = QueuePairOptions(),
+                    uint32_t receiveQueueDepth = 1024,
+                    uint32_t queueKey = DEFAULT_QUEUE_KEY);
+  ~DatagramQueuePair() noexcept(false);
+
+  DatagramQueuePair(const DatagramQueuePair &) = delete;
+  DatagramQueuePair(const DatagramQueuePair &&) = delete;
+  DatagramQueuePair &operator=(const DatagramQueuePair &) = delete;
+  DatagramQueuePair &operator=(DatagramQueuePair &&) = delete;
+
+public:
+  datagram_address_t getAddress();
+  uint32_t getQueuePairNumber();
+
+  /**
+   * Largest message which fits into a single datagram
+   */
+  uint32_t getMaxMessageSize();
+
+public:
+  /**
+   * Receive buffers need room for the routing header and a message
+   */
+  void
+  postReceiveBuffer(const std::shared_ptr<infinity::memory::Buffer> &buffer);
+  bool receive(datagram_element_t &element);
+
+public:
+  void send(const datagram_address_t &destination,
+            const std::shared_ptr<infinity::memory::Buffer> &buffer,
+            infinity::requests::RequestToken *requestToken = nullptr);
+  void send(const datagram_address_t &destination,
+            const std::shared_ptr<infinity::memory::Buffer> &buffer,
+            uint64_t localOffset, uint32_t sizeInBytes,
+            infinity::requests::RequestToken *requestToken = nullptr);
+  void sendWithImmediate(
+      const datagram_address_t &destination,
+      const std::shared_ptr<infinity::memory::Buffer> &buffer,
+      uint64_t localOffset, uint32_t sizeInBytes, uint32_t immediateValue,
+      infinity::requests::RequestToken *requestToken = nullptr);
+
+public:
+  /**
+   * Sends a message of any size as datagrams of at most
+   * getMaxMessageSize() bytes. Each segment carries its index and the
+   * number of segments as immediate value, the receiver places segment i
+   * at i * getMaxMessageSize(). Only the last segment completes the
+   * request token, without one the call waits for the last segment.
+   * Returns the number of segments.
+   */
+  uint32_t
+  sendSegmented(const datagram_address_t &destination,
+                const std::shared_ptr<infinity::memory::Buffer> &buffer,
+                uint64_t localOffset, uint32_t sizeInBytes,
+                infinity::requests::RequestToken *requestToken = nullptr);
+
+  static uint32_t getSegmentIndex(uint32_t immediateValue);
+  static uint32_t getNumberOfSegments(uint32_t immediateValue);
+
+public:
+  uint32_t getNumberOfAddressHandles();
+
+protected:
+  typedef struct {
+    uint64_t gidHigh;
+    uint64_t gidLow;
+    uint16_t localDeviceId;
+  } address_key_t;
+
+  struct AddressKeyHash {
+    size_t operator()(const address_key_t &key) const {
+      return key.gidHigh * 31 + key.gidLow * 17 + key.localDeviceId;
+    }
+  };
+
+  struct AddressKeyEqual {
+    bool operator()(const address_key_t &a, const address_key_t &b) const {
+      return a.gidHigh == b.gidHigh && a.gidLow == b.gidLow &&
+             a.localDeviceId == b.localDeviceId;
+    }
+  };
+
+protected:
+  ibv_ah *getAddressHandle(const datagram_address_t &destination);
+  void postSend(const datagram_address_t &destination,
+                const std::shared_ptr<infinity::memory::Buffer> &buffer,
+                uint64_t localOffset, uint32_t sizeInBytes,
+                bool withImmediate, uint32_t immediateValue,
+                infinity::requests::RequestToken *requestToken);
+
+protected:
+  std::shared_ptr<infinity::core::Context> context;
+  QueuePairOptions options;
+  uint32_t queueKey = 0;
+  uint32_t maxMessageSize = 0;
+  uint32_t sendQueueDepth = 0;
+  uint32_t maxInlineData = 0;
+
+  ibv_cq *ibvReceiveCompletionQueue = nullptr;
+  ibv_qp *ibvQueuePair = nullptr;
+
+  std::unordered_map<address_key_t, ibv_ah *, AddressKeyHash,
+                     AddressKeyEqual> addressHandles;
+};
+
+} /* namespace queues */
+} /* namespace infinity */
+
+#endif /* QUEUES_DATAGRAMQUEUEPAIR_H_ */
@@ -0,0 +1,196 @@
+/**
+ * Queues - Mesh Bootstrap
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "MeshBootstrap.h"
+
+#include <string.h>
+
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace queues {
+
+/**
+ * Record of a rank: header followed by one entry per peer
+ */
+typedef struct {
+
+  uint32_t rank = 0;
+  uint32_t firstPeer = 0;
+  uint32_t numberOfEntries = 0;
+  uint16_t localDeviceId = 0;
+  uint8_t gid[16] = {};
+  uint32_t sharedReceiveQueueNumber = 0;
+
+} serializedMeshHeader;
+
+typedef struct {
+
+  uint32_t queuePairNumber = 0;
+  uint32_t sequenceNumber = 0;
+  uint8_t maxReadAtomic = 0;
+  uint8_t maxDestReadAtomic = 0;
+  uint8_t pathMtu = 0;
+  uint32_t targetQueuePairNumber = 0;
+
+} serializedMeshEntry;
+
+MeshBootstrap::MeshBootstrap(
+    std::shared_ptr<infinity::core::Context> context,
+    std::shared_ptr<infinity::utils::RendezvousStore> store, uint32_t rank,
+    uint32_t numberOfRanks, bool lazy, uint32_t timeoutInMilliseconds,
+    const QueuePairOptions &options)
+    : context(context), store(store), rank(rank),
+      numberOfRanks(numberOfRanks), lazy(lazy),
+      timeoutInMilliseconds(timeoutInMilliseconds), options(options),
+      queuePairs(numberOfRanks), connected(numberOfRanks, false) {
+
+  INFINITY_ASSERT(rank < numberOfRanks,
+                  "[INFINITY][QUEUES][MESH] Rank %u is not part of a mesh of "
+                  "%u ranks.\n",
+                  rank, numberOfRanks);
+}
+
+void MeshBootstrap::connect() {
+
+  if (this->lazy) {
+    return;
+  }
+
+  // Queue pairs are created back to back before anything is exchanged
+  for (uint32_t peer = 0; peer < this->numberOfRanks; ++peer) {
+    if (peer != this->rank) {
+      this->queuePairs[peer] =
+          std::make_shared<QueuePair>(this->context, this->options);
+    }
+  }
+
+  publish("mesh-" + std::to_string(this->rank), 0, this->numberOfRanks);
+  for (uint32_t peer = 0; peer < this->numberOfRanks; ++peer) {
+    if (peer != this->rank) {
+      pair("mesh-" + std::to_string(peer), peer, this->rank);
+    }
+  }
+
+  // No rank starts sending before all ranks are ready to receive
+  this->store->put("ready-" + std::to_string(this->rank),
+                   std::vector<char>());
+  std::vector<char> value;
+  for (uint32_t peer = 0; peer < this->numberOfRanks; ++peer) {
+    this->store->waitFor("ready-" + std::to_string(peer), value,
+                         this->timeoutInMilliseconds);
+  }
+
+  INFINITY_DEBUG("[INFINITY][QUEUES][MESH] Rank %u connected to %u ranks.\n",
+                 this->rank, this->numberOfRanks - 1);
+}
+
+std::shared_ptr<QueuePair> MeshBootstrap::getQueuePair(uint32_t rank) {
+
+  INFINITY_ASSERT(rank < this->numberOfRanks && rank != this->rank,
+                  "[INFINITY][QUEUES][MESH] No queue pair to rank %u.\n",
+                  rank);
+
+  if (!this->connected[rank]) {
+    INFINITY_ASSERT(this->lazy,
+                    "[INFINITY][QUEUES][MESH] Mesh is not connected.\n");
+    this->queuePairs[rank] =
+        std::make_shared<QueuePair>(this->context, this->options);
+    publish("pair-" + std::to_string(this->rank) + "-" + std::to_string(rank),
+            rank, 1);
+    pair("pair-" + std::to_string(rank) + "-" + std::to_string(this->rank),
+         rank, 0);
+  }
+
+  return this->queuePairs[rank];
+}
+
+bool MeshBootstrap::isConnected(uint32_t rank) {
+  return rank < this->numberOfRanks && this->connected[rank];
+}
+
+uint32_t MeshBootstrap::getRank() { return this->rank; }
+
+uint32_t MeshBootstrap::getNumberOfRanks() { return this->numberOfRanks; }
+
+void MeshBootstrap::publish(const std::string &key, uint32_t firstPeer,
+                            uint32_t numberOfPeers) {
+
+  serializedMeshHeader header;
+  header.rank = this->rank;
+  header.firstPeer = firstPeer;
+  header.numberOfEntries = numberOfPeers;
+  header.localDeviceId = this->context->getLocalDeviceId();
+  ibv_gid gid = this->context->getGid(this->options.gidIndex);
+  memcpy(header.gid, gid.raw, sizeof(header.gid));
+  header.sharedReceiveQueueNumber =
+      this->context->getSharedReceiveQueueNumber();
+
+  std::vector<char> value(sizeof(serializedMeshHeader) +
+                          numberOfPeers * sizeof(serializedMeshEntry));
+  memcpy(&value[0], &header, sizeof(serializedMeshHeader));
+
+  serializedMeshEntry *entries = reinterpret_cast<serializedMeshEntry *>(
+      &value[sizeof(serializedMeshHeader)]);
+  for (uint32_t i = 0; i < numberOfPeers; ++i) {
+    std::shared_ptr<QueuePair> &queuePair = this->queuePairs[firstPeer + i];
+    if (queuePair != nullptr) {
+      entries[i].queuePairNumber = queuePair->getQueuePairNumber();
+      entries[i].sequenceNumber = queuePair->getSequenceNumber();
+      entries[i].maxReadAtomic = queuePair->getOptions().maxReadAtomic;
+      entries[i].maxDestReadAtomic = queuePair->getOptions().maxDestReadAtomic;
+      entries[i].pathMtu = queuePair->getOptions().pathMtu;
+      entries[i].targetQueuePairNumber =
+          queuePair->getTargetQueuePairNumber();
+    }
+  }
+
+  this->store->put(key, value);
+}
+
+void MeshBootstrap::pair(const std::string &key, uint32_t peer,
+                         uint32_t entryIndex) {
+
+  std::vector<char> value;
+  this->store->waitFor(key, value, this->timeoutInMilliseconds);
+
+  serializedMeshHeader header;
+  INFINITY_ASSERT(value.size() >= sizeof(serializedMeshHeader),
+                  "[INFINITY][QUEUES][MESH] Record %s is truncated.\n",
+                  key.c_str());
+  memcpy(&header, &value[0], sizeof(serializedMeshHeader));
+  INFINITY_ASSERT(header.rank == peer && entryIndex < header.numberOfEntries &&
+                      value.size() >=
+                          sizeof(serializedMeshHeader) +
+                              header.numberOfEntries *
+                                  sizeof(serializedMeshEntry),
+                  "[INFINITY][QUEUES][MESH] Record %s is invalid.\n",
+                  key.c_str());
+
+  serializedMeshEntry entry;
+  memcpy(&entry,
+         &value[sizeof(serializedMeshHeader) +
+                entryIndex * sizeof(serializedMeshEntry)],
+         sizeof(serializedMeshEntry));
+
+  ibv_gid remoteGid;
+  memcpy(remoteGid.raw, header.gid, sizeof(remoteGid.raw));
+  QueuePairOptions remoteOptions;
+  remoteOptions.maxReadAtomic = entry.maxReadAtomic;
+  remoteOptions.maxDestReadAtomic = entry.maxDestReadAtomic;
+  remoteOptions.pathMtu = entry.pathMtu;
+  QueuePair::registerRemote(this->queuePairs[peer], this->context,
+                            header.localDeviceId, entry.queuePairNumber,
+                            entry.sequenceNumber, &remoteGid, &remoteOptions,
+                            entry.targetQueuePairNumber,
+                            header.sharedReceiveQueueNumber);
+  this->connected[peer] = true;
+}
+
+} /* namespace queues */
+} /* namespace infinity */
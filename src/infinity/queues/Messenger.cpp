@@ -0,0 +1,272 @@
+/**
+ * Queues - Messenger
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "Messenger.h"
+
+#include <string.h>
+
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace queues {
+
+namespace {
+
+// The two upper bits of the immediate value carry the message type, the
+// lower bits the rendezvous slot of an acknowledgement
+const uint32_t TYPE_MASK = 0x3u << 30;
+const uint32_t TYPE_EAGER = 0x1u << 30;
+const uint32_t TYPE_RENDEZVOUS = 0x2u << 30;
+const uint32_t TYPE_ACKNOWLEDGEMENT = 0x3u << 30;
+
+} /* namespace */
+
+Messenger::Messenger(std::shared_ptr<infinity::core::Context> context,
+                     uint32_t eagerThresholdInBytes,
+                     uint32_t maxOutstandingRendezvous)
+    : context(context), eagerThresholdInBytes(eagerThresholdInBytes),
+      acknowledgementToken(context) {
+
+  INFINITY_ASSERT(eagerThresholdInBytes >= sizeof(rendezvous_header_t),
+                  "[INFINITY][QUEUES][MESSENGER] Eager threshold of %u bytes "
+                  "cannot hold a rendezvous header of %lu bytes.\n",
+                  eagerThresholdInBytes, sizeof(rendezvous_header_t));
+  INFINITY_ASSERT(maxOutstandingRendezvous > 0 &&
+                      maxOutstandingRendezvous <= ~TYPE_MASK,
+                  "[INFINITY][QUEUES][MESSENGER] Invalid number of "
+                  "outstanding rendezvous %u.\n",
+                  maxOutstandingRendezvous);
+
+  this->headerBuffer = infinity::memory::Buffer::createBuffer(
+      context, maxOutstandingRendezvous * sizeof(rendezvous_header_t));
+  for (uint32_t i = 0; i < maxOutstandingRendezvous; ++i) {
+    this->headerTokens.emplace_back(
+        new infinity::requests::RequestToken(context));
+  }
+  this->outstanding.resize(maxOutstandingRendezvous,
+                           {false, false, nullptr, nullptr});
+  this->acknowledgementBuffer =
+      infinity::memory::Buffer::createBuffer(context, sizeof(uint32_t));
+}
+
+Messenger::~Messenger() {
+  if (this->acknowledgementInFlight) {
+    this->acknowledgementToken.waitUntilCompleted();
+  }
+  for (uint32_t i = 0; i < this->outstanding.size(); ++i) {
+    if (this->outstanding[i].headerInFlight) {
+      this->headerTokens[i]->waitUntilCompleted();
+    }
+  }
+}
+
+bool Messenger::send(std::shared_ptr<QueuePair> queuePair,
+                     const std::shared_ptr<infinity::memory::Buffer> &buffer,
+                     uint64_t localOffset, uint32_t sizeInBytes,
+                     infinity::requests::RequestToken *requestToken) {
+
+  if (sizeInBytes <= this->eagerThresholdInBytes) {
+    queuePair->sendWithImmediate(buffer, localOffset, sizeInBytes,
+                                 TYPE_EAGER, OperationFlags(), requestToken);
+    return true;
+  }
+
+  // Chunked buffers use one key per chunk, the token covers the chunk
+  // holding the message
+  infinity::memory::RegionToken source = buffer->createRegionToken(localOffset);
+  INFINITY_ASSERT(sizeInBytes <= source.getSizeInBytes(),
+                  "[INFINITY][QUEUES][MESSENGER] Message of %u bytes crosses "
+                  "a chunk boundary of the buffer.\n",
+                  sizeInBytes);
+
+  int32_t slot = findFreeSlot();
+  if (slot < 0) {
+    return false;
+  }
+
+  // The header send of the last rendezvous in this slot has been received,
+  // but its completion may not have been polled yet
+  outstanding_rendezvous_t &rendezvous = this->outstanding[slot];
+  if (rendezvous.headerInFlight) {
+    this->headerTokens[slot]->waitUntilCompleted();
+  }
+
+  rendezvous_header_t *header =
+      reinterpret_cast<rendezvous_header_t *>(this->headerBuffer->getData()) +
+      slot;
+  source.serialize(&header->source);
+  header->sizeInBytes = sizeInBytes;
+  header->slot = slot;
+
+  if (requestToken != nullptr) {
+    requestToken->reset();
+  }
+  rendezvous.inUse = true;
+  rendezvous.headerInFlight = true;
+  rendezvous.buffer = buffer;
+  rendezvous.requestToken = requestToken;
+  ++this->numberOfOutstanding;
+
+  queuePair->sendWithImmediate(this->headerBuffer,
+                               slot * sizeof(rendezvous_header_t),
+                               sizeof(rendezvous_header_t),
+                               TYPE_RENDEZVOUS | slot, OperationFlags(),
+                               this->headerTokens[slot].get());
+  return true;
+}
+
+bool Messenger::receive(message_t &message) {
+
+  if (!this->deferredMessages.empty()) {
+    message = this->deferredMessages.front();
+    this->deferredMessages.pop_front();
+    return true;
+  }
+  return poll(message);
+}
+
+void Messenger::fetch(message_t &message,
+                      const std::shared_ptr<infinity::memory::Buffer> &buffer,
+                      uint64_t localOffset) {
+
+  INFINITY_ASSERT(buffer->getRemainingSizeInBytes(localOffset) >=
+                      message.sizeInBytes,
+                  "[INFINITY][QUEUES][MESSENGER] Message of %u bytes does not "
+                  "fit into the destination buffer.\n",
+                  message.sizeInBytes);
+
+  if (message.buffer != nullptr) {
+    memcpy(reinterpret_cast<char *>(buffer->getData()) + localOffset,
+           message.buffer->getData(), message.sizeInBytes);
+  } else {
+    infinity::requests::RequestToken requestToken(this->context);
+    message.queuePair->read(
+        buffer, localOffset,
+        infinity::memory::RegionToken::deserialize(&message.header.source),
+        0, message.sizeInBytes, OperationFlags(),
+        &requestToken);
+    requestToken.waitUntilCompleted();
+    INFINITY_ASSERT(requestToken.wasSuccessful(),
+                    "[INFINITY][QUEUES][MESSENGER] Reading message of %u "
+                    "bytes failed. %s.\n",
+                    message.sizeInBytes, requestToken.getStatusString());
+  }
+
+  release(message);
+}
+
+void Messenger::release(message_t &message) {
+
+  if (message.buffer != nullptr) {
+    this->context->postReceiveBuffer(message.buffer);
+    message.buffer = nullptr;
+  } else {
+    acknowledge(message);
+  }
+}
+
+void Messenger::waitUntilCompleted(
+    infinity::requests::RequestToken *requestToken) {
+
+  message_t message;
+  while (!requestToken->checkIfCompleted()) {
+    if (poll(message)) {
+      this->deferredMessages.push_back(message);
+    }
+  }
+}
+
+uint32_t Messenger::getEagerThreshold() { return this->eagerThresholdInBytes; }
+
+uint32_t Messenger::getNumberOfOutstandingRendezvous() {
+  return this->numberOfOutstanding;
+}
+
+bool Messenger::poll(message_t &message) {
+
+  infinity::core::receive_element_t receiveElement;
+  while (this->context->receive(receiveElement)) {
+
+    INFINITY_ASSERT(receiveElement.immediateValueValid,
+                    "[INFINITY][QUEUES][MESSENGER] Received a message without "
+                    "immediate value.\n");
+    uint32_t type = receiveElement.immediateValue & TYPE_MASK;
+
+    if (type == TYPE_EAGER) {
+      message.queuePair = receiveElement.queuePair;
+      message.buffer = receiveElement.buffer;
+      message.sizeInBytes = receiveElement.bytesWritten;
+      return true;
+    }
+
+    if (type == TYPE_RENDEZVOUS) {
+      message.queuePair = receiveElement.queuePair;
+      message.buffer = nullptr;
+      memcpy(&message.header, receiveElement.buffer->getData(),
+             sizeof(rendezvous_header_t));
+      message.sizeInBytes = message.header.sizeInBytes;
+      this->context->postReceiveBuffer(receiveElement.buffer);
+      return true;
+    }
+
+    INFINITY_ASSERT(type == TYPE_ACKNOWLEDGEMENT,
+                    "[INFINITY][QUEUES][MESSENGER] Received a message of "
+                    "unknown type %u.\n",
+                    receiveElement.immediateValue >> 30);
+    uint32_t slot = receiveElement.immediateValue & ~TYPE_MASK;
+    INFINITY_ASSERT(slot < this->outstanding.size() &&
+                        this->outstanding[slot].inUse,
+                    "[INFINITY][QUEUES][MESSENGER] Acknowledgement for slot "
+                    "%u which is not outstanding.\n",
+                    slot);
+    outstanding_rendezvous_t &rendezvous = this->outstanding[slot];
+    if (rendezvous.requestToken != nullptr) {
+      rendezvous.requestToken->setStatus(IBV_WC_SUCCESS);
+    }
+    rendezvous.inUse = false;
+    rendezvous.buffer = nullptr;
+    rendezvous.requestToken = nullptr;
+    --this->numberOfOutstanding;
+    this->context->postReceiveBuffer(receiveElement.buffer);
+  }
+
+  return false;
+}
+
+void Messenger::acknowledge(message_t &message) {
+
+  // A single acknowledgement is in flight, the send queue never fills up
+  // with unsignaled requests
+  if (this->acknowledgementInFlight) {
+    this->acknowledgementToken.waitUntilCompleted();
+    INFINITY_ASSERT(this->acknowledgementToken.wasSuccessful(),
+                    "[INFINITY][QUEUES][MESSENGER] Sending acknowledgement "
+                    "failed. %s.\n",
+                    this->acknowledgementToken.getStatusString());
+  }
+  message.queuePair->sendWithImmediate(
+      this->acknowledgementBuffer, 0, sizeof(uint32_t),
+      TYPE_ACKNOWLEDGEMENT | message.header.slot, OperationFlags(),
+      &this->acknowledgementToken);
+  this->acknowledgementInFlight = true;
+}
+
+int32_t Messenger::findFreeSlot() {
+
+  for (uint32_t i = 0; i < this->outstanding.size(); ++i) {
+    uint32_t slot = (this->nextSlot + i) % this->outstanding.size();
+    if (!this->outstanding[slot].inUse) {
+      this->nextSlot = (slot + 1) % this->outstanding.size();
+      return slot;
+    }
+  }
+  return -1;
+}
+
+} /* namespace queues */
+} /* namespace infinity */
@@ -0,0 +1,186 @@
+/**
+ * Queues - Multi-Rail Queue Pair
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "MultiRailQueuePair.h"
+
+#include <algorithm>
+
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace queues {
+
+MultiRailQueuePair::MultiRailQueuePair(
+    std::shared_ptr<infinity::core::MultiRailContext> context,
+    const std::vector<std::shared_ptr<QueuePair> > &queuePairs)
+    : context(context), queuePairs(queuePairs) {
+
+  INFINITY_ASSERT(queuePairs.size() == context->getNumberOfRails(),
+                  "[INFINITY][QUEUES][MULTIRAIL] Expected one queue pair per "
+                  "rail, got %lu for %u rails.\n",
+                  queuePairs.size(), context->getNumberOfRails());
+
+  for (uint32_t rail = 0; rail < infinity::core::MultiRailContext::MAX_RAILS;
+       ++rail) {
+    this->bytesOutstanding[rail] = 0;
+    this->unsignaledBytes[rail] = 0;
+  }
+}
+
+uint32_t MultiRailQueuePair::getNumberOfRails() {
+  return this->queuePairs.size();
+}
+
+std::shared_ptr<QueuePair> MultiRailQueuePair::getQueuePair(uint32_t rail) {
+  return this->queuePairs.at(rail);
+}
+
+uint64_t MultiRailQueuePair::getBytesOutstanding(uint32_t rail) {
+  return this->bytesOutstanding[rail].load();
+}
+
+// The factory sends the number of rails ahead of the user data
+uint32_t MultiRailQueuePair::getUserDataSize() {
+  return this->queuePairs[0]->getUserDataSize() - sizeof(uint32_t);
+}
+
+void *MultiRailQueuePair::getUserData() {
+  return reinterpret_cast<char *>(this->queuePairs[0]->getUserData()) +
+         sizeof(uint32_t);
+}
+
+void MultiRailQueuePair::setStripeSize(uint32_t stripeSizeInBytes) {
+  this->stripeSizeInBytes = stripeSizeInBytes;
+}
+
+uint32_t MultiRailQueuePair::getStripeSize() {
+  return this->stripeSizeInBytes;
+}
+
+uint32_t MultiRailQueuePair::selectRail(int32_t numaNode) {
+
+  uint32_t selected = 0;
+  uint64_t selectedBytes = UINT64_MAX;
+  bool selectedLocal = false;
+  for (uint32_t rail = 0; rail < this->queuePairs.size(); ++rail) {
+    uint64_t bytes = this->bytesOutstanding[rail].load();
+    bool local = this->context->getNumaNode(rail) == numaNode;
+    if (bytes < selectedBytes ||
+        (bytes == selectedBytes && local && !selectedLocal)) {
+      selected = rail;
+      selectedBytes = bytes;
+      selectedLocal = local;
+    }
+  }
+  return selected;
+}
+
+void MultiRailQueuePair::send(
+    const std::shared_ptr<infinity::memory::MultiRailBuffer> &buffer,
+    uint64_t localOffset, uint32_t sizeInBytes,
+    infinity::requests::MultiRailRequestToken *requestToken) {
+
+  if (requestToken != nullptr) {
+    requestToken->reset(this);
+  }
+
+  uint32_t rail = this->selectRail(buffer->getNumaNode());
+  this->queuePairs[rail]->send(buffer->getBuffer(rail), localOffset,
+                               sizeInBytes, OperationFlags(),
+                               this->useRail(rail, sizeInBytes, requestToken));
+}
+
+void MultiRailQueuePair::write(
+    const std::shared_ptr<infinity::memory::MultiRailBuffer> &buffer,
+    uint64_t localOffset,
+    const infinity::memory::multi_rail_token_t &destination,
+    uint64_t remoteOffset, uint32_t sizeInBytes,
+    infinity::requests::MultiRailRequestToken *requestToken) {
+  this->transfer(true, buffer, localOffset, destination, remoteOffset,
+                 sizeInBytes, requestToken);
+}
+
+void MultiRailQueuePair::read(
+    const std::shared_ptr<infinity::memory::MultiRailBuffer> &buffer,
+    uint64_t localOffset, const infinity::memory::multi_rail_token_t &source,
+    uint64_t remoteOffset, uint32_t sizeInBytes,
+    infinity::requests::MultiRailRequestToken *requestToken) {
+  this->transfer(false, buffer, localOffset, source, remoteOffset,
+                 sizeInBytes, requestToken);
+}
+
+void MultiRailQueuePair::transfer(
+    bool isWrite,
+    const std::shared_ptr<infinity::memory::MultiRailBuffer> &buffer,
+    uint64_t localOffset, const infinity::memory::multi_rail_token_t &remote,
+    uint64_t remoteOffset, uint32_t sizeInBytes,
+    infinity::requests::MultiRailRequestToken *requestToken) {
+
+  INFINITY_ASSERT(remote.numberOfRails == this->queuePairs.size(),
+                  "[INFINITY][QUEUES][MULTIRAIL] Remote token has %u rails, "
+                  "queue pair has %lu.\n",
+                  remote.numberOfRails, this->queuePairs.size());
+
+  if (requestToken != nullptr) {
+    requestToken->reset(this);
+  }
+
+  // Small operations go to a single rail, large ones are split evenly
+  uint32_t numberOfParts = 1;
+  if (sizeInBytes >= this->stripeSizeInBytes) {
+    numberOfParts = this->queuePairs.size();
+  }
+  uint32_t partSizeInBytes = (sizeInBytes + numberOfParts - 1) / numberOfParts;
+  uint32_t firstRail =
+      numberOfParts == 1 ? this->selectRail(buffer->getNumaNode()) : 0;
+
+  for (uint32_t part = 0; part < numberOfParts; ++part) {
+    uint32_t rail = firstRail + part;
+    uint64_t offset = (uint64_t)part * partSizeInBytes;
+    uint32_t size = std::min<uint64_t>(partSizeInBytes, sizeInBytes - offset);
+    if (size == 0) {
+      break;
+    }
+
+    infinity::memory::RegionToken regionToken =
+        infinity::memory::MultiRailBuffer::getRegionToken(remote, rail);
+    infinity::requests::RequestToken *railToken =
+        this->useRail(rail, size, requestToken);
+    if (isWrite) {
+      this->queuePairs[rail]->write(buffer->getBuffer(rail),
+                                    localOffset + offset, regionToken,
+                                    remoteOffset + offset, size,
+                                    OperationFlags(), railToken);
+    } else {
+      this->queuePairs[rail]->read(buffer->getBuffer(rail),
+                                   localOffset + offset, regionToken,
+                                   remoteOffset + offset, size,
+                                   OperationFlags(), railToken);
+    }
+  }
+}
+
+infinity::requests::RequestToken *MultiRailQueuePair::useRail(
+    uint32_t rail, uint64_t sizeInBytes,
+    infinity::requests::MultiRailRequestToken *requestToken) {
+
+  this->bytesOutstanding[rail] += sizeInBytes;
+  if (requestToken == nullptr) {
+    this->unsignaledBytes[rail] += sizeInBytes;
+    return nullptr;
+  }
+  return requestToken->useRail(
+      rail, sizeInBytes + this->unsignaledBytes[rail].exchange(0));
+}
+
+void MultiRailQueuePair::releaseBytes(uint32_t rail, uint64_t sizeInBytes) {
+  this->bytesOutstanding[rail] -= sizeInBytes;
+}
+
+} /* namespace queues */
+} /* namespace infinity */
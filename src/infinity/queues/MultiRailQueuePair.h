@@ -0,0 +1,114 @@
+/**
+ * Queues - Multi-Rail Queue Pair
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef QUEUES_MULTIRAILQUEUEPAIR_H_
+#define QUEUES_MULTIRAILQUEUEPAIR_H_
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include <infinity/core/MultiRailContext.h>
+#include <infinity/memory/MultiRailBuffer.h>
+#include <infinity/queues/QueuePair.h>
+#include <infinity/requests/MultiRailRequestToken.h>
+
+namespace infinity {
+namespace queues {
+
+/**
+ * One connected queue pair per rail to the same peer. Every operation goes
+ * to the rail with the fewest bytes outstanding, ties go to the rail
+ * closest to the NUMA node of the local buffer. Reads and writes of at
+ * least the stripe size are split evenly over all rails.
+ *
+ * Bytes of an operation with a request token are released when the token
+ * completes. Operations without one complete in order before the next
+ * operation with a token on the same rail and are released with it.
+ */
+class MultiRailQueuePair {
+
+  friend class infinity::requests::MultiRailRequestToken;
+
+public:
+  static const uint32_t DEFAULT_STRIPE_SIZE_IN_BYTES = 1024 * 1024;
+
+public:
+  MultiRailQueuePair(
+      std::shared_ptr<infinity::core::MultiRailContext> context,
+      const std::vector<std::shared_ptr<QueuePair> > &queuePairs);
+
+  MultiRailQueuePair(const MultiRailQueuePair &) = delete;
+  MultiRailQueuePair(const MultiRailQueuePair &&) = delete;
+  MultiRailQueuePair &operator=(const MultiRailQueuePair &) = delete;
+  MultiRailQueuePair &operator=(MultiRailQueuePair &&) = delete;
+
+public:
+  uint32_t getNumberOfRails();
+  std::shared_ptr<QueuePair> getQueuePair(uint32_t rail);
+  uint64_t getBytesOutstanding(uint32_t rail);
+
+  /**
+   * User data the remote side sent when connecting
+   */
+  uint32_t getUserDataSize();
+  void *getUserData();
+
+  void setStripeSize(uint32_t stripeSizeInBytes);
+  uint32_t getStripeSize();
+
+  /**
+   * Rail the next unstriped operation of a buffer on numaNode would use
+   */
+  uint32_t selectRail(int32_t numaNode);
+
+public:
+  void send(const std::shared_ptr<infinity::memory::MultiRailBuffer> &buffer,
+            uint64_t localOffset, uint32_t sizeInBytes,
+            infinity::requests::MultiRailRequestToken *requestToken = nullptr);
+
+  void write(const std::shared_ptr<infinity::memory::MultiRailBuffer> &buffer,
+             uint64_t localOffset,
+             const infinity::memory::multi_rail_token_t &destination,
+             uint64_t remoteOffset, uint32_t sizeInBytes,
+             infinity::requests::MultiRailRequestToken *requestToken = nullptr);
+
+  void read(const std::shared_ptr<infinity::memory::MultiRailBuffer> &buffer,
+            uint64_t localOffset,
+            const infinity::memory::multi_rail_token_t &source,
+            uint64_t remoteOffset, uint32_t sizeInBytes,
+            infinity::requests::MultiRailRequestToken *requestToken = nullptr);
+
+protected:
+  void
+  transfer(bool isWrite,
+           const std::shared_ptr<infinity::memory::MultiRailBuffer> &buffer,
+           uint64_t localOffset,
+           const infinity::memory::multi_rail_token_t &remote,
+           uint64_t remoteOffset, uint32_t sizeInBytes,
+           infinity::requests::MultiRailRequestToken *requestToken);
+  infinity::requests::RequestToken *
+  useRail(uint32_t rail, uint64_t sizeInBytes,
+          infinity::requests::MultiRailRequestToken *requestToken);
+  void releaseBytes(uint32_t rail, uint64_t sizeInBytes);
+
+protected:
+  std::shared_ptr<infinity::core::MultiRailContext> context;
+  std::vector<std::shared_ptr<QueuePair> > queuePairs;
+  std::atomic<uint64_t>
+      bytesOutstanding[infinity::core::MultiRailContext::MAX_RAILS];
+  std::atomic<uint64_t>
+      unsignaledBytes[infinity::core::MultiRailContext::MAX_RAILS];
+  uint32_t stripeSizeInBytes = DEFAULT_STRIPE_SIZE_IN_BYTES;
+};
+
+} /* namespace queues */
+} /* namespace infinity */
+
+#endif /* QUEUES_MULTIRAILQUEUEPAIR_H_ */
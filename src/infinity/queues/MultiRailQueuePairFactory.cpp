@@ -0,0 +1,93 @@
+/**
+ * Queues - Multi-Rail Queue Pair Factory
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "MultiRailQueuePairFactory.h"
+
+#include <string.h>
+
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace queues {
+
+MultiRailQueuePairFactory::MultiRailQueuePairFactory(
+    std::shared_ptr<infinity::core::MultiRailContext> context)
+    : context(context) {
+
+  for (uint32_t rail = 0; rail < context->getNumberOfRails(); ++rail) {
+    this->factories.emplace_back(
+        new QueuePairFactory(context->getContext(rail)));
+  }
+}
+
+void MultiRailQueuePairFactory::bindToPort(uint16_t port) {
+
+  for (uint32_t rail = 0; rail < this->factories.size(); ++rail) {
+    this->factories[rail]->bindToPort(port + rail);
+  }
+}
+
+std::shared_ptr<MultiRailQueuePair>
+MultiRailQueuePairFactory::acceptIncomingConnection(
+    void *userData, uint32_t userDataSizeInBytes) {
+
+  std::vector<char> data =
+      this->prependNumberOfRails(userData, userDataSizeInBytes);
+  std::vector<std::shared_ptr<QueuePair> > queuePairs;
+  for (uint32_t rail = 0; rail < this->factories.size(); ++rail) {
+    queuePairs.push_back(this->factories[rail]->acceptIncomingConnection(
+        data.data(), data.size()));
+    this->checkNumberOfRails(queuePairs.back());
+  }
+  return std::make_shared<MultiRailQueuePair>(this->context, queuePairs);
+}
+
+std::shared_ptr<MultiRailQueuePair>
+MultiRailQueuePairFactory::connectToRemoteHost(const char *hostAddress,
+                                               uint16_t port, void *userData,
+                                               uint32_t userDataSizeInBytes) {
+
+  std::vector<char> data =
+      this->prependNumberOfRails(userData, userDataSizeInBytes);
+  std::vector<std::shared_ptr<QueuePair> > queuePairs;
+  for (uint32_t rail = 0; rail < this->factories.size(); ++rail) {
+    queuePairs.push_back(this->factories[rail]->connectToRemoteHost(
+        hostAddress, port + rail, data.data(), data.size()));
+    this->checkNumberOfRails(queuePairs.back());
+  }
+  return std::make_shared<MultiRailQueuePair>(this->context, queuePairs);
+}
+
+std::vector<char>
+MultiRailQueuePairFactory::prependNumberOfRails(void *userData,
+                                                uint32_t userDataSizeInBytes) {
+
+  uint32_t numberOfRails = this->factories.size();
+  std::vector<char> data(sizeof(uint32_t) + userDataSizeInBytes);
+  memcpy(data.data(), &numberOfRails, sizeof(uint32_t));
+  if (userDataSizeInBytes > 0) {
+    memcpy(data.data() + sizeof(uint32_t), userData, userDataSizeInBytes);
+  }
+  return data;
+}
+
+void MultiRailQueuePairFactory::checkNumberOfRails(
+    const std::shared_ptr<QueuePair> &queuePair) {
+
+  uint32_t remoteNumberOfRails = 0;
+  if (queuePair->getUserDataSize() >= sizeof(uint32_t)) {
+    memcpy(&remoteNumberOfRails, queuePair->getUserData(), sizeof(uint32_t));
+  }
+  INFINITY_ASSERT(remoteNumberOfRails == this->factories.size(),
+                  "[INFINITY][QUEUES][MULTIRAIL] Remote side has %u rails, "
+                  "local side has %lu.\n",
+                  remoteNumberOfRails, this->factories.size());
+}
+
+} /* namespace queues */
+} /* namespace infinity */
@@ -0,0 +1,74 @@
+/**
+ * Queues - Multi-Rail Queue Pair Factory
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef QUEUES_MULTIRAILQUEUEPAIRFACTORY_H_
+#define QUEUES_MULTIRAILQUEUEPAIRFACTORY_H_
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include <infinity/core/MultiRailContext.h>
+#include <infinity/queues/MultiRailQueuePair.h>
+#include <infinity/queues/QueuePairFactory.h>
+
+namespace infinity {
+namespace queues {
+
+/**
+ * Connects one queue pair per rail. Rail i listens on and connects to
+ * port + i, both sides need the same number of rails. User data is sent
+ * behind the number of rails on every rail.
+ */
+class MultiRailQueuePairFactory {
+
+public:
+  MultiRailQueuePairFactory(
+      std::shared_ptr<infinity::core::MultiRailContext> context);
+
+  MultiRailQueuePairFactory(const MultiRailQueuePairFactory &) = delete;
+  MultiRailQueuePairFactory(const MultiRailQueuePairFactory &&) = delete;
+  MultiRailQueuePairFactory &
+  operator=(const MultiRailQueuePairFactory &) = delete;
+  MultiRailQueuePairFactory &operator=(MultiRailQueuePairFactory &&) = delete;
+
+public:
+  /**
+   * Bind rail i to port + i for listening to incoming connections
+   */
+  void bindToPort(uint16_t port);
+
+  /**
+   * Accept incoming connection request on every rail (passive side)
+   */
+  std::shared_ptr<MultiRailQueuePair>
+  acceptIncomingConnection(void *userData = nullptr,
+                           uint32_t userDataSizeInBytes = 0);
+
+  /**
+   * Connect every rail to remote machine (active side)
+   */
+  std::shared_ptr<MultiRailQueuePair>
+  connectToRemoteHost(const char *hostAddress, uint16_t port,
+                      void *userData = nullptr,
+                      uint32_t userDataSizeInBytes = 0);
+
+protected:
+  std::vector<char> prependNumberOfRails(void *userData,
+                                         uint32_t userDataSizeInBytes);
+  void checkNumberOfRails(const std::shared_ptr<QueuePair> &queuePair);
+
+protected:
+  std::shared_ptr<infinity::core::MultiRailContext> context;
+  std::vector<std::unique_ptr<QueuePairFactory> > factories;
+};
+
+} /* namespace queues */
+} /* namespace infinity */
+
+#endif /* QUEUES_MULTIRAILQUEUEPAIRFACTORY_H_ */
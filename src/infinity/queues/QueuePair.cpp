@@ -8,6 +8,7 @@
 
 #include "QueuePair.h"
 
+#include <algorithm>
 #include <random>
 #include <string.h>
 #include <arpa/inet.h>
@@ -33,30 +34,187 @@ int OperationFlags::ibvFlags() {
   return flags;
 }
 
-QueuePair::QueuePair(const std::shared_ptr<infinity::core::Context>& context)
-    : context(context) {
+QueuePairOptions QueuePairOptions::forProfile(QueuePairProfile profile) {
+
+  QueuePairOptions options;
+  switch (profile) {
+  case RPC_SMALL:
+    options.sendQueueDepth = 64;
+    options.numberOfSGEElements = 1;
+    options.maxInlineData = 128;
+    break;
+  case BULK:
+    options.sendQueueDepth = 1024;
+    options.numberOfSGEElements = 4;
+    break;
+  case ATOMIC_ONLY:
+    options.sendQueueDepth = 16;
+    options.numberOfSGEElements = 1;
+    break;
+  case DEFAULT_PROFILE:
+    break;
+  }
+  return options;
+}
 
-  ibv_qp_init_attr qpInitAttributes;
-  memset(&qpInitAttributes, 0, sizeof(qpInitAttributes));
+bool QueuePairOptions::parseProfile(const std::string &name,
+                                    QueuePairProfile &profile) {
+  if (name == "default") {
+    profile = DEFAULT_PROFILE;
+  } else if (name == "rpc-small") {
+    profile = RPC_SMALL;
+  } else if (name == "bulk") {
+    profile = BULK;
+  } else if (name == "atomic-only") {
+    profile = ATOMIC_ONLY;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Same derivation as the kernel uses for RoCE v2, both sides of a
+ * connection end up with the same label
+ */
+static uint32_t computeFlowLabel(uint32_t localQueuePairNumber,
+                                 uint32_t remoteQueuePairNumber) {
+  uint64_t value = static_cast<uint64_t>(localQueuePairNumber) *
+                   remoteQueuePairNumber;
+  value ^= value >> 20;
+  value ^= value >> 40;
+  return static_cast<uint32_t>(value & 0xFFFFF);
+}
+
+uint32_t QueuePair::randomSequenceNumber() {
+  static thread_local std::mt19937 generator(std::random_device{}());
+  std::uniform_int_distribution<uint32_t> range(0, (1 << 24) - 1);
+  return range(generator);
+}
 
+QueuePair::QueuePair(const std::shared_ptr<infinity::core::Context>& context,
+                     const QueuePairOptions &options)
+    : context(context), options(options) {
+
+  // Settings left at 0 use the device limits, others are capped by them
+  uint8_t maxReadAtomic = context->getMaxReadAtomic();
+  if (this->options.maxReadAtomic == 0 ||
+      this->options.maxReadAtomic > maxReadAtomic) {
+    this->options.maxReadAtomic = maxReadAtomic;
+  }
+  uint8_t maxDestReadAtomic = context->getMaxDestReadAtomic();
+  if (this->options.maxDestReadAtomic == 0 ||
+      this->options.maxDestReadAtomic > maxDestReadAtomic) {
+    this->options.maxDestReadAtomic = maxDestReadAtomic;
+  }
+  uint8_t activeMtu = context->getActiveMtu();
+  if (this->options.pathMtu == 0 || this->options.pathMtu > activeMtu) {
+    this->options.pathMtu = activeMtu;
+  }
+
+  const ibv_device_attr &deviceAttributes = context->getDeviceAttributes();
+  uint32_t sendQueueLength =
+      this->options.sendQueueDepth != 0
+          ? std::min<uint32_t>(this->options.sendQueueDepth,
+                               deviceAttributes.max_qp_wr)
+          : infinity::core::Configuration::sendQueueLength(context);
   maxNumberOfSGEElements =
-      infinity::core::Configuration::maxNumberOfSGEElements(context);
-  qpInitAttributes.send_cq = context->getSendCompletionQueue();
-  qpInitAttributes.recv_cq = context->getReceiveCompletionQueue();
-  qpInitAttributes.srq = context->getSharedReceiveQueue();
-  qpInitAttributes.cap.max_send_wr = std::max(
-      infinity::core::Configuration::sendCompletionQueueLength(context), 1u);
-  qpInitAttributes.cap.max_send_sge = maxNumberOfSGEElements;
-  qpInitAttributes.cap.max_recv_wr = std::max(
-      infinity::core::Configuration::recvCompletionQueueLength(context), 1u);
-  qpInitAttributes.cap.max_recv_sge = maxNumberOfSGEElements;
-  qpInitAttributes.qp_type = IBV_QPT_RC;
-  qpInitAttributes.sq_sig_all = 0;
+      this->options.numberOfSGEElements != 0
+          ? std::min<uint32_t>(this->options.numberOfSGEElements,
+                               deviceAttributes.max_sge)
+          : infinity::core::Configuration::maxNumberOfSGEElements(context);
+
+  ibv_qp_cap capabilities;
+  memset(&capabilities, 0, sizeof(capabilities));
+  capabilities.max_send_wr = std::max(sendQueueLength, 1u);
+  capabilities.max_send_sge = maxNumberOfSGEElements;
+  capabilities.max_inline_data = this->options.maxInlineData;
+
+  if (context->usesXrc()) {
+    createXrcQueuePairs(capabilities);
+  } else {
+    ibv_qp_init_attr qpInitAttributes;
+    memset(&qpInitAttributes, 0, sizeof(qpInitAttributes));
+    qpInitAttributes.send_cq = context->getSendCompletionQueue();
+    qpInitAttributes.recv_cq = context->getReceiveCompletionQueue();
+    qpInitAttributes.srq = context->getSharedReceiveQueue();
+    qpInitAttributes.cap = capabilities;
+    qpInitAttributes.cap.max_recv_wr = std::max(
+        infinity::core::Configuration::recvQueueLength(context), 1u);
+    qpInitAttributes.cap.max_recv_sge = maxNumberOfSGEElements;
+    qpInitAttributes.qp_type = IBV_QPT_RC;
+    qpInitAttributes.sq_sig_all = 0;
+
+    this->ibvQueuePair =
+        ibv_create_qp(context->getProtectionDomain(), &(qpInitAttributes));
+    INFINITY_ASSERT(
+        this->ibvQueuePair != nullptr,
+        "[INFINITY][QUEUES][QUEUEPAIR] Cannot create queue pair.\n");
+    capabilities = qpInitAttributes.cap;
+  }
 
-  this->ibvQueuePair =
-      ibv_create_qp(context->getProtectionDomain(), &(qpInitAttributes));
-  INFINITY_ASSERT(this->ibvQueuePair != nullptr,
-                  "[INFINITY][QUEUES][QUEUEPAIR] Cannot create queue pair.\n");
+  // The device may round the sizes up
+  this->sendQueueDepth = capabilities.max_send_wr;
+  this->maxInlineData = capabilities.max_inline_data;
+  context->attachQueuePair(this->sendQueueDepth, maxNumberOfSGEElements,
+                           this->maxInlineData);
+
+  transitionToInit();
+
+  this->initialOptions = this->options;
+  this->sequenceNumber = randomSequenceNumber();
+
+  if (this->options.receiveCredits > 0) {
+    this->creditBuffer =
+        infinity::memory::Buffer::createBuffer(context, 2 * sizeof(uint64_t));
+  }
+}
+
+QueuePair::QueuePair(const std::shared_ptr<QueuePair> &sendQueuePair,
+                     uint32_t remoteSharedReceiveQueueNumber)
+    : context(sendQueuePair->context), options(sendQueuePair->options),
+      ibvQueuePair(sendQueuePair->ibvQueuePair),
+      sequenceNumber(sendQueuePair->sequenceNumber),
+      maxNumberOfSGEElements(sendQueuePair->maxNumberOfSGEElements),
+      sendQueueDepth(sendQueuePair->sendQueueDepth),
+      maxInlineData(sendQueuePair->maxInlineData),
+      remoteSharedReceiveQueueNumber(remoteSharedReceiveQueueNumber),
+      sendQueueOwner(sendQueuePair) {
+
+  INFINITY_ASSERT(this->context->usesXrc(),
+                  "[INFINITY][QUEUES][QUEUEPAIR] Only XRC queue pairs can "
+                  "share a send queue.\n");
+}
+
+QueuePair::~QueuePair() noexcept(false) {
+
+  this->context->unregisterQueuePair(this);
+
+  if (this->creditBuffer != nullptr) {
+    this->context->unblockQueuePair(this);
+  }
+
+  // Shared send queues belong to the queue pair which created them
+  if (this->sendQueueOwner == nullptr) {
+    int32_t returnValue = ibv_destroy_qp(this->ibvQueuePair);
+    INFINITY_ASSERT(
+        returnValue == 0,
+        "[INFINITY][QUEUES][QUEUEPAIR] Cannot delete queue pair.\n");
+    this->context->detachQueuePair(this->sendQueueDepth,
+                                   this->maxNumberOfSGEElements,
+                                   this->maxInlineData);
+  }
+
+  if (this->ibvTargetQueuePair != nullptr) {
+    int32_t returnValue = ibv_destroy_qp(this->ibvTargetQueuePair);
+    INFINITY_ASSERT(
+        returnValue == 0,
+        "[INFINITY][QUEUES][QUEUEPAIR] Cannot delete target queue pair.\n");
+    this->context->detachQueuePair(0, 0, 0);
+  }
+}
+
+void QueuePair::transitionToInit() {
 
   ibv_qp_attr qpAttributes;
   memset(&qpAttributes, 0, sizeof(qpAttributes));
@@ -68,81 +226,283 @@ QueuePair::QueuePair(const std::shared_ptr<infinity::core::Context>& context)
       IBV_ACCESS_REMOTE_WRITE | IBV_ACCESS_REMOTE_READ |
       IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_ATOMIC;
 
-  int32_t returnValue = ibv_modify_qp(
-      this->ibvQueuePair, &(qpAttributes),
-      IBV_QP_STATE | IBV_QP_PORT | IBV_QP_ACCESS_FLAGS | IBV_QP_PKEY_INDEX);
+  ibv_qp *queuePairs[] = {this->ibvQueuePair, this->ibvTargetQueuePair};
+  for (ibv_qp *queuePair : queuePairs) {
+    if (queuePair == nullptr) {
+      continue;
+    }
+    int32_t returnValue = ibv_modify_qp(
+        queuePair, &(qpAttributes),
+        IBV_QP_STATE | IBV_QP_PORT | IBV_QP_ACCESS_FLAGS | IBV_QP_PKEY_INDEX);
+
+    INFINITY_ASSERT(
+        returnValue == 0,
+        "[INFINITY][QUEUES][QUEUEPAIR] Cannot transition to INIT state.\n");
+  }
+}
+
+void QueuePair::recycle() {
+
+  INFINITY_ASSERT(this->sendQueueOwner == nullptr,
+                  "[INFINITY][QUEUES][QUEUEPAIR] Queue pairs sharing a send "
+                  "queue cannot be recycled.\n");
+
+  this->context->unregisterQueuePair(this);
+  resetToInit();
+  this->userData.clear();
+}
+
+bool QueuePair::hasFailed() {
+
+  ibv_qp_attr qpAttributes;
+  ibv_qp_init_attr qpInitAttributes;
+  int32_t returnValue = ibv_query_qp(this->ibvQueuePair, &qpAttributes,
+                                     IBV_QP_STATE, &qpInitAttributes);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][QUEUEPAIR] Cannot query state.\n");
+  return qpAttributes.qp_state == IBV_QPS_ERR ||
+         qpAttributes.qp_state == IBV_QPS_SQE;
+}
 
+void QueuePair::recover() {
+
+  INFINITY_ASSERT(this->sendQueueOwner == nullptr,
+                  "[INFINITY][QUEUES][QUEUEPAIR] Queue pairs sharing a send "
+                  "queue are recovered with the queue pair they share.\n");
+
+  // In the error state, every outstanding request is flushed. A marker
+  // posted afterwards completes once all of them did.
+  ibv_qp_attr qpAttributes;
+  memset(&qpAttributes, 0, sizeof(qpAttributes));
+  qpAttributes.qp_state = IBV_QPS_ERR;
+  int32_t returnValue =
+      ibv_modify_qp(this->ibvQueuePair, &qpAttributes, IBV_QP_STATE);
   INFINITY_ASSERT(
       returnValue == 0,
-      "[INFINITY][QUEUES][QUEUEPAIR] Cannot transition to INIT state.\n");
+      "[INFINITY][QUEUES][QUEUEPAIR] Cannot transition to ERR state.\n");
 
-  std::random_device randomGenerator;
-  std::uniform_int_distribution<int> range(0, 1<<24);
-  this->sequenceNumber = range(randomGenerator);
+  infinity::requests::RequestToken marker(this->context);
+  marker.reset();
 
-  defaultAtomic = std::make_shared<infinity::memory::Atomic>(context);
+  ibv_send_wr workRequest;
+  memset(&workRequest, 0, sizeof(ibv_send_wr));
+  workRequest.wr_id = reinterpret_cast<uint64_t>(&marker);
+  workRequest.opcode = IBV_WR_SEND;
+  workRequest.send_flags = IBV_SEND_SIGNALED;
+
+  // The send queue may still be full of requests waiting to be flushed
+  ibv_send_wr *badWorkRequest;
+  while ((returnValue = postWorkRequests(&workRequest, &badWorkRequest)) ==
+         ENOMEM) {
+    this->context->pollSendCompletionQueue();
+  }
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][QUEUEPAIR] Cannot post flush marker. "
+                  "%s.\n",
+                  strerror(returnValue));
+  marker.waitUntilCompleted();
+
+  resetToInit();
+
+  INFINITY_DEBUG("[INFINITY][QUEUES][QUEUEPAIR] Queue pair %u recovered.\n",
+                 getQueuePairNumber());
 }
 
-QueuePair::~QueuePair() noexcept(false) {
+void QueuePair::resetToInit() {
 
-  int32_t returnValue = ibv_destroy_qp(this->ibvQueuePair);
-  INFINITY_ASSERT(returnValue == 0,
-                  "[INFINITY][QUEUES][QUEUEPAIR] Cannot delete queue pair.\n");
+  // Reset drops all outstanding work requests
+  ibv_qp_attr qpAttributes;
+  memset(&qpAttributes, 0, sizeof(qpAttributes));
+  qpAttributes.qp_state = IBV_QPS_RESET;
+  ibv_qp *queuePairs[] = {this->ibvQueuePair, this->ibvTargetQueuePair};
+  for (ibv_qp *queuePair : queuePairs) {
+    if (queuePair == nullptr) {
+      continue;
+    }
+    int32_t returnValue =
+        ibv_modify_qp(queuePair, &qpAttributes, IBV_QP_STATE);
+    INFINITY_ASSERT(
+        returnValue == 0,
+        "[INFINITY][QUEUES][QUEUEPAIR] Cannot transition to RESET state.\n");
+  }
+
+  transitionToInit();
+
+  // A new sequence number keeps late packets of the old connection out
+  this->options = this->initialOptions;
+  this->sequenceNumber = randomSequenceNumber();
+  this->remoteSharedReceiveQueueNumber = 0;
+  resetFlowControl();
+}
+
+void QueuePair::createXrcQueuePairs(ibv_qp_cap &capabilities) {
+
+  // Sends leave through the initiator, receives arrive at the target and
+  // end up in the XRC shared receive queue of the context
+  ibv_qp_init_attr_ex qpInitAttributes;
+  memset(&qpInitAttributes, 0, sizeof(qpInitAttributes));
+  qpInitAttributes.qp_type = IBV_QPT_XRC_SEND;
+  qpInitAttributes.send_cq = this->context->getSendCompletionQueue();
+  qpInitAttributes.cap = capabilities;
+  qpInitAttributes.sq_sig_all = 0;
+  qpInitAttributes.comp_mask = IBV_QP_INIT_ATTR_PD;
+  qpInitAttributes.pd = this->context->getProtectionDomain();
+
+  this->ibvQueuePair = ibv_create_qp_ex(
+      this->context->getInfiniBandContext(), &qpInitAttributes);
+  INFINITY_ASSERT(this->ibvQueuePair != nullptr,
+                  "[INFINITY][QUEUES][QUEUEPAIR] Cannot create XRC send "
+                  "queue pair.\n");
+  capabilities = qpInitAttributes.cap;
+
+  memset(&qpInitAttributes, 0, sizeof(qpInitAttributes));
+  qpInitAttributes.qp_type = IBV_QPT_XRC_RECV;
+  qpInitAttributes.comp_mask = IBV_QP_INIT_ATTR_XRCD;
+  qpInitAttributes.xrcd = this->context->getXrcDomain();
+
+  this->ibvTargetQueuePair = ibv_create_qp_ex(
+      this->context->getInfiniBandContext(), &qpInitAttributes);
+  INFINITY_ASSERT(this->ibvTargetQueuePair != nullptr,
+                  "[INFINITY][QUEUES][QUEUEPAIR] Cannot create XRC target "
+                  "queue pair.\n");
+  this->context->attachQueuePair(0, 0, 0);
 }
 
 void QueuePair::registerRemote(std::shared_ptr<QueuePair>& queuePair,
                                std::shared_ptr<core::Context>& context,
                                uint16_t remoteDeviceId,
                                uint32_t remoteQueuePairNumber,
-                               uint32_t remoteSequenceNumber)
+                               uint32_t remoteSequenceNumber,
+                               const ibv_gid *remoteGid,
+                               const QueuePairOptions *remoteOptions,
+                               uint32_t remoteTargetQueuePairNumber,
+                               uint32_t remoteSharedReceiveQueueNumber)
 {
-    queuePair->activate(remoteDeviceId, remoteQueuePairNumber, remoteSequenceNumber);
+    queuePair->activate(remoteDeviceId, remoteQueuePairNumber,
+                        remoteSequenceNumber, remoteGid, remoteOptions,
+                        remoteTargetQueuePairNumber,
+                        remoteSharedReceiveQueueNumber);
     context->registerQueuePair(queuePair);
 }
 
 void QueuePair::activate(uint16_t remoteDeviceId,
                          uint32_t remoteQueuePairNumber,
-                         uint32_t remoteSequenceNumber) {
+                         uint32_t remoteSequenceNumber,
+                         const ibv_gid *remoteGid,
+                         const QueuePairOptions *remoteOptions,
+                         uint32_t remoteTargetQueuePairNumber,
+                         uint32_t remoteSharedReceiveQueueNumber) {
+
+  INFINITY_ASSERT(this->sendQueueOwner == nullptr,
+                  "[INFINITY][QUEUES][QUEUEPAIR] Queue pairs sharing a send "
+                  "queue are active with the queue pair they share.\n");
+
+  this->remoteDeviceId = remoteDeviceId;
+  this->remoteQueuePairNumber = remoteQueuePairNumber;
+
+  // We may not have more reads in flight than the remote side accepts
+  if (remoteOptions != nullptr) {
+    if (remoteOptions->maxDestReadAtomic > 0) {
+      this->options.maxReadAtomic = std::min(this->options.maxReadAtomic,
+                                             remoteOptions->maxDestReadAtomic);
+    }
+    if (remoteOptions->pathMtu > 0) {
+      this->options.pathMtu =
+          std::min(this->options.pathMtu, remoteOptions->pathMtu);
+    }
+  }
+
+  // With XRC, our initiator talks to the remote target and the remote
+  // initiator to our target
+  uint32_t destinationQueuePairNumber = remoteQueuePairNumber;
+  if (this->ibvTargetQueuePair != nullptr) {
+    INFINITY_ASSERT(remoteTargetQueuePairNumber != 0,
+                    "[INFINITY][QUEUES][QUEUEPAIR] XRC requires the target "
+                    "queue pair of the remote side.\n");
+    destinationQueuePairNumber = remoteTargetQueuePairNumber;
+    this->remoteSharedReceiveQueueNumber = remoteSharedReceiveQueueNumber;
+  }
+
+  transitionToReadyToReceive(this->ibvQueuePair, remoteDeviceId,
+                             destinationQueuePairNumber, remoteSequenceNumber,
+                             remoteGid);
+
+  ibv_qp_attr qpAttributes;
+  memset(&(qpAttributes), 0, sizeof(qpAttributes));
+
+  qpAttributes.qp_state = IBV_QPS_RTS;
+  qpAttributes.timeout = this->options.timeout;
+  qpAttributes.retry_cnt = this->options.retryCount;
+  qpAttributes.rnr_retry = this->options.rnrRetry;
+  qpAttributes.sq_psn = this->getSequenceNumber();
+  qpAttributes.max_rd_atomic = this->options.maxReadAtomic;
+
+  int32_t returnValue = ibv_modify_qp(
+      this->ibvQueuePair, &qpAttributes,
+      IBV_QP_STATE | IBV_QP_TIMEOUT | IBV_QP_RETRY_CNT | IBV_QP_RNR_RETRY |
+          IBV_QP_SQ_PSN | IBV_QP_MAX_QP_RD_ATOMIC);
+
+  INFINITY_ASSERT(
+      returnValue == 0,
+      "[INFINITY][QUEUES][QUEUEPAIR] Cannot transition to RTS state.\n");
+
+  // Targets only receive and stay in RTR
+  if (this->ibvTargetQueuePair != nullptr) {
+    transitionToReadyToReceive(this->ibvTargetQueuePair, remoteDeviceId,
+                               remoteQueuePairNumber, remoteSequenceNumber,
+                               remoteGid);
+  }
+}
+
+void QueuePair::transitionToReadyToReceive(ibv_qp *queuePair,
+                                           uint16_t remoteDeviceId,
+                                           uint32_t remoteQueuePairNumber,
+                                           uint32_t remoteSequenceNumber,
+                                           const ibv_gid *remoteGid) {
 
   ibv_qp_attr qpAttributes;
   memset(&(qpAttributes), 0, sizeof(qpAttributes));
 
   qpAttributes.qp_state = IBV_QPS_RTR;
-  qpAttributes.path_mtu = IBV_MTU_4096;
+  qpAttributes.path_mtu = static_cast<ibv_mtu>(this->options.pathMtu);
   qpAttributes.dest_qp_num = remoteQueuePairNumber;
   qpAttributes.rq_psn = remoteSequenceNumber;
-  qpAttributes.max_dest_rd_atomic = 1;
-  qpAttributes.min_rnr_timer = 12;
-  qpAttributes.ah_attr.is_global = 0;
+  qpAttributes.max_dest_rd_atomic = this->options.maxDestReadAtomic;
+  qpAttributes.min_rnr_timer = this->options.minRnrTimer;
   qpAttributes.ah_attr.dlid = remoteDeviceId;
-  qpAttributes.ah_attr.sl = 0;
+  qpAttributes.ah_attr.sl = this->options.serviceLevel;
   qpAttributes.ah_attr.src_path_bits = 0;
   qpAttributes.ah_attr.port_num = context->getDevicePort();
 
+  if (usesGlobalRouting()) {
+    static const ibv_gid zeroGid = {};
+    INFINITY_ASSERT(remoteGid != nullptr &&
+                        memcmp(remoteGid->raw, zeroGid.raw,
+                               sizeof(zeroGid.raw)) != 0,
+                    "[INFINITY][QUEUES][QUEUEPAIR] Global routing requires "
+                    "the GID of the remote side.\n");
+    uint32_t flowLabel = this->options.flowLabel;
+    if (flowLabel == 0) {
+      flowLabel = computeFlowLabel(queuePair->qp_num, remoteQueuePairNumber);
+    }
+    qpAttributes.ah_attr.is_global = 1;
+    qpAttributes.ah_attr.grh.dgid = *remoteGid;
+    qpAttributes.ah_attr.grh.sgid_index = this->options.gidIndex;
+    qpAttributes.ah_attr.grh.flow_label = flowLabel & 0xFFFFF;
+    qpAttributes.ah_attr.grh.hop_limit = this->options.hopLimit;
+    qpAttributes.ah_attr.grh.traffic_class = this->options.trafficClass;
+  } else {
+    qpAttributes.ah_attr.is_global = 0;
+  }
+
   int32_t returnValue = ibv_modify_qp(
-      this->ibvQueuePair, &qpAttributes,
+      queuePair, &qpAttributes,
       IBV_QP_STATE | IBV_QP_AV | IBV_QP_PATH_MTU | IBV_QP_DEST_QPN |
           IBV_QP_RQ_PSN | IBV_QP_MIN_RNR_TIMER | IBV_QP_MAX_DEST_RD_ATOMIC);
 
   INFINITY_ASSERT(
       returnValue == 0,
       "[INFINITY][QUEUES][QUEUEPAIR] Cannot transition to RTR state.\n");
-
-  qpAttributes.qp_state = IBV_QPS_RTS;
-  qpAttributes.timeout = 14;
-  qpAttributes.retry_cnt = 7;
-  qpAttributes.rnr_retry = 7;
-  qpAttributes.sq_psn = this->getSequenceNumber();
-  qpAttributes.max_rd_atomic = 1;
-
-  returnValue = ibv_modify_qp(this->ibvQueuePair, &qpAttributes,
-                              IBV_QP_STATE | IBV_QP_TIMEOUT | IBV_QP_RETRY_CNT |
-                                  IBV_QP_RNR_RETRY | IBV_QP_SQ_PSN |
-                                  IBV_QP_MAX_QP_RD_ATOMIC);
-
-  INFINITY_ASSERT(
-      returnValue == 0,
-      "[INFINITY][QUEUES][QUEUEPAIR] Cannot transition to RTS state.\n");
 }
 
 void QueuePair::setRemoteUserData(const std::vector<char> &userData) {
@@ -157,6 +517,33 @@ uint32_t QueuePair::getQueuePairNumber() { return this->ibvQueuePair->qp_num; }
 
 uint32_t QueuePair::getSequenceNumber() { return this->sequenceNumber; }
 
+uint32_t QueuePair::getTargetQueuePairNumber() {
+  return this->ibvTargetQueuePair != nullptr ? this->ibvTargetQueuePair->qp_num
+                                             : 0;
+}
+
+uint16_t QueuePair::getRemoteDeviceId() { return this->remoteDeviceId; }
+
+uint32_t QueuePair::getRemoteQueuePairNumber() {
+  return this->remoteQueuePairNumber;
+}
+
+uint32_t QueuePair::getRemoteSharedReceiveQueueNumber() {
+  return this->remoteSharedReceiveQueueNumber;
+}
+
+uint32_t QueuePair::getSendQueueDepth() { return this->sendQueueDepth; }
+
+ibv_gid QueuePair::getGid() {
+  return this->context->getGid(this->options.gidIndex);
+}
+
+bool QueuePair::usesGlobalRouting() {
+  return this->options.globalRouting || this->context->isEthernet();
+}
+
+const QueuePairOptions &QueuePair::getOptions() { return this->options; }
+
 void QueuePair::send(const std::shared_ptr<infinity::memory::Buffer>& buffer,
                      infinity::requests::RequestToken *requestToken) {
   send(buffer, 0, buffer->getSizeInBytes(), OperationFlags(), requestToken);
@@ -180,12 +567,11 @@ void QueuePair::send(const std::shared_ptr<infinity::memory::Buffer>& buffer,
 
   struct ibv_sge sgElement;
   struct ibv_send_wr workRequest;
-  struct ibv_send_wr *badWorkRequest;
 
   memset(&sgElement, 0, sizeof(ibv_sge));
   sgElement.addr = buffer->getAddress() + localOffset;
   sgElement.length = sizeInBytes;
-  sgElement.lkey = buffer->getLocalKey();
+  sgElement.lkey = buffer->getLocalKey(localOffset);
 
   INFINITY_ASSERT(sizeInBytes <= buffer->getRemainingSizeInBytes(localOffset),
                   "[INFINITY][QUEUES][QUEUEPAIR] Segmentation fault while "
@@ -201,8 +587,7 @@ void QueuePair::send(const std::shared_ptr<infinity::memory::Buffer>& buffer,
     workRequest.send_flags |= IBV_SEND_SIGNALED;
   }
 
-  int returnValue =
-      ibv_post_send(this->ibvQueuePair, &workRequest, &badWorkRequest);
+  int returnValue = postCreditedWorkRequest(&workRequest, &buffer, 1);
 
   INFINITY_ASSERT(
       returnValue == 0,
@@ -228,12 +613,11 @@ QueuePair::sendWithImmediate(const std::shared_ptr<infinity::memory::Buffer>& bu
 
   struct ibv_sge sgElement;
   struct ibv_send_wr workRequest;
-  struct ibv_send_wr *badWorkRequest;
 
   memset(&sgElement, 0, sizeof(ibv_sge));
   sgElement.addr = buffer->getAddress() + localOffset;
   sgElement.length = sizeInBytes;
-  sgElement.lkey = buffer->getLocalKey();
+  sgElement.lkey = buffer->getLocalKey(localOffset);
 
   INFINITY_ASSERT(sizeInBytes <= buffer->getRemainingSizeInBytes(localOffset),
                   "[INFINITY][QUEUES][QUEUEPAIR] Segmentation fault while "
@@ -250,8 +634,7 @@ QueuePair::sendWithImmediate(const std::shared_ptr<infinity::memory::Buffer>& bu
     workRequest.send_flags |= IBV_SEND_SIGNALED;
   }
 
-  int returnValue =
-      ibv_post_send(this->ibvQueuePair, &workRequest, &badWorkRequest);
+  int returnValue = postCreditedWorkRequest(&workRequest, &buffer, 1);
 
   INFINITY_ASSERT(
       returnValue == 0,
@@ -301,7 +684,7 @@ void QueuePair::write(const std::shared_ptr<infinity::memory::Buffer>& buffer,
   memset(&sgElement, 0, sizeof(ibv_sge));
   sgElement.addr = buffer->getAddress() + localOffset;
   sgElement.length = sizeInBytes;
-  sgElement.lkey = buffer->getLocalKey();
+  sgElement.lkey = buffer->getLocalKey(localOffset);
 
   INFINITY_ASSERT(sizeInBytes <= buffer->getRemainingSizeInBytes(localOffset),
                   "[INFINITY][QUEUES][QUEUEPAIR] Segmentation fault while "
@@ -324,8 +707,7 @@ void QueuePair::write(const std::shared_ptr<infinity::memory::Buffer>& buffer,
                   "[INFINITY][QUEUES][QUEUEPAIR] Segmentation fault while "
                   "writing to remote memory.\n");
 
-  int returnValue =
-      ibv_post_send(this->ibvQueuePair, &workRequest, &badWorkRequest);
+  int returnValue = postWorkRequests(&workRequest, &badWorkRequest);
 
   INFINITY_ASSERT(
       returnValue == 0,
@@ -351,12 +733,11 @@ void QueuePair::writeWithImmediate(
 
   struct ibv_sge sgElement;
   struct ibv_send_wr workRequest;
-  struct ibv_send_wr *badWorkRequest;
 
   memset(&sgElement, 0, sizeof(ibv_sge));
   sgElement.addr = buffer->getAddress() + localOffset;
   sgElement.length = sizeInBytes;
-  sgElement.lkey = buffer->getLocalKey();
+  sgElement.lkey = buffer->getLocalKey(localOffset);
 
   INFINITY_ASSERT(sizeInBytes <= buffer->getRemainingSizeInBytes(localOffset),
                   "[INFINITY][QUEUES][QUEUEPAIR] Segmentation fault while "
@@ -380,8 +761,7 @@ void QueuePair::writeWithImmediate(
                   "[INFINITY][QUEUES][QUEUEPAIR] Segmentation fault while "
                   "writing to remote memory.\n");
 
-  int returnValue =
-      ibv_post_send(this->ibvQueuePair, &workRequest, &badWorkRequest);
+  int returnValue = postCreditedWorkRequest(&workRequest, &buffer, 1);
 
   INFINITY_ASSERT(
       returnValue == 0,
@@ -427,7 +807,8 @@ void QueuePair::multiWrite(
       sgElements[i].length = buffers[i]->getSizeInBytes();
     }
     totalSizeInBytes += sgElements[i].length;
-    sgElements[i].lkey = buffers[i]->getLocalKey();
+    sgElements[i].lkey = buffers[i]->getLocalKey(
+        (localOffsets != nullptr) ? localOffsets[i] : 0);
   }
 
   memset(&workRequest, 0, sizeof(ibv_send_wr));
@@ -447,8 +828,7 @@ void QueuePair::multiWrite(
                   "[INFINITY][QUEUES][QUEUEPAIR] Segmentation fault while "
                   "writing to remote memory.\n");
 
-  int returnValue =
-      ibv_post_send(this->ibvQueuePair, &workRequest, &badWorkRequest);
+  int returnValue = postWorkRequests(&workRequest, &badWorkRequest);
 
   INFINITY_ASSERT(
       returnValue == 0,
@@ -477,7 +857,6 @@ void QueuePair::multiWriteWithImmediate(
   struct ibv_sge *sgElements =
       (ibv_sge *)calloc(numberOfElements, sizeof(ibv_sge));
   struct ibv_send_wr workRequest;
-  struct ibv_send_wr *badWorkRequest;
 
   INFINITY_ASSERT(
       numberOfElements <= maxNumberOfSGEElements,
@@ -496,7 +875,8 @@ void QueuePair::multiWriteWithImmediate(
       sgElements[i].length = buffers[i]->getSizeInBytes();
     }
     totalSizeInBytes += sgElements[i].length;
-    sgElements[i].lkey = buffers[i]->getLocalKey();
+    sgElements[i].lkey = buffers[i]->getLocalKey(
+        (localOffsets != nullptr) ? localOffsets[i] : 0);
   }
 
   memset(&workRequest, 0, sizeof(ibv_send_wr));
@@ -517,8 +897,8 @@ void QueuePair::multiWriteWithImmediate(
                   "[INFINITY][QUEUES][QUEUEPAIR] Segmentation fault while "
                   "writing to remote memory.\n");
 
-  int returnValue =
-      ibv_post_send(this->ibvQueuePair, &workRequest, &badWorkRequest);
+  int returnValue = postCreditedWorkRequest(
+      &workRequest, buffers.data(), buffers.size());
 
   INFINITY_ASSERT(
       returnValue == 0,
@@ -568,7 +948,7 @@ void QueuePair::read(const std::shared_ptr<infinity::memory::Buffer>& buffer,
   memset(&sgElement, 0, sizeof(ibv_sge));
   sgElement.addr = buffer->getAddress() + localOffset;
   sgElement.length = sizeInBytes;
-  sgElement.lkey = buffer->getLocalKey();
+  sgElement.lkey = buffer->getLocalKey(localOffset);
 
   INFINITY_ASSERT(sizeInBytes <= buffer->getRemainingSizeInBytes(localOffset),
                   "[INFINITY][QUEUES][QUEUEPAIR] Segmentation fault while "
@@ -590,8 +970,7 @@ void QueuePair::read(const std::shared_ptr<infinity::memory::Buffer>& buffer,
                   "[INFINITY][QUEUES][QUEUEPAIR] Segmentation fault while "
                   "reading from remote memory.\n");
 
-  int returnValue =
-      ibv_post_send(this->ibvQueuePair, &workRequest, &badWorkRequest);
+  int returnValue = postWorkRequests(&workRequest, &badWorkRequest);
 
   INFINITY_ASSERT(
       returnValue == 0,
@@ -637,8 +1016,7 @@ void QueuePair::compareAndSwap(
   workRequest.wr.atomic.compare_add = compare;
   workRequest.wr.atomic.swap = swap;
 
-  int returnValue =
-      ibv_post_send(this->ibvQueuePair, &workRequest, &badWorkRequest);
+  int returnValue = postWorkRequests(&workRequest, &badWorkRequest);
 
   INFINITY_ASSERT(
       returnValue == 0,
@@ -653,14 +1031,284 @@ void QueuePair::compareAndSwap(
 void QueuePair::compareAndSwap(const infinity::memory::RegionToken &destination,
                                uint64_t compare, uint64_t swap,
                                infinity::requests::RequestToken *requestToken) {
-  compareAndSwap(destination, defaultAtomic, compare, swap, OperationFlags(),
-                 requestToken);
+  postAtomic(IBV_WR_ATOMIC_CMP_AND_SWP, destination, compare, swap,
+             requestToken);
 }
 
 void QueuePair::fetchAndAdd(const infinity::memory::RegionToken &destination,
                             uint64_t add,
                             infinity::requests::RequestToken *requestToken) {
-  fetchAndAdd(destination, defaultAtomic, add, OperationFlags(), requestToken);
+  postAtomic(IBV_WR_ATOMIC_FETCH_AND_ADD, destination, add, 0, requestToken);
+}
+
+int32_t QueuePair::postWorkRequests(ibv_send_wr *workRequests,
+                                    ibv_send_wr **badWorkRequest) {
+
+  // XRC requests name the receive queue of the remote process
+  if (this->context->usesXrc()) {
+    for (ibv_send_wr *workRequest = workRequests; workRequest != nullptr;
+         workRequest = workRequest->next) {
+      workRequest->qp_type.xrc.remote_srqn =
+          this->remoteSharedReceiveQueueNumber;
+    }
+  }
+  return ibv_post_send(this->ibvQueuePair, workRequests, badWorkRequest);
+}
+
+bool QueuePair::usesFlowControl() { return this->sendCredits != 0; }
+
+uint64_t QueuePair::getSendCredits() {
+  std::lock_guard<std::mutex> lock(this->creditMutex);
+  return getAvailableSendCredits();
+}
+
+uint32_t QueuePair::getNumberOfPendingSends() {
+  std::lock_guard<std::mutex> lock(this->creditMutex);
+  return this->pendingSends.size();
+}
+
+bool QueuePair::postPendingSends() {
+
+  std::lock_guard<std::mutex> lock(this->creditMutex);
+  if (this->creditUpdatePending && !postCreditUpdate()) {
+    return false;
+  }
+  while (!this->pendingSends.empty() && getAvailableSendCredits() > 0) {
+    pending_send_t &pending = this->pendingSends.front();
+    pending.workRequest.sg_list = pending.scatterGatherElements.data();
+    ibv_send_wr *badWorkRequest;
+    int32_t returnValue =
+        postWorkRequests(&pending.workRequest, &badWorkRequest);
+    if (returnValue == ENOMEM) {
+      // Send queue is full, try again on the next poll
+      break;
+    }
+    INFINITY_ASSERT(returnValue == 0,
+                    "[INFINITY][QUEUES][QUEUEPAIR] Posting queued request "
+                    "failed. %s.\n",
+                    strerror(returnValue));
+    ++this->sendCreditsUsed;
+    this->pendingSends.pop_front();
+  }
+  return this->pendingSends.empty();
+}
+
+void QueuePair::setupFlowControl(uint32_t remoteReceiveCredits,
+                                 uint64_t remoteCreditAddress,
+                                 uint32_t remoteCreditKey) {
+
+  if (this->creditBuffer == nullptr || remoteReceiveCredits == 0) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(this->creditMutex);
+  this->sendCredits = remoteReceiveCredits;
+  this->remoteCreditAddress = remoteCreditAddress;
+  this->remoteCreditKey = remoteCreditKey;
+  this->context->flowControlInUse = true;
+}
+
+void QueuePair::resetFlowControl() {
+
+  if (this->creditBuffer == nullptr) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(this->creditMutex);
+  for (pending_send_t &pending : this->pendingSends) {
+    infinity::requests::RequestToken *requestToken =
+        reinterpret_cast<infinity::requests::RequestToken *>(
+            pending.workRequest.wr_id);
+    if (requestToken != nullptr) {
+      requestToken->setStatus(IBV_WC_WR_FLUSH_ERR);
+    }
+  }
+  this->pendingSends.clear();
+  memset(this->creditBuffer->getData(), 0, 2 * sizeof(uint64_t));
+  this->sendCredits = 0;
+  this->sendCreditsUsed = 0;
+  this->receiveCreditsGranted = 0;
+  this->receiveCreditsAnnounced = 0;
+  this->remoteCreditAddress = 0;
+  this->remoteCreditKey = 0;
+  this->numberOfCreditUpdates = 0;
+  this->creditUpdatePending = false;
+}
+
+bool QueuePair::grantsReceiveCredits() { return this->remoteCreditKey != 0; }
+
+void QueuePair::grantReceiveCredit() {
+
+  {
+    std::lock_guard<std::mutex> lock(this->creditMutex);
+    if (this->remoteCreditKey == 0) {
+      return;
+    }
+
+    // Updates are batched. As long as the batch is smaller than the initial
+    // credits, a sender which ran out always gets another update.
+    ++this->receiveCreditsGranted;
+    uint64_t batchSize = std::max(this->options.receiveCredits / 4, 1u);
+    if (this->receiveCreditsGranted - this->receiveCreditsAnnounced <
+        batchSize) {
+      return;
+    }
+
+    // A deferred update announces all credits granted until it is posted
+    if (this->creditUpdatePending || postCreditUpdate()) {
+      return;
+    }
+  }
+
+  // The send queue is full, postPendingSends() tries again
+  this->context->blockQueuePair(this);
+}
+
+// Caller holds the credit mutex
+bool QueuePair::postCreditUpdate() {
+
+  uint64_t *counters =
+      reinterpret_cast<uint64_t *>(this->creditBuffer->getData());
+  counters[1] = this->receiveCreditsGranted;
+
+  ibv_sge sgElement;
+  memset(&sgElement, 0, sizeof(ibv_sge));
+  sgElement.addr = this->creditBuffer->getAddress() + sizeof(uint64_t);
+  sgElement.length = sizeof(uint64_t);
+  sgElement.lkey = this->creditBuffer->getLocalKey();
+
+  ibv_send_wr workRequest;
+  memset(&workRequest, 0, sizeof(ibv_send_wr));
+  workRequest.sg_list = &sgElement;
+  workRequest.num_sge = 1;
+  workRequest.opcode = IBV_WR_RDMA_WRITE;
+  if (this->maxInlineData >= sizeof(uint64_t)) {
+    workRequest.send_flags |= IBV_SEND_INLINE;
+  }
+  // Unsignaled requests only leave the send queue once a later one
+  // completes
+  if ((this->numberOfCreditUpdates + 1) %
+          std::max(this->sendQueueDepth / 2, 1u) ==
+      0) {
+    workRequest.send_flags |= IBV_SEND_SIGNALED;
+  }
+  workRequest.wr.rdma.remote_addr = this->remoteCreditAddress;
+  workRequest.wr.rdma.rkey = this->remoteCreditKey;
+
+  ibv_send_wr *badWorkRequest;
+  int32_t returnValue = postWorkRequests(&workRequest, &badWorkRequest);
+  if (returnValue == ENOMEM) {
+    this->creditUpdatePending = true;
+    return false;
+  }
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][QUEUEPAIR] Posting credit update "
+                  "failed. %s.\n",
+                  strerror(returnValue));
+
+  ++this->numberOfCreditUpdates;
+  this->receiveCreditsAnnounced = this->receiveCreditsGranted;
+  this->creditUpdatePending = false;
+  return true;
+}
+
+int32_t QueuePair::postCreditedWorkRequest(
+    ibv_send_wr *workRequest,
+    const std::shared_ptr<infinity::memory::Buffer> *buffers,
+    uint32_t numberOfBuffers) {
+
+  ibv_send_wr *badWorkRequest;
+  if (this->sendCredits == 0) {
+    return postWorkRequests(workRequest, &badWorkRequest);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->creditMutex);
+
+    // Requests which are already waiting go first
+    if (this->pendingSends.empty() && getAvailableSendCredits() > 0) {
+      int32_t returnValue = postWorkRequests(workRequest, &badWorkRequest);
+      if (returnValue == 0) {
+        ++this->sendCreditsUsed;
+      }
+      return returnValue;
+    }
+
+    // The buffers are kept alive until the request is posted
+    pending_send_t pending;
+    pending.workRequest = *workRequest;
+    pending.workRequest.next = nullptr;
+    pending.scatterGatherElements.assign(
+        workRequest->sg_list, workRequest->sg_list + workRequest->num_sge);
+    pending.buffers.assign(buffers, buffers + numberOfBuffers);
+    this->pendingSends.push_back(std::move(pending));
+  }
+
+  INFINITY_DEBUG("[INFINITY][QUEUES][QUEUEPAIR] Out of credits, request "
+                 "queued (id %lu).\n",
+                 workRequest->wr_id);
+  this->context->blockQueuePair(this);
+  return 0;
+}
+
+// Caller holds the credit mutex
+uint64_t QueuePair::getAvailableSendCredits() {
+  volatile uint64_t *counters =
+      reinterpret_cast<volatile uint64_t *>(this->creditBuffer->getData());
+  return this->sendCredits + counters[0] - this->sendCreditsUsed;
+}
+
+void QueuePair::postAtomic(ibv_wr_opcode opcode,
+                           const infinity::memory::RegionToken &destination,
+                           uint64_t compareAdd, uint64_t swap,
+                           infinity::requests::RequestToken *requestToken) {
+
+  // Every operation with a request token gets its own result slot, results
+  // nobody can read go to the shared scratch slot
+  infinity::memory::AtomicArray *atomicArray = this->context->getAtomicArray();
+  uint32_t slot = infinity::memory::AtomicArray::SCRATCH_SLOT;
+  if (requestToken != nullptr) {
+    requestToken->reset();
+    slot = atomicArray->acquireSlot();
+    requestToken->setAtomicSlot(atomicArray, slot);
+  }
+
+  struct ibv_sge sgElement;
+  struct ibv_send_wr workRequest;
+  struct ibv_send_wr *badWorkRequest;
+
+  memset(&sgElement, 0, sizeof(ibv_sge));
+  sgElement.addr = atomicArray->getAddress(slot);
+  sgElement.length = sizeof(uint64_t);
+  sgElement.lkey = atomicArray->getLocalKey();
+
+  memset(&workRequest, 0, sizeof(ibv_send_wr));
+  workRequest.wr_id = reinterpret_cast<uint64_t>(requestToken);
+  workRequest.sg_list = &sgElement;
+  workRequest.num_sge = 1;
+  workRequest.opcode = opcode;
+  if (requestToken != nullptr) {
+    workRequest.send_flags |= IBV_SEND_SIGNALED;
+  }
+  workRequest.wr.atomic.remote_addr = destination.getAddress();
+  workRequest.wr.atomic.rkey = destination.getRemoteKey();
+  workRequest.wr.atomic.compare_add = compareAdd;
+  workRequest.wr.atomic.swap = swap;
+
+  int returnValue = postWorkRequests(&workRequest, &badWorkRequest);
+
+  if (returnValue != 0 && requestToken != nullptr) {
+    atomicArray->releaseSlot(slot);
+    requestToken->reset();
+  }
+  INFINITY_ASSERT(
+      returnValue == 0,
+      "[INFINITY][QUEUES][QUEUEPAIR] Posting atomic request failed. %s.\n",
+      strerror(errno));
+
+  INFINITY_DEBUG(
+      "[INFINITY][QUEUES][QUEUEPAIR] Atomic request created (id %lu).\n",
+      workRequest.wr_id);
 }
 
 void
@@ -696,8 +1344,7 @@ QueuePair::fetchAndAdd(const infinity::memory::RegionToken &destination,
   workRequest.wr.atomic.rkey = destination.getRemoteKey();
   workRequest.wr.atomic.compare_add = add;
 
-  int returnValue =
-      ibv_post_send(this->ibvQueuePair, &workRequest, &badWorkRequest);
+  int returnValue = postWorkRequests(&workRequest, &badWorkRequest);
 
   INFINITY_ASSERT(
       returnValue == 0,
@@ -709,6 +1356,104 @@ QueuePair::fetchAndAdd(const infinity::memory::RegionToken &destination,
       workRequest.wr_id);
 }
 
+void QueuePair::bindMemoryWindow(
+    const std::shared_ptr<infinity::memory::MemoryWindow> &window,
+    const std::shared_ptr<infinity::memory::Buffer> &buffer, uint64_t offset,
+    uint64_t sizeInBytes, int accessFlags,
+    infinity::requests::RequestToken *requestToken) {
+
+  INFINITY_ASSERT(sizeInBytes > 0 &&
+                      offset + sizeInBytes <= buffer->getSizeInBytes(),
+                  "[INFINITY][QUEUES][QUEUEPAIR] Window exceeds buffer.\n");
+
+  if (requestToken != nullptr) {
+    requestToken->reset();
+  }
+
+  struct ibv_send_wr workRequests[2];
+  struct ibv_send_wr *badWorkRequest;
+  memset(workRequests, 0, sizeof(workRequests));
+
+  // Invalidate an existing binding in the same post, the queue pair
+  // processes both in order
+  struct ibv_send_wr *bindRequest = &workRequests[0];
+  if (window->isBound()) {
+    workRequests[0].opcode = IBV_WR_LOCAL_INV;
+    workRequests[0].invalidate_rkey = window->getRemoteKey();
+    workRequests[0].next = &workRequests[1];
+    bindRequest = &workRequests[1];
+  }
+
+  uint32_t remoteKey = window->nextRemoteKey();
+  bindRequest->wr_id = reinterpret_cast<uint64_t>(requestToken);
+  bindRequest->opcode = IBV_WR_BIND_MW;
+  if (requestToken != nullptr) {
+    bindRequest->send_flags |= IBV_SEND_SIGNALED;
+  }
+  bindRequest->bind_mw.mw = window->ibvMemoryWindow;
+  bindRequest->bind_mw.rkey = remoteKey;
+  bindRequest->bind_mw.bind_info.mr =
+      buffer->getMemoryRegionWithOffset(offset);
+  INFINITY_ASSERT(bindRequest->bind_mw.bind_info.mr ==
+                      buffer->getMemoryRegionWithOffset(offset + sizeInBytes -
+                                                        1),
+                  "[INFINITY][QUEUES][QUEUEPAIR] Window crosses a chunk "
+                  "boundary.\n");
+  bindRequest->bind_mw.bind_info.addr = buffer->getAddress() + offset;
+  bindRequest->bind_mw.bind_info.length = sizeInBytes;
+  bindRequest->bind_mw.bind_info.mw_access_flags = accessFlags;
+
+  int returnValue = postWorkRequests(&workRequests[0], &badWorkRequest);
+
+  INFINITY_ASSERT(
+      returnValue == 0,
+      "[INFINITY][QUEUES][QUEUEPAIR] Posting bind request failed. %s.\n",
+      strerror(errno));
+
+  window->setBound(buffer, buffer->getAddress() + offset, sizeInBytes,
+                   remoteKey);
+
+  INFINITY_DEBUG(
+      "[INFINITY][QUEUES][QUEUEPAIR] Bind request created (id %lu).\n",
+      bindRequest->wr_id);
+}
+
+void QueuePair::invalidateMemoryWindow(
+    const std::shared_ptr<infinity::memory::MemoryWindow> &window,
+    infinity::requests::RequestToken *requestToken) {
+
+  INFINITY_ASSERT(window->isBound(),
+                  "[INFINITY][QUEUES][QUEUEPAIR] Window is not bound.\n");
+
+  if (requestToken != nullptr) {
+    requestToken->reset();
+  }
+
+  struct ibv_send_wr workRequest;
+  struct ibv_send_wr *badWorkRequest;
+
+  memset(&workRequest, 0, sizeof(ibv_send_wr));
+  workRequest.wr_id = reinterpret_cast<uint64_t>(requestToken);
+  workRequest.opcode = IBV_WR_LOCAL_INV;
+  workRequest.invalidate_rkey = window->getRemoteKey();
+  if (requestToken != nullptr) {
+    workRequest.send_flags |= IBV_SEND_SIGNALED;
+  }
+
+  int returnValue = postWorkRequests(&workRequest, &badWorkRequest);
+
+  INFINITY_ASSERT(
+      returnValue == 0,
+      "[INFINITY][QUEUES][QUEUEPAIR] Posting invalidate request failed. %s.\n",
+      strerror(errno));
+
+  window->setUnbound();
+
+  INFINITY_DEBUG(
+      "[INFINITY][QUEUES][QUEUEPAIR] Invalidate request created (id %lu).\n",
+      workRequest.wr_id);
+}
+
 bool QueuePair::hasUserData() { return !userData.empty(); }
 
 uint32_t QueuePair::getUserDataSize() { return userData.size(); }
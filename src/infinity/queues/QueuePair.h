@@ -9,19 +9,27 @@
 #ifndef QUEUES_QUEUEPAIR_H_
 #define QUEUES_QUEUEPAIR_H_
 
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 #include <infiniband/verbs.h>
 
 #include <infinity/core/Context.h>
 #include <infinity/memory/Atomic.h>
+#include <infinity/memory/AtomicArray.h>
 #include <infinity/memory/Buffer.h>
+#include <infinity/memory/MemoryWindow.h>
 #include <infinity/memory/RegionToken.h>
 #include <infinity/requests/RequestToken.h>
 
 namespace infinity {
 namespace queues {
+class DatagramQueuePair;
 class QueuePairFactory;
+class QueuePairPool;
+class RdmaCmQueuePairFactory;
 }
 }
 
@@ -43,15 +51,113 @@ public:
   int ibvFlags();
 };
 
+/**
+ * Queue sizes tailored to a workload. "rpc-small" has a short send queue
+ * with inline data for small messages, "bulk" a deep send queue with
+ * scatter/gather lists and "atomic-only" the minimum for atomics and
+ * reads. Receives always go to the shared receive queue of the context.
+ */
+enum QueuePairProfile { DEFAULT_PROFILE, RPC_SMALL, BULK, ATOMIC_ONLY };
+
+/**
+ * Per queue pair settings, chosen when the queue pair is created
+ */
+class QueuePairOptions {
+
+public:
+  static QueuePairOptions forProfile(QueuePairProfile profile);
+
+  /**
+   * Looks up a profile by name, e.g. "rpc-small"
+   */
+  static bool parseProfile(const std::string &name,
+                           QueuePairProfile &profile);
+
+public:
+  /**
+   * Send queue size, 0 uses the context configuration. Capped by the
+   * device limits.
+   */
+  uint32_t sendQueueDepth = 0;
+  uint32_t numberOfSGEElements = 0;
+  uint32_t maxInlineData = 0;
+
+  /**
+   * Route with GIDs instead of LIDs. Always done on Ethernet ports (RoCE),
+   * where LIDs do not exist.
+   */
+  bool globalRouting = false;
+  uint8_t gidIndex = 0;
+
+  /**
+   * Lane of the queue pair. The service level selects the virtual lane on
+   * InfiniBand, the traffic class carries DSCP and ECN bits on RoCE.
+   */
+  uint8_t serviceLevel = 0;
+  uint8_t trafficClass = 0;
+
+  /**
+   * Flow label used for ECMP hashing, 0 derives one from both queue pair
+   * numbers so that different queue pairs take different paths
+   */
+  uint32_t flowLabel = 0;
+  uint8_t hopLimit = 64;
+
+  /**
+   * Outstanding RDMA reads and atomics as initiator and as responder, 0
+   * uses the device limit. The initiator depth is reduced to what the
+   * remote side accepts when the queue pair is activated.
+   */
+  uint8_t maxReadAtomic = 0;
+  uint8_t maxDestReadAtomic = 0;
+
+  /**
+   * Path MTU as ibv_mtu, 0 uses the active MTU of the port. Both sides
+   * agree on the smaller MTU.
+   */
+  uint8_t pathMtu = 0;
+
+  /**
+   * Retransmission settings, encoded as for ibv_modify_qp
+   */
+  uint8_t timeout = 14;
+  uint8_t retryCount = 7;
+  uint8_t rnrRetry = 7;
+  uint8_t minRnrTimer = 12;
+
+  /**
+   * Credit based flow control for operations which consume a receive at
+   * the remote side (sends and writes with immediate). This many receives
+   * are granted to the remote queue pair, one more each time a buffer is
+   * posted after a receive of the queue pair completed. Operations beyond
+   * the credits wait in a local queue instead of running into RNR NAKs. 0
+   * disables flow control, both sides need to enable it.
+   */
+  uint32_t receiveCredits = 0;
+};
+
 class QueuePair {
 
+  friend class infinity::core::Context;
+  friend class infinity::queues::DatagramQueuePair;
   friend class infinity::queues::QueuePairFactory;
+  friend class infinity::queues::QueuePairPool;
+  friend class infinity::queues::RdmaCmQueuePairFactory;
 
 public:
   /**
    * Constructor
    */
-  QueuePair(const std::shared_ptr<infinity::core::Context>& context);
+  QueuePair(const std::shared_ptr<infinity::core::Context>& context,
+            const QueuePairOptions &options = QueuePairOptions());
+
+  /**
+   * XRC only. Sends through the send queue of another queue pair to a
+   * different process on the same remote node, named by its shared
+   * receive queue number. Needs no activation and receives nothing.
+   */
+  QueuePair(const std::shared_ptr<QueuePair> &sendQueuePair,
+            uint32_t remoteSharedReceiveQueueNumber);
 
   /**
    * Destructor
@@ -67,16 +173,53 @@ public:
                              std::shared_ptr<core::Context>& context,
                              uint16_t remoteDeviceId,
                              uint32_t remoteQueuePairNumber,
-                             uint32_t remoteSequenceNumber);
+                             uint32_t remoteSequenceNumber,
+                             const ibv_gid *remoteGid = nullptr,
+                             const QueuePairOptions *remoteOptions = nullptr,
+                             uint32_t remoteTargetQueuePairNumber = 0,
+                             uint32_t remoteSharedReceiveQueueNumber = 0);
 public:
   /**
-   * Activation methods
+   * Activation methods. The remote GID is required if the queue pair uses
+   * global routing. The read depth and MTU are limited to the remote
+   * options if given. With XRC, the remote target queue pair and shared
+   * receive queue number are required as well.
    */
 
   void activate(uint16_t remoteDeviceId, uint32_t remoteQueuePairNumber,
-                uint32_t remoteSequenceNumber);
+                uint32_t remoteSequenceNumber,
+                const ibv_gid *remoteGid = nullptr,
+                const QueuePairOptions *remoteOptions = nullptr,
+                uint32_t remoteTargetQueuePairNumber = 0,
+                uint32_t remoteSharedReceiveQueueNumber = 0);
   void setRemoteUserData(const std::vector<char> &userData);
 
+public:
+  /**
+   * Error recovery. A failed queue pair, e.g. after the remote side
+   * restarted, is flushed and reset to INIT in place. Outstanding requests
+   * complete with IBV_WC_WR_FLUSH_ERR. Buffers, region tokens and the queue
+   * pair number stay valid, QueuePairFactory::reconnectToRemoteHost
+   * connects the queue pair again.
+   */
+
+  bool hasFailed();
+  void recover();
+
+public:
+  /**
+   * Credit based flow control, see QueuePairOptions::receiveCredits.
+   * Waiting operations are posted as credits arrive, whenever the send
+   * completion queue of the context is polled, or by postPendingSends().
+   * Credit updates which found the send queue full are retried the same
+   * way.
+   */
+
+  bool usesFlowControl();
+  uint64_t getSendCredits();
+  uint32_t getNumberOfPendingSends();
+  bool postPendingSends(); // True if no operation is waiting
+
 public:
   /**
    * User data received during connection setup
@@ -94,6 +237,14 @@ public:
   uint16_t getLocalDeviceId();
   uint32_t getQueuePairNumber();
   uint32_t getSequenceNumber();
+  uint32_t getTargetQueuePairNumber(); // 0 without XRC
+  uint16_t getRemoteDeviceId();
+  uint32_t getRemoteQueuePairNumber();
+  uint32_t getRemoteSharedReceiveQueueNumber();
+  uint32_t getSendQueueDepth();
+  ibv_gid getGid();
+  bool usesGlobalRouting();
+  const QueuePairOptions &getOptions();
 
 public:
   /**
@@ -168,7 +319,11 @@ public:
 
 public:
   /**
-   * Atomic value operations
+   * Atomic value operations. Without an explicit result Atomic, each
+   * operation uses its own slot of the context's atomic array and the
+   * previous value is available through RequestToken::getAtomicValue().
+   * These overloads no longer set the region of the request token, its
+   * getRegion() returns nullptr.
    */
 
   void compareAndSwap(const infinity::memory::RegionToken &destination,
@@ -186,14 +341,111 @@ public:
                    uint64_t add, OperationFlags flags,
                    infinity::requests::RequestToken *requestToken = nullptr);
 
+public:
+  /**
+   * Memory window operations. Binding a bound window invalidates the old
+   * binding first. The window can be accessed remotely once the bind has
+   * completed, tokens created before a rebind become invalid.
+   */
+
+  void bindMemoryWindow(
+      const std::shared_ptr<infinity::memory::MemoryWindow> &window,
+      const std::shared_ptr<infinity::memory::Buffer> &buffer,
+      uint64_t offset, uint64_t sizeInBytes,
+      int accessFlags = IBV_ACCESS_REMOTE_READ | IBV_ACCESS_REMOTE_WRITE,
+      infinity::requests::RequestToken *requestToken = nullptr);
+  void invalidateMemoryWindow(
+      const std::shared_ptr<infinity::memory::MemoryWindow> &window,
+      infinity::requests::RequestToken *requestToken = nullptr);
+
+protected:
+  /**
+   * Moves the queue pair back to INIT through RESET, so that it can be
+   * activated with a new remote side
+   */
+  void recycle();
+
+protected:
+  /**
+   * Opening the random device for every queue pair is expensive, each thread
+   * seeds a generator once instead
+   */
+  static uint32_t randomSequenceNumber();
+
+protected:
+  void resetToInit();
+  void transitionToInit();
+  void createXrcQueuePairs(ibv_qp_cap &capabilities);
+  void transitionToReadyToReceive(ibv_qp *queuePair, uint16_t remoteDeviceId,
+                                  uint32_t remoteQueuePairNumber,
+                                  uint32_t remoteSequenceNumber,
+                                  const ibv_gid *remoteGid);
+  int32_t postWorkRequests(ibv_send_wr *workRequests,
+                           ibv_send_wr **badWorkRequest);
+
+protected:
+  /**
+   * Flow control. The credit buffer holds the credits granted by the
+   * remote side, written by the remote side, and the credits granted to
+   * it, the source of our updates. Both count up from the start of the
+   * connection.
+   */
+  typedef struct {
+    ibv_send_wr workRequest;
+    std::vector<ibv_sge> scatterGatherElements;
+    std::vector<std::shared_ptr<infinity::memory::Buffer> > buffers;
+  } pending_send_t;
+
+  void setupFlowControl(uint32_t remoteReceiveCredits,
+                        uint64_t remoteCreditAddress,
+                        uint32_t remoteCreditKey);
+  void resetFlowControl();
+  bool grantsReceiveCredits();
+  void grantReceiveCredit();
+  bool postCreditUpdate();
+  int32_t postCreditedWorkRequest(
+      ibv_send_wr *workRequest,
+      const std::shared_ptr<infinity::memory::Buffer> *buffers,
+      uint32_t numberOfBuffers);
+  uint64_t getAvailableSendCredits();
+  void postAtomic(ibv_wr_opcode opcode,
+                  const infinity::memory::RegionToken &destination,
+                  uint64_t compareAdd, uint64_t swap,
+                  infinity::requests::RequestToken *requestToken);
+
 protected:
   std::shared_ptr<infinity::core::Context> context;
+  QueuePairOptions options;
+  QueuePairOptions initialOptions;
 
   ibv_qp *ibvQueuePair = nullptr;
+  uint32_t registrySlot = infinity::core::Context::NOT_REGISTERED;
   uint32_t sequenceNumber = 0;
-  std::shared_ptr<infinity::memory::Atomic> defaultAtomic;
+  uint16_t remoteDeviceId = 0;
+  uint32_t remoteQueuePairNumber = 0;
   std::vector<char> userData;
   uint32_t maxNumberOfSGEElements = 0;
+  uint32_t sendQueueDepth = 0;
+  uint32_t maxInlineData = 0;
+
+  /**
+   * XRC receive side and the process addressed on the remote node
+   */
+  ibv_qp *ibvTargetQueuePair = nullptr;
+  uint32_t remoteSharedReceiveQueueNumber = 0;
+  std::shared_ptr<QueuePair> sendQueueOwner;
+
+  std::shared_ptr<infinity::memory::Buffer> creditBuffer;
+  uint32_t sendCredits = 0;
+  uint64_t sendCreditsUsed = 0;
+  uint64_t receiveCreditsGranted = 0;
+  uint64_t receiveCreditsAnnounced = 0;
+  uint64_t remoteCreditAddress = 0;
+  uint32_t remoteCreditKey = 0;
+  uint32_t numberOfCreditUpdates = 0;
+  bool creditUpdatePending = false;
+  std::deque<pending_send_t> pendingSends;
+  std::mutex creditMutex;
 };
 
 } /* namespace queues */
@@ -21,15 +21,6 @@
 namespace infinity {
 namespace queues {
 
-typedef struct {
-
-  uint16_t localDeviceId = 0;
-  uint32_t queuePairNumber = 0;
-  uint32_t sequenceNumber = 0;
-  uint32_t userDataSize = 0;
-
-} serializedQueuePair;
-
 QueuePairFactory::QueuePairFactory(
     const std::shared_ptr<infinity::core::Context> &context)
     : context(context) {}
@@ -99,6 +90,53 @@ int32_t QueuePairFactory::getSocket() const
     return serverSocket;
 }
 
+void QueuePairFactory::setQueuePairOptions(const QueuePairOptions &options) {
+  this->queuePairOptions = options;
+}
+
+const QueuePairOptions &QueuePairFactory::getQueuePairOptions() {
+  return this->queuePairOptions;
+}
+
+void QueuePairFactory::setQueuePairPool(std::shared_ptr<QueuePairPool> pool) {
+  this->queuePairPool = pool;
+}
+
+std::shared_ptr<QueuePair>
+QueuePairFactory::createQueuePair(const QueuePairOptions *options) {
+  if (options == nullptr && this->queuePairPool != nullptr) {
+    return this->queuePairPool->acquire();
+  }
+  return std::make_shared<QueuePair>(
+      this->context, options != nullptr ? *options : this->queuePairOptions);
+}
+
+void QueuePairFactory::describeQueuePair(
+    const std::shared_ptr<QueuePair> &queuePair, uint32_t userDataSizeInBytes,
+    serializedQueuePair &description) {
+
+  description.localDeviceId = queuePair->getLocalDeviceId();
+  description.queuePairNumber = queuePair->getQueuePairNumber();
+  description.sequenceNumber = queuePair->getSequenceNumber();
+  description.userDataSize = userDataSizeInBytes;
+  description.maxReadAtomic = queuePair->getOptions().maxReadAtomic;
+  description.maxDestReadAtomic = queuePair->getOptions().maxDestReadAtomic;
+  description.pathMtu = queuePair->getOptions().pathMtu;
+  description.targetQueuePairNumber = queuePair->getTargetQueuePairNumber();
+  description.sharedReceiveQueueNumber =
+      queuePair->context->getSharedReceiveQueueNumber();
+  description.receiveCredits = queuePair->getOptions().receiveCredits;
+  if (queuePair->creditBuffer != nullptr) {
+    description.creditAddress = queuePair->creditBuffer->getAddress();
+    description.creditKey = queuePair->creditBuffer->getRemoteKey();
+  }
+
+  // Global routing is chosen on each side, the remote side may need the
+  // GID even if this side does not route globally
+  ibv_gid gid = queuePair->getGid();
+  memcpy(description.gid, gid.raw, sizeof(description.gid));
+}
+
 int32_t QueuePairFactory::readFromSocket(int32_t socket, char *buffer,
                                          uint32_t size) {
   int32_t bytesReceived = 0;
@@ -139,7 +177,8 @@ int32_t QueuePairFactory::sendToSocket(int32_t socket, const char *buffer,
 
 std::shared_ptr<QueuePair>
 QueuePairFactory::acceptIncomingConnection(void *userData,
-                                           uint32_t userDataSizeInBytes) {
+                                           uint32_t userDataSizeInBytes,
+                                           const QueuePairOptions *options) {
 
   serializedQueuePair receiveBuffer;
   serializedQueuePair sendBuffer;
@@ -166,12 +205,18 @@ QueuePairFactory::acceptIncomingConnection(void *userData,
                   "received. Expected %lu. Received %d.\n",
                   sizeof(serializedQueuePair), returnValue);
 
-  auto queuePair = std::make_shared<QueuePair>(this->context);
+  // A peer reconnecting after an error gets its old queue pair back
+  std::shared_ptr<QueuePair> queuePair;
+  if (receiveBuffer.reconnect) {
+    queuePair = findReconnectingQueuePair(receiveBuffer);
+  }
+  if (queuePair != nullptr) {
+    queuePair->recover();
+  } else {
+    queuePair = createQueuePair(options);
+  }
 
-  sendBuffer.localDeviceId = queuePair->getLocalDeviceId();
-  sendBuffer.queuePairNumber = queuePair->getQueuePairNumber();
-  sendBuffer.sequenceNumber = queuePair->getSequenceNumber();
-  sendBuffer.userDataSize = userDataSizeInBytes;
+  describeQueuePair(queuePair, userDataSizeInBytes, sendBuffer);
 
   returnValue = sendToSocket(connectionSocket,
                              reinterpret_cast<const char *>(&sendBuffer),
@@ -189,19 +234,8 @@ QueuePairFactory::acceptIncomingConnection(void *userData,
                   "transmitted. Expected %u. Received %d.\n",
                   userDataSizeInBytes, returnValue);
 
-  INFINITY_DEBUG(
-      "[INFINITY][QUEUES][FACTORY] Pairing (%u, %u, %u, %u)-(%u, %u, %u, %u)\n",
-      queuePair->getLocalDeviceId(), queuePair->getQueuePairNumber(),
-      queuePair->getSequenceNumber(), userDataSizeInBytes,
-      receiveBuffer.localDeviceId, receiveBuffer.queuePairNumber,
-      receiveBuffer.sequenceNumber, receiveBuffer.userDataSize);
-
-  queuePair->activate(receiveBuffer.localDeviceId,
-                      receiveBuffer.queuePairNumber,
-                      receiveBuffer.sequenceNumber);
-  queuePair->setRemoteUserData(userDataBuffer);
-
-  this->context->registerQueuePair(queuePair);
+  pairQueuePair(queuePair, userDataSizeInBytes, receiveBuffer,
+                userDataBuffer);
 
   close(connectionSocket);
 
@@ -211,7 +245,28 @@ QueuePairFactory::acceptIncomingConnection(void *userData,
 std::shared_ptr<QueuePair>
 QueuePairFactory::connectToRemoteHost(const char *hostAddress, uint16_t port,
                                       void *userData,
-                                      uint32_t userDataSizeInBytes) {
+                                      uint32_t userDataSizeInBytes,
+                                      const QueuePairOptions *options) {
+
+  auto queuePair = createQueuePair(options);
+  connectQueuePair(queuePair, hostAddress, port, userData,
+                   userDataSizeInBytes, false);
+  return queuePair;
+}
+
+void QueuePairFactory::reconnectToRemoteHost(
+    const std::shared_ptr<QueuePair> &queuePair, const char *hostAddress,
+    uint16_t port, void *userData, uint32_t userDataSizeInBytes) {
+
+  queuePair->recover();
+  connectQueuePair(queuePair, hostAddress, port, userData,
+                   userDataSizeInBytes, true);
+}
+
+void QueuePairFactory::connectQueuePair(
+    const std::shared_ptr<QueuePair> &queuePair, const char *hostAddress,
+    uint16_t port, void *userData, uint32_t userDataSizeInBytes,
+    bool reconnect) {
 
   INFINITY_ASSERT(
       userDataSizeInBytes <
@@ -244,12 +299,11 @@ QueuePairFactory::connectToRemoteHost(const char *hostAddress, uint16_t port,
   INFINITY_ASSERT(returnValue == 0,
                   "[INFINITY][QUEUES][FACTORY] Could not connect to server.\n");
 
-  auto queuePair = std::make_shared<QueuePair>(this->context);
-
-  sendBuffer.localDeviceId = queuePair->getLocalDeviceId();
-  sendBuffer.queuePairNumber = queuePair->getQueuePairNumber();
-  sendBuffer.sequenceNumber = queuePair->getSequenceNumber();
-  sendBuffer.userDataSize = userDataSizeInBytes;
+  describeQueuePair(queuePair, userDataSizeInBytes, sendBuffer);
+  if (reconnect) {
+    sendBuffer.reconnect = 1;
+    sendBuffer.previousQueuePairNumber = queuePair->getRemoteQueuePairNumber();
+  }
 
   returnValue =
       sendToSocket(connectionSocket, reinterpret_cast<char *>(&sendBuffer),
@@ -283,32 +337,76 @@ QueuePairFactory::connectToRemoteHost(const char *hostAddress, uint16_t port,
                   "received. Expected %u. Received %d.\n",
                   receiveBuffer.userDataSize, returnValue);
 
+  pairQueuePair(queuePair, userDataSizeInBytes, receiveBuffer,
+                userDataBuffer);
+
+  close(connectionSocket);
+}
+
+std::shared_ptr<QueuePair> QueuePairFactory::findReconnectingQueuePair(
+    const serializedQueuePair &request) {
+
+  std::shared_ptr<QueuePair> queuePair =
+      this->context->findQueuePair(request.previousQueuePairNumber);
+  if (queuePair == nullptr ||
+      queuePair->getRemoteDeviceId() != request.localDeviceId ||
+      queuePair->getRemoteQueuePairNumber() != request.queuePairNumber) {
+    INFINITY_DEBUG("[INFINITY][QUEUES][FACTORY] Queue pair %u of the "
+                   "reconnecting peer is unknown, accepting a new "
+                   "connection.\n",
+                   request.previousQueuePairNumber);
+    return nullptr;
+  }
+  return queuePair;
+}
+
+void QueuePairFactory::pairQueuePair(
+    const std::shared_ptr<QueuePair> &queuePair, uint32_t userDataSizeInBytes,
+    const serializedQueuePair &remoteQueuePair,
+    const std::vector<char> &remoteUserData) {
+
   INFINITY_DEBUG(
       "[INFINITY][QUEUES][FACTORY] Pairing (%u, %u, %u, %u)-(%u, %u, %u, %u)\n",
       queuePair->getLocalDeviceId(), queuePair->getQueuePairNumber(),
       queuePair->getSequenceNumber(), userDataSizeInBytes,
-      receiveBuffer.localDeviceId, receiveBuffer.queuePairNumber,
-      receiveBuffer.sequenceNumber, receiveBuffer.userDataSize);
-
-  queuePair->activate(receiveBuffer.localDeviceId,
-                      receiveBuffer.queuePairNumber,
-                      receiveBuffer.sequenceNumber);
-  queuePair->setRemoteUserData(userDataBuffer);
+      remoteQueuePair.localDeviceId, remoteQueuePair.queuePairNumber,
+      remoteQueuePair.sequenceNumber, remoteQueuePair.userDataSize);
+
+  ibv_gid remoteGid;
+  memcpy(remoteGid.raw, remoteQueuePair.gid, sizeof(remoteGid.raw));
+  QueuePairOptions remoteOptions;
+  remoteOptions.maxReadAtomic = remoteQueuePair.maxReadAtomic;
+  remoteOptions.maxDestReadAtomic = remoteQueuePair.maxDestReadAtomic;
+  remoteOptions.pathMtu = remoteQueuePair.pathMtu;
+  queuePair->activate(remoteQueuePair.localDeviceId,
+                      remoteQueuePair.queuePairNumber,
+                      remoteQueuePair.sequenceNumber, &remoteGid,
+                      &remoteOptions, remoteQueuePair.targetQueuePairNumber,
+                      remoteQueuePair.sharedReceiveQueueNumber);
+  queuePair->setupFlowControl(remoteQueuePair.receiveCredits,
+                              remoteQueuePair.creditAddress,
+                              remoteQueuePair.creditKey);
+  queuePair->setRemoteUserData(remoteUserData);
 
   this->context->registerQueuePair(queuePair);
-
-  close(connectionSocket);
-
-  return queuePair;
 }
 
 std::shared_ptr<QueuePair>
-QueuePairFactory::createLoopback(const std::vector<char> &userData) {
+QueuePairFactory::createLoopback(const std::vector<char> &userData,
+                                 const QueuePairOptions *options) {
 
-  auto queuePair = std::make_shared<QueuePair>(this->context);
+  auto queuePair = createQueuePair(options);
+  ibv_gid gid = queuePair->getGid();
   queuePair->activate(queuePair->getLocalDeviceId(),
                       queuePair->getQueuePairNumber(),
-                      queuePair->getSequenceNumber());
+                      queuePair->getSequenceNumber(), &gid, nullptr,
+                      queuePair->getTargetQueuePairNumber(),
+                      this->context->getSharedReceiveQueueNumber());
+  if (queuePair->creditBuffer != nullptr) {
+    queuePair->setupFlowControl(queuePair->getOptions().receiveCredits,
+                                queuePair->creditBuffer->getAddress(),
+                                queuePair->creditBuffer->getRemoteKey());
+  }
   queuePair->setRemoteUserData(userData);
 
   this->context->registerQueuePair(queuePair);
@@ -16,11 +16,40 @@
 
 #include <infinity/core/Context.h>
 #include <infinity/queues/QueuePair.h>
+#include <infinity/queues/QueuePairPool.h>
 
 namespace infinity {
 namespace queues {
 
+class ConnectionEngine;
+
+/**
+ * Connection request and reply, followed by userDataSize bytes of user data
+ */
+typedef struct {
+
+  uint16_t localDeviceId = 0;
+  uint32_t queuePairNumber = 0;
+  uint32_t sequenceNumber = 0;
+  uint32_t userDataSize = 0;
+  uint8_t gid[16] = {};
+  uint8_t maxReadAtomic = 0;
+  uint8_t maxDestReadAtomic = 0;
+  uint8_t pathMtu = 0;
+  uint32_t targetQueuePairNumber = 0;
+  uint32_t sharedReceiveQueueNumber = 0;
+  uint8_t reconnect = 0;
+  uint32_t previousQueuePairNumber = 0;
+  uint32_t receiveCredits = 0;
+  uint64_t creditAddress = 0;
+  uint32_t creditKey = 0;
+
+} serializedQueuePair;
+
 class QueuePairFactory {
+
+  friend class infinity::queues::ConnectionEngine;
+
 public:
   QueuePairFactory(const std::shared_ptr<infinity::core::Context> &context);
   ~QueuePairFactory();
@@ -42,12 +71,25 @@ public:
    */
   int32_t getSocket() const;
 
+  /**
+   * Options of queue pairs created without explicit options
+   */
+  void setQueuePairOptions(const QueuePairOptions &options);
+  const QueuePairOptions &getQueuePairOptions();
+
+  /**
+   * Queue pairs created without explicit options are taken from the pool
+   * and return to it when dropped
+   */
+  void setQueuePairPool(std::shared_ptr<QueuePairPool> pool);
+
   /**
    * Accept incoming connection request (passive side)
    */
   std::shared_ptr<QueuePair>
   acceptIncomingConnection(void *userData = nullptr,
-                           uint32_t userDataSizeInBytes = 0);
+                           uint32_t userDataSizeInBytes = 0,
+                           const QueuePairOptions *options = nullptr);
 
   /**
    * Connect to remote machine (active side)
@@ -55,17 +97,68 @@ public:
   std::shared_ptr<QueuePair>
   connectToRemoteHost(const char *hostAddress, uint16_t port,
                       void *userData = nullptr,
-                      uint32_t userDataSizeInBytes = 0);
+                      uint32_t userDataSizeInBytes = 0,
+                      const QueuePairOptions *options = nullptr);
 
   /**
-   * Create loopback queue pair
+   * Recover a failed queue pair and connect it again. If the remote side
+   * still has the queue pair it was connected to, that one is recovered
+   * and reused as well, otherwise the remote side accepts a new connection.
    */
-  std::shared_ptr<QueuePair> createLoopback(const std::vector<char> &userData);
+  void reconnectToRemoteHost(const std::shared_ptr<QueuePair> &queuePair,
+                             const char *hostAddress, uint16_t port,
+                             void *userData = nullptr,
+                             uint32_t userDataSizeInBytes = 0);
+
+  /**
+   * Create loopback queue pair. Without options, the queue pair uses the
+   * options of the factory.
+   */
+  std::shared_ptr<QueuePair>
+  createLoopback(const std::vector<char> &userData,
+                 const QueuePairOptions *options = nullptr);
 
 protected:
   std::shared_ptr<infinity::core::Context> context;
 
   int32_t serverSocket = -1;
+  QueuePairOptions queuePairOptions;
+  std::shared_ptr<QueuePairPool> queuePairPool;
+
+  /**
+   * Creates a queue pair with options, or the default options if nullptr.
+   * The latter come from the pool if there is one.
+   */
+  std::shared_ptr<QueuePair> createQueuePair(const QueuePairOptions *options);
+
+  /**
+   * Client side of the handshake
+   */
+  void connectQueuePair(const std::shared_ptr<QueuePair> &queuePair,
+                        const char *hostAddress, uint16_t port,
+                        void *userData, uint32_t userDataSizeInBytes,
+                        bool reconnect);
+
+  /**
+   * Local queue pair a reconnect request refers to, nullptr if it is gone
+   */
+  std::shared_ptr<QueuePair>
+  findReconnectingQueuePair(const serializedQueuePair &request);
+
+  /**
+   * Fills in the local side of a connection request or reply
+   */
+  static void describeQueuePair(const std::shared_ptr<QueuePair> &queuePair,
+                                uint32_t userDataSizeInBytes,
+                                serializedQueuePair &description);
+
+  /**
+   * Activate a queue pair with the information received from the remote side
+   */
+  void pairQueuePair(const std::shared_ptr<QueuePair> &queuePair,
+                     uint32_t userDataSizeInBytes,
+                     const serializedQueuePair &remoteQueuePair,
+                     const std::vector<char> &remoteUserData);
 
 private:
   int32_t readFromSocket(int32_t socket, char *buffer, uint32_t size);
@@ -0,0 +1,173 @@
+/**
+ * Queues - Queue Pair Pool
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "QueuePairPool.h"
+
+#include <chrono>
+
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace queues {
+
+QueuePairPool::QueuePairPool(
+    std::shared_ptr<infinity::core::Context> context,
+    const QueuePairOptions &options)
+    : QueuePairPool(context, options,
+                    context->getConfiguration().queuePairPoolSize,
+                    context->getConfiguration().queuePairPoolRefillRate) {}
+
+QueuePairPool::QueuePairPool(
+    std::shared_ptr<infinity::core::Context> context,
+    const QueuePairOptions &options, uint32_t size, uint32_t refillRate)
+    : context(context), options(options), size(size), refillRate(refillRate) {
+
+  this->refillThread = std::thread(&QueuePairPool::run, this);
+}
+
+QueuePairPool::~QueuePairPool() {
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->running = false;
+  }
+  this->condition.notify_all();
+  this->refillThread.join();
+}
+
+std::shared_ptr<QueuePair> QueuePairPool::acquire() {
+
+  std::unique_ptr<QueuePair> queuePair;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!this->idleQueuePairs.empty()) {
+      queuePair = std::move(this->idleQueuePairs.front());
+      this->idleQueuePairs.pop_front();
+      ++this->hits;
+    } else {
+      ++this->misses;
+    }
+  }
+  this->condition.notify_all();
+
+  if (queuePair == nullptr) {
+    queuePair.reset(new QueuePair(this->context, this->options));
+  }
+
+  // The queue pair comes back once the connection is dropped
+  std::weak_ptr<QueuePairPool> pool = shared_from_this();
+  return std::shared_ptr<QueuePair>(queuePair.release(),
+                                    [pool](QueuePair *queuePair) {
+    std::shared_ptr<QueuePairPool> owner = pool.lock();
+    if (owner != nullptr) {
+      owner->release(queuePair);
+    } else {
+      delete queuePair;
+    }
+  });
+}
+
+bool QueuePairPool::waitUntilFull(uint32_t timeoutInMilliseconds) {
+
+  std::unique_lock<std::mutex> lock(this->mutex);
+  return this->condition.wait_for(
+      lock, std::chrono::milliseconds(timeoutInMilliseconds),
+      [this] { return this->idleQueuePairs.size() >= this->size; });
+}
+
+uint32_t QueuePairPool::getSize() { return this->size; }
+
+uint32_t QueuePairPool::getNumberOfIdleQueuePairs() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->idleQueuePairs.size();
+}
+
+uint64_t QueuePairPool::getNumberOfHits() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->hits;
+}
+
+uint64_t QueuePairPool::getNumberOfMisses() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->misses;
+}
+
+uint64_t QueuePairPool::getNumberOfRecycledQueuePairs() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->recycled;
+}
+
+void QueuePairPool::release(QueuePair *queuePair) {
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->releasedQueuePairs.emplace_back(queuePair);
+  }
+  this->condition.notify_all();
+}
+
+void QueuePairPool::run() {
+
+  std::chrono::microseconds interval(
+      this->refillRate > 0 ? 1000000 / this->refillRate : 0);
+
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while (this->running) {
+
+    // Released queue pairs are reset before new ones are created
+    if (!this->releasedQueuePairs.empty()) {
+      std::unique_ptr<QueuePair> queuePair =
+          std::move(this->releasedQueuePairs.front());
+      this->releasedQueuePairs.pop_front();
+      bool keep = this->idleQueuePairs.size() < this->size;
+      lock.unlock();
+      if (keep) {
+        queuePair->recycle();
+      } else {
+        queuePair.reset();
+      }
+      lock.lock();
+      if (keep) {
+        this->idleQueuePairs.push_back(std::move(queuePair));
+        ++this->recycled;
+        this->condition.notify_all();
+      }
+      continue;
+    }
+
+    if (this->idleQueuePairs.size() < this->size) {
+      lock.unlock();
+      std::unique_ptr<QueuePair> queuePair(
+          new QueuePair(this->context, this->options));
+      lock.lock();
+      this->idleQueuePairs.push_back(std::move(queuePair));
+      this->condition.notify_all();
+      if (interval.count() > 0) {
+        this->condition.wait_for(lock, interval,
+                                 [this] { return !this->running; });
+      }
+      continue;
+    }
+
+    this->condition.wait(lock);
+  }
+
+  // Queue pairs still in use are deleted when they are dropped
+  std::deque<std::unique_ptr<QueuePair> > idle;
+  idle.swap(this->idleQueuePairs);
+  std::deque<std::unique_ptr<QueuePair> > released;
+  released.swap(this->releasedQueuePairs);
+  lock.unlock();
+
+  INFINITY_DEBUG("[INFINITY][QUEUES][POOL] Stopping with %lu hits and %lu "
+                 "misses.\n",
+                 this->hits, this->misses);
+}
+
+} /* namespace queues */
+} /* namespace infinity */
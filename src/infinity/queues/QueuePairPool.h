@@ -0,0 +1,94 @@
+/**
+ * Queues - Queue Pair Pool
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef QUEUES_QUEUEPAIRPOOL_H_
+#define QUEUES_QUEUEPAIRPOOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+
+#include <infinity/core/Context.h>
+#include <infinity/queues/QueuePair.h>
+
+namespace infinity {
+namespace queues {
+
+/**
+ * Keeps queue pairs in INIT state ready for new connections. A background
+ * thread creates them ahead of time. Queue pairs handed out by acquire()
+ * return to the pool when the last reference is dropped, they are reset to
+ * INIT and reused. Must be owned by a shared pointer.
+ */
+class QueuePairPool : public std::enable_shared_from_this<QueuePairPool> {
+
+public:
+  /**
+   * Size and refill rate (queue pairs per second, 0 is unlimited) are read
+   * from the configuration of the context unless given
+   */
+  QueuePairPool(std::shared_ptr<infinity::core::Context> context,
+                const QueuePairOptions &options = QueuePairOptions());
+  QueuePairPool(std::shared_ptr<infinity::core::Context> context,
+                const QueuePairOptions &options, uint32_t size,
+                uint32_t refillRate);
+  ~QueuePairPool();
+
+  QueuePairPool(const QueuePairPool &) = delete;
+  QueuePairPool(const QueuePairPool &&) = delete;
+  QueuePairPool &operator=(const QueuePairPool &) = delete;
+  QueuePairPool &operator=(QueuePairPool &&) = delete;
+
+public:
+  /**
+   * Returns a queue pair in INIT state. Creates one if the pool is empty.
+   */
+  std::shared_ptr<QueuePair> acquire();
+
+  /**
+   * Blocks until the pool is full or timeoutInMilliseconds passed
+   */
+  bool waitUntilFull(uint32_t timeoutInMilliseconds);
+
+public:
+  uint32_t getSize();
+  uint32_t getNumberOfIdleQueuePairs();
+  uint64_t getNumberOfHits();
+  uint64_t getNumberOfMisses();
+  uint64_t getNumberOfRecycledQueuePairs();
+
+protected:
+  void release(QueuePair *queuePair);
+  void run();
+
+protected:
+  std::shared_ptr<infinity::core::Context> context;
+  QueuePairOptions options;
+  uint32_t size = 0;
+  uint32_t refillRate = 0;
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::deque<std::unique_ptr<QueuePair> > idleQueuePairs;
+  std::deque<std::unique_ptr<QueuePair> > releasedQueuePairs;
+  bool running = true;
+
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t recycled = 0;
+
+  std::thread refillThread;
+};
+
+} /* namespace queues */
+} /* namespace infinity */
+
+#endif /* QUEUES_QUEUEPAIRPOOL_H_ */
@@ -0,0 +1,336 @@
+/**
+ * Queues - RDMA CM Queue Pair Factory
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "RdmaCmQueuePairFactory.h"
+
+#ifdef INFINITY_RDMACM_ON
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <string.h>
+
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace queues {
+
+RdmaCmQueuePairFactory::RdmaCmQueuePairFactory(
+    const std::shared_ptr<infinity::core::Context> &context)
+    : context(context) {
+
+  // The connection manager only knows about a single queue pair number
+  INFINITY_ASSERT(!context->usesXrc(),
+                  "[INFINITY][QUEUES][CMFACTORY] XRC contexts are not "
+                  "supported, use QueuePairFactory.\n");
+}
+
+RdmaCmQueuePairFactory::~RdmaCmQueuePairFactory() {
+
+  for (rdma_cm_id *id : this->connectionIds) {
+    rdma_disconnect(id);
+    rdma_destroy_id(id);
+  }
+  for (rdma_event_channel *channel : this->connectionChannels) {
+    rdma_destroy_event_channel(channel);
+  }
+
+  if (this->listenId != nullptr) {
+    rdma_destroy_id(this->listenId);
+  }
+  if (this->eventChannel != nullptr) {
+    rdma_destroy_event_channel(this->eventChannel);
+  }
+}
+
+void RdmaCmQueuePairFactory::bindToPort(uint16_t port) {
+
+  this->eventChannel = rdma_create_event_channel();
+  INFINITY_ASSERT(this->eventChannel != nullptr,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot create event "
+                  "channel.\n");
+
+  int32_t returnValue = rdma_create_id(this->eventChannel, &this->listenId,
+                                       nullptr, RDMA_PS_TCP);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot create id. %s.\n",
+                  strerror(errno));
+
+  sockaddr_in address;
+  memset(&address, 0, sizeof(sockaddr_in));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+
+  returnValue =
+      rdma_bind_addr(this->listenId, reinterpret_cast<sockaddr *>(&address));
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot bind to port %u. "
+                  "%s.\n",
+                  port, strerror(errno));
+
+  returnValue = rdma_listen(this->listenId, 128);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot listen. %s.\n",
+                  strerror(errno));
+
+  INFINITY_DEBUG("[INFINITY][QUEUES][CMFACTORY] Accepting connections on "
+                 "port %u.\n",
+                 port);
+}
+
+std::shared_ptr<QueuePair> RdmaCmQueuePairFactory::acceptIncomingConnection(
+    void *userData, uint32_t userDataSizeInBytes) {
+
+  INFINITY_ASSERT(userDataSizeInBytes <= MAX_ACCEPT_USER_DATA_SIZE,
+                  "[INFINITY][QUEUES][CMFACTORY] User data size is too "
+                  "large.\n");
+  INFINITY_ASSERT(this->listenId != nullptr,
+                  "[INFINITY][QUEUES][CMFACTORY] Factory is not bound to a "
+                  "port.\n");
+
+  rdma_cm_id *id = nullptr;
+  std::vector<char> remoteUserData;
+  waitForEvent(this->eventChannel, RDMA_CM_EVENT_CONNECT_REQUEST, &id,
+               &remoteUserData);
+  checkDevice(id);
+
+  // Move the id to a channel of its own, later events of this connection
+  // must not show up where the next connection request is expected
+  rdma_event_channel *channel = rdma_create_event_channel();
+  INFINITY_ASSERT(channel != nullptr,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot create event "
+                  "channel.\n");
+  int32_t returnValue = rdma_migrate_id(id, channel);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot migrate id. %s.\n",
+                  strerror(errno));
+
+  // The passive side has to be ready to receive before it accepts
+  auto queuePair = std::make_shared<QueuePair>(this->context);
+  transition(id, queuePair, IBV_QPS_RTR);
+  transition(id, queuePair, IBV_QPS_RTS);
+
+  rdma_conn_param parameters;
+  std::vector<char> privateData;
+  setConnectionParameters(parameters, queuePair, privateData, userData,
+                          userDataSizeInBytes);
+  returnValue = rdma_accept(id, &parameters);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot accept connection. "
+                  "%s.\n",
+                  strerror(errno));
+
+  waitForEvent(channel, RDMA_CM_EVENT_ESTABLISHED, nullptr, nullptr);
+  this->connectionIds.push_back(id);
+  this->connectionChannels.push_back(channel);
+
+  queuePair->setRemoteUserData(remoteUserData);
+  this->context->registerQueuePair(queuePair);
+
+  INFINITY_DEBUG("[INFINITY][QUEUES][CMFACTORY] Accepted queue pair %u.\n",
+                 queuePair->getQueuePairNumber());
+
+  return queuePair;
+}
+
+std::shared_ptr<QueuePair> RdmaCmQueuePairFactory::connectToRemoteHost(
+    const char *hostAddress, uint16_t port, void *userData,
+    uint32_t userDataSizeInBytes) {
+
+  INFINITY_ASSERT(userDataSizeInBytes <= MAX_CONNECT_USER_DATA_SIZE,
+                  "[INFINITY][QUEUES][CMFACTORY] User data size is too "
+                  "large.\n");
+
+  addrinfo hints;
+  memset(&hints, 0, sizeof(addrinfo));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo *remoteAddress = nullptr;
+  int32_t returnValue = getaddrinfo(hostAddress, std::to_string(port).c_str(),
+                                    &hints, &remoteAddress);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][CMFACTORY] Unable to get IP address for "
+                  "%s: %s.\n",
+                  hostAddress, gai_strerror(returnValue));
+
+  // Every connection gets its own channel so events are never mixed up
+  rdma_event_channel *channel = rdma_create_event_channel();
+  INFINITY_ASSERT(channel != nullptr,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot create event "
+                  "channel.\n");
+  rdma_cm_id *id = nullptr;
+  returnValue = rdma_create_id(channel, &id, nullptr, RDMA_PS_TCP);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot create id. %s.\n",
+                  strerror(errno));
+
+  returnValue = rdma_resolve_addr(id, nullptr, remoteAddress->ai_addr,
+                                  RESOLVE_TIMEOUT_IN_MILLISECONDS);
+  freeaddrinfo(remoteAddress);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot resolve address of "
+                  "%s. %s.\n",
+                  hostAddress, strerror(errno));
+  waitForEvent(channel, RDMA_CM_EVENT_ADDR_RESOLVED, nullptr, nullptr);
+  checkDevice(id);
+
+  returnValue = rdma_resolve_route(id, RESOLVE_TIMEOUT_IN_MILLISECONDS);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot resolve route to %s. "
+                  "%s.\n",
+                  hostAddress, strerror(errno));
+  waitForEvent(channel, RDMA_CM_EVENT_ROUTE_RESOLVED, nullptr, nullptr);
+
+  auto queuePair = std::make_shared<QueuePair>(this->context);
+
+  rdma_conn_param parameters;
+  std::vector<char> privateData;
+  setConnectionParameters(parameters, queuePair, privateData, userData,
+                          userDataSizeInBytes);
+  returnValue = rdma_connect(id, &parameters);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot connect to %s. %s.\n",
+                  hostAddress, strerror(errno));
+
+  // Without a queue pair attached to the id, the reply is delivered as a
+  // connect response and the connection is established by hand
+  std::vector<char> remoteUserData;
+  waitForEvent(channel, RDMA_CM_EVENT_CONNECT_RESPONSE, nullptr,
+               &remoteUserData);
+  transition(id, queuePair, IBV_QPS_RTR);
+  transition(id, queuePair, IBV_QPS_RTS);
+  returnValue = rdma_establish(id);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot establish connection "
+                  "to %s. %s.\n",
+                  hostAddress, strerror(errno));
+
+  this->connectionIds.push_back(id);
+  this->connectionChannels.push_back(channel);
+
+  queuePair->setRemoteUserData(remoteUserData);
+  this->context->registerQueuePair(queuePair);
+
+  INFINITY_DEBUG("[INFINITY][QUEUES][CMFACTORY] Connected queue pair %u to "
+                 "%s:%u.\n",
+                 queuePair->getQueuePairNumber(), hostAddress, port);
+
+  return queuePair;
+}
+
+void RdmaCmQueuePairFactory::waitForEvent(rdma_event_channel *channel,
+                                          rdma_cm_event_type type,
+                                          rdma_cm_id **id,
+                                          std::vector<char> *userData) {
+
+  rdma_cm_event *event = nullptr;
+  int32_t returnValue = rdma_get_cm_event(channel, &event);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot get event. %s.\n",
+                  strerror(errno));
+  INFINITY_ASSERT(event->event == type,
+                  "[INFINITY][QUEUES][CMFACTORY] Expected %s but got %s "
+                  "(status %d).\n",
+                  rdma_event_str(type), rdma_event_str(event->event),
+                  event->status);
+
+  if (id != nullptr) {
+    *id = event->id;
+  }
+
+  // Private data may be padded by the transport, the length comes first
+  if (userData != nullptr) {
+    const char *privateData =
+        reinterpret_cast<const char *>(event->param.conn.private_data);
+    uint32_t length = 0;
+    if (privateData != nullptr &&
+        event->param.conn.private_data_len >= sizeof(uint32_t)) {
+      memcpy(&length, privateData, sizeof(uint32_t));
+    }
+    INFINITY_ASSERT(length + sizeof(uint32_t) <=
+                        std::max<uint32_t>(event->param.conn.private_data_len,
+                                           sizeof(uint32_t)),
+                    "[INFINITY][QUEUES][CMFACTORY] Private data is "
+                    "truncated.\n");
+    userData->assign(privateData + sizeof(uint32_t),
+                     privateData + sizeof(uint32_t) + length);
+  }
+
+  rdma_ack_cm_event(event);
+}
+
+void RdmaCmQueuePairFactory::checkDevice(rdma_cm_id *id) {
+
+  // The connection manager opens devices on its own, the address has to
+  // resolve to the device of the context
+  const char *deviceName = ibv_get_device_name(id->verbs->device);
+  INFINITY_ASSERT(strcmp(deviceName,
+                         ibv_get_device_name(this->context->ibvDevice)) == 0 &&
+                      id->port_num == this->context->getDevicePort(),
+                  "[INFINITY][QUEUES][CMFACTORY] Address resolves to %s port "
+                  "%u, which is not the device of the context.\n",
+                  deviceName, id->port_num);
+}
+
+void RdmaCmQueuePairFactory::transition(
+    rdma_cm_id *id, const std::shared_ptr<QueuePair> &queuePair,
+    ibv_qp_state state) {
+
+  ibv_qp_attr qpAttributes;
+  memset(&qpAttributes, 0, sizeof(ibv_qp_attr));
+  qpAttributes.qp_state = state;
+  int attributeMask = 0;
+
+  int32_t returnValue = rdma_init_qp_attr(id, &qpAttributes, &attributeMask);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot get queue pair "
+                  "attributes. %s.\n",
+                  strerror(errno));
+
+  returnValue =
+      ibv_modify_qp(queuePair->ibvQueuePair, &qpAttributes, attributeMask);
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][QUEUES][CMFACTORY] Cannot transition queue "
+                  "pair to state %d. %s.\n",
+                  state, strerror(errno));
+
+  // The connection manager picks the sequence numbers
+  if (state == IBV_QPS_RTS) {
+    queuePair->sequenceNumber = qpAttributes.sq_psn;
+  }
+}
+
+void RdmaCmQueuePairFactory::setConnectionParameters(
+    rdma_conn_param &parameters, const std::shared_ptr<QueuePair> &queuePair,
+    std::vector<char> &privateData, void *userData,
+    uint32_t userDataSizeInBytes) {
+
+  privateData.resize(sizeof(uint32_t) + userDataSizeInBytes);
+  memcpy(&privateData[0], &userDataSizeInBytes, sizeof(uint32_t));
+  if (userDataSizeInBytes > 0) {
+    memcpy(&privateData[sizeof(uint32_t)], userData, userDataSizeInBytes);
+  }
+
+  memset(&parameters, 0, sizeof(rdma_conn_param));
+  parameters.private_data = &privateData[0];
+  parameters.private_data_len = static_cast<uint8_t>(privateData.size());
+  // The connection manager agrees on the read depth of both sides
+  const QueuePairOptions &options = queuePair->getOptions();
+  parameters.responder_resources = options.maxDestReadAtomic;
+  parameters.initiator_depth = options.maxReadAtomic;
+  parameters.retry_count = options.retryCount;
+  parameters.rnr_retry_count = options.rnrRetry;
+  parameters.srq = 1;
+  parameters.qp_num = queuePair->getQueuePairNumber();
+}
+
+} /* namespace queues */
+} /* namespace infinity */
+
+#endif /* INFINITY_RDMACM_ON */
@@ -0,0 +1,110 @@
+/**
+ * Queues - RDMA CM Queue Pair Factory
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#ifndef QUEUES_RDMACMQUEUEPAIRFACTORY_H_
+#define QUEUES_RDMACMQUEUEPAIRFACTORY_H_
+
+#ifdef INFINITY_RDMACM_ON
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+#include <rdma/rdma_cma.h>
+
+#include <infinity/core/Context.h>
+#include <infinity/queues/QueuePair.h>
+
+namespace infinity {
+namespace queues {
+
+/**
+ * Connection setup through the RDMA connection manager instead of a TCP
+ * side channel. Address and route resolution, GID selection and the
+ * exchange of queue pair numbers and PSNs are left to librdmacm, which
+ * works the same on InfiniBand, RoCE and soft-RoCE.
+ *
+ * Queue pairs are created by the library as usual and driven through
+ * rdma_init_qp_attr(), the connection manager never owns them. User data
+ * travels as private data and is therefore small.
+ *
+ * Only available if the library is built with RDMACM=1.
+ */
+class RdmaCmQueuePairFactory {
+
+public:
+  /**
+   * Private data limits of the RDMA CM for the TCP port space, minus the
+   * length prefix
+   */
+  static const uint32_t MAX_CONNECT_USER_DATA_SIZE = 52;
+  static const uint32_t MAX_ACCEPT_USER_DATA_SIZE = 192;
+
+  static const int32_t RESOLVE_TIMEOUT_IN_MILLISECONDS = 2000;
+
+public:
+  RdmaCmQueuePairFactory(
+      const std::shared_ptr<infinity::core::Context> &context);
+  ~RdmaCmQueuePairFactory();
+
+  RdmaCmQueuePairFactory(const RdmaCmQueuePairFactory &) = delete;
+  RdmaCmQueuePairFactory(const RdmaCmQueuePairFactory &&) = delete;
+  RdmaCmQueuePairFactory &operator=(const RdmaCmQueuePairFactory &) = delete;
+  RdmaCmQueuePairFactory &operator=(RdmaCmQueuePairFactory &&) = delete;
+
+public:
+  /**
+   * Listen for connection requests on port
+   */
+  void bindToPort(uint16_t port);
+
+  /**
+   * Accept incoming connection request (passive side)
+   */
+  std::shared_ptr<QueuePair>
+  acceptIncomingConnection(void *userData = nullptr,
+                           uint32_t userDataSizeInBytes = 0);
+
+  /**
+   * Connect to remote machine (active side)
+   */
+  std::shared_ptr<QueuePair>
+  connectToRemoteHost(const char *hostAddress, uint16_t port,
+                      void *userData = nullptr,
+                      uint32_t userDataSizeInBytes = 0);
+
+protected:
+  void waitForEvent(rdma_event_channel *channel, rdma_cm_event_type type,
+                    rdma_cm_id **id, std::vector<char> *userData);
+  void checkDevice(rdma_cm_id *id);
+  void transition(rdma_cm_id *id, const std::shared_ptr<QueuePair> &queuePair,
+                  ibv_qp_state state);
+  void setConnectionParameters(rdma_conn_param &parameters,
+                               const std::shared_ptr<QueuePair> &queuePair,
+                               std::vector<char> &privateData, void *userData,
+                               uint32_t userDataSizeInBytes);
+
+protected:
+  std::shared_ptr<infinity::core::Context> context;
+
+  rdma_event_channel *eventChannel = nullptr;
+  rdma_cm_id *listenId = nullptr;
+
+  /**
+   * Connection ids live as long as the factory, destroying them would
+   * disconnect
+   */
+  std::vector<rdma_cm_id *> connectionIds;
+  std::vector<rdma_event_channel *> connectionChannels;
+};
+
+} /* namespace queues */
+} /* namespace infinity */
+
+#endif /* INFINITY_RDMACM_ON */
+
+#endif /* QUEUES_RDMACMQUEUEPAIRFACTORY_H_ */
@@ -0,0 +1,79 @@
+/**
+ * Requests - Multi-Rail Request Token
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "MultiRailRequestToken.h"
+
+#include <infinity/queues/MultiRailQueuePair.h>
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace requests {
+
+MultiRailRequestToken::MultiRailRequestToken(
+    std::shared_ptr<infinity::core::MultiRailContext> context) {
+
+  for (uint32_t rail = 0; rail < context->getNumberOfRails(); ++rail) {
+    this->tokens.emplace_back(new RequestToken(context->getContext(rail)));
+  }
+  this->pendingBytes.resize(context->getNumberOfRails(), 0);
+  this->pending.resize(context->getNumberOfRails(), false);
+}
+
+void MultiRailRequestToken::reset(
+    infinity::queues::MultiRailQueuePair *queuePair) {
+
+  INFINITY_ASSERT(this->numberOfRailsPending == 0,
+                  "[INFINITY][REQUESTS][MULTIRAIL] Token reused before the "
+                  "previous operation completed.\n");
+  this->queuePair = queuePair;
+  this->numberOfRailsUsed = 0;
+  this->successful = true;
+}
+
+RequestToken *MultiRailRequestToken::useRail(uint32_t rail,
+                                             uint64_t sizeInBytes) {
+
+  INFINITY_ASSERT(!this->pending[rail],
+                  "[INFINITY][REQUESTS][MULTIRAIL] Rail %u used twice by one "
+                  "operation.\n",
+                  rail);
+  this->pending[rail] = true;
+  this->pendingBytes[rail] = sizeInBytes;
+  ++this->numberOfRailsUsed;
+  ++this->numberOfRailsPending;
+  return this->tokens[rail].get();
+}
+
+bool MultiRailRequestToken::checkIfCompleted() {
+
+  for (uint32_t rail = 0; rail < this->tokens.size(); ++rail) {
+    if (this->pending[rail] && this->tokens[rail]->checkIfCompleted()) {
+      this->successful &= this->tokens[rail]->wasSuccessful();
+      this->queuePair->releaseBytes(rail, this->pendingBytes[rail]);
+      this->pending[rail] = false;
+      --this->numberOfRailsPending;
+    }
+  }
+  return this->numberOfRailsPending == 0;
+}
+
+void MultiRailRequestToken::waitUntilCompleted() {
+  while (!this->checkIfCompleted()) {
+  }
+}
+
+bool MultiRailRequestToken::wasSuccessful() {
+  return this->numberOfRailsPending == 0 && this->successful;
+}
+
+uint32_t MultiRailRequestToken::getNumberOfRailsUsed() {
+  return this->numberOfRailsUsed;
+}
+
+} /* namespace requests */
+} /* namespace infinity */
@@ -24,6 +24,12 @@ RequestToken::RequestToken(std::shared_ptr<infinity::core::Context> context)
 }
 
 void RequestToken::setStatus(ibv_wc_status status) {
+  if (this->atomicArray != nullptr) {
+    this->atomicValue = this->atomicArray->getValue(this->atomicSlot);
+    this->atomicValueValid = (status == IBV_WC_SUCCESS);
+    this->atomicArray->releaseSlot(this->atomicSlot);
+    this->atomicArray = nullptr;
+  }
   this->status.store(status);
   this->completed.store(true);
 }
@@ -67,6 +73,14 @@ void RequestToken::reset() {
   this->userDataSize = 0;
   this->immediateValue = 0;
   this->immediateValueValid = false;
+  // A reused token, or one whose queue pair was reset before the atomic
+  // completed, still holds its slot
+  if (this->atomicArray != nullptr) {
+    this->atomicArray->releaseSlot(this->atomicSlot);
+    this->atomicArray = nullptr;
+  }
+  this->atomicValue = 0;
+  this->atomicValueValid = false;
 }
 
 void RequestToken::setRegion(std::shared_ptr<infinity::memory::Region> region) {
@@ -77,6 +91,16 @@ std::shared_ptr<infinity::memory::Region> RequestToken::getRegion() {
   return this->region;
 }
 
+void RequestToken::setAtomicSlot(infinity::memory::AtomicArray *atomicArray,
+                                 uint32_t slot) {
+  this->atomicArray = atomicArray;
+  this->atomicSlot = slot;
+}
+
+bool RequestToken::hasAtomicValue() { return this->atomicValueValid; }
+
+uint64_t RequestToken::getAtomicValue() { return this->atomicValue; }
+
 void RequestToken::setUserData(void *userData, uint32_t userDataSize) {
   this->userData = userData;
   this->userDataSize = userDataSize;
@@ -13,6 +13,7 @@
 #include <stdint.h>
 
 #include <infinity/core/Context.h>
+#include <infinity/memory/AtomicArray.h>
 #include <infinity/memory/Region.h>
 
 namespace infinity {
@@ -40,6 +41,15 @@ public:
   bool hasImmediateValue();
   uint32_t getImmediateValue();
 
+  /**
+   * Result of an atomic operation which used a slot of an atomic array. The
+   * value is copied and the slot released when the operation completes, or
+   * when the token is reset before that.
+   */
+  void setAtomicSlot(infinity::memory::AtomicArray *atomicArray, uint32_t slot);
+  bool hasAtomicValue();
+  uint64_t getAtomicValue();
+
   void setUserData(void *userData, uint32_t userDataSize);
   bool hasUserData();
   void *getUserData();
@@ -65,6 +75,11 @@ protected:
 
   uint32_t immediateValue = 0;
   bool immediateValueValid = false;
+
+  infinity::memory::AtomicArray *atomicArray = nullptr;
+  uint32_t atomicSlot = 0;
+  uint64_t atomicValue = 0;
+  bool atomicValueValid = false;
 };
 
 } /* namespace requests */
@@ -0,0 +1,102 @@
+/**
+ * Utils - NUMA
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "Numa.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <string>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace infinity {
+namespace utils {
+
+static bool readSysfsLine(ibv_device *device, const char *attribute,
+                          char *line, int size) {
+
+  if (device == nullptr) {
+    return false;
+  }
+
+  std::string path = std::string(device->ibdev_path) + "/device/" + attribute;
+  FILE *file = fopen(path.c_str(), "r");
+  if (file == nullptr) {
+    return false;
+  }
+  bool success = (fgets(line, size, file) != nullptr);
+  fclose(file);
+  return success;
+}
+
+int32_t Numa::getNumaNodeOfDevice(ibv_device *device) {
+
+  char line[64];
+  if (!readSysfsLine(device, "numa_node", line, sizeof(line))) {
+    return -1;
+  }
+  return atoi(line);
+}
+
+std::vector<uint32_t> Numa::getLocalCpusOfDevice(ibv_device *device) {
+
+  std::vector<uint32_t> cpus;
+  char line[4096];
+  if (!readSysfsLine(device, "local_cpulist", line, sizeof(line))) {
+    return cpus;
+  }
+
+  // Format is a comma separated list of ranges, e.g. "0-7,16-23"
+  char *savePointer = nullptr;
+  for (char *range = strtok_r(line, ",\n", &savePointer); range != nullptr;
+       range = strtok_r(nullptr, ",\n", &savePointer)) {
+    uint32_t first = 0;
+    uint32_t last = 0;
+    int32_t matched = sscanf(range, "%u-%u", &first, &last);
+    if (matched == 1) {
+      last = first;
+    } else if (matched != 2) {
+      continue;
+    }
+    for (uint32_t cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+int32_t Numa::getNumaNodeOfCurrentThread() {
+
+  unsigned int cpu = 0;
+  unsigned int node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+    return -1;
+  }
+  return node;
+}
+
+bool Numa::bindCurrentThreadToCpus(const std::vector<uint32_t> &cpus) {
+
+  if (cpus.empty()) {
+    return false;
+  }
+
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  for (uint32_t cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &cpuSet);
+    }
+  }
+  return sched_setaffinity(0, sizeof(cpu_set_t), &cpuSet) == 0;
+}
+
+} /* namespace utils */
+} /* namespace infinity */
@@ -0,0 +1,86 @@
+/**
+ * Utils - Rendezvous Store
+ *
+ * (c) 2018 Claude Barthels, ETH Zurich
+ * Contact: claudeb@inf.ethz.ch
+ *
+ */
+
+#include "RendezvousStore.h"
+
+#include <chrono>
+#include <errno.h>
+#include <fstream>
+#include <iterator>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include <infinity/utils/Debug.h>
+
+namespace infinity {
+namespace utils {
+
+void RendezvousStore::waitFor(const std::string &key,
+                              std::vector<char> &value,
+                              uint32_t timeoutInMilliseconds) {
+
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(timeoutInMilliseconds);
+
+  while (!get(key, value)) {
+    INFINITY_ASSERT(std::chrono::steady_clock::now() < deadline,
+                    "[INFINITY][UTILS][RENDEZVOUS] Timed out waiting for "
+                    "%s.\n",
+                    key.c_str());
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+FileRendezvousStore::FileRendezvousStore(const std::string &directory)
+    : directory(directory) {
+
+  int returnValue = mkdir(directory.c_str(), 0777);
+  INFINITY_ASSERT(returnValue == 0 || errno == EEXIST,
+                  "[INFINITY][UTILS][RENDEZVOUS] Cannot create directory %s. "
+                  "%s.\n",
+                  directory.c_str(), strerror(errno));
+}
+
+void FileRendezvousStore::put(const std::string &key,
+                              const std::vector<char> &value) {
+
+  std::string path = this->directory + "/" + key;
+  std::string temporaryPath = path + ".tmp." + std::to_string(getpid());
+
+  {
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    INFINITY_ASSERT(file.good(),
+                    "[INFINITY][UTILS][RENDEZVOUS] Cannot write %s.\n",
+                    temporaryPath.c_str());
+    file.write(value.data(), value.size());
+  }
+
+  int returnValue = rename(temporaryPath.c_str(), path.c_str());
+  INFINITY_ASSERT(returnValue == 0,
+                  "[INFINITY][UTILS][RENDEZVOUS] Cannot publish %s. %s.\n",
+                  path.c_str(), strerror(errno));
+}
+
+bool FileRendezvousStore::get(const std::string &key,
+                              std::vector<char> &value) {
+
+  std::ifstream file(this->directory + "/" + key, std::ios::binary);
+  if (!file.good()) {
+    return false;
+  }
+  value.assign(std::istreambuf_iterator<char>(file),
+               std::istreambuf_iterator<char>());
+  return true;
+}
+
+} /* namespace utils */
+} /* namespace infinity */